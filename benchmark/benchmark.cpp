@@ -0,0 +1,359 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Benchmarks of tao::optional and tao::result next to std::optional and, when
+// the library has it, std::expected, for a trivially copyable payload (int),
+// a non-trivial one (a std::string too long for the small-string buffer) and
+// a heavy move-only one. The size and alignment of every instantiation is
+// reported in the context printed before the results.
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include <tao/result/result.hpp>
+
+#include "counting.hpp"
+
+namespace {
+
+struct heavy {
+  std::unique_ptr<std::array<std::uint64_t, 32>> data;
+};
+
+template <typename T> struct payload;
+
+template <> struct payload<int> {
+  static int make() { return 42; }
+  static const char *name() { return "int"; }
+};
+
+template <> struct payload<std::string> {
+  static std::string make() { return std::string(40, 'x'); }
+  static const char *name() { return "string"; }
+};
+
+template <> struct payload<heavy> {
+  static heavy make() {
+    return heavy{std::make_unique<std::array<std::uint64_t, 32>>()};
+  }
+  static const char *name() { return "heavy"; }
+};
+
+// Each family builds its type from a payload and runs the same chain:
+// and_then to a fresh object, map to the same type, or_else with a fallback
+struct tao_optional {
+  template <typename T> using type = tao::optional<T>;
+  static constexpr bool hashable = true;
+  static constexpr bool has_value_or_else = true;
+
+  template <typename T> static type<T> chain(type<T> &&o) {
+    return std::move(o)
+        .and_then([](T &&v) { return type<T>(std::move(v)); })
+        .map([](T &&v) { return std::move(v); })
+        .or_else([] { return type<T>(payload<T>::make()); });
+  }
+};
+
+struct std_optional {
+  template <typename T> using type = std::optional<T>;
+  static constexpr bool hashable = true;
+  static constexpr bool has_value_or_else = false;
+
+  // The same steps written out, as they would be without monadic operations
+  template <typename T> static type<T> chain(type<T> &&o) {
+    type<T> a = o ? type<T>(std::move(*o)) : type<T>();
+    type<T> b = a ? type<T>(std::move(*a)) : type<T>();
+    return b ? std::move(b) : type<T>(payload<T>::make());
+  }
+};
+
+struct tao_result {
+  template <typename T> using type = tao::result<T, std::errc>;
+  static constexpr bool hashable = true;
+  static constexpr bool has_value_or_else = true;
+
+  template <typename T> static type<T> chain(type<T> &&r) {
+    return std::move(r)
+        .and_then([](T &&v) { return type<T>(std::move(v)); })
+        .map([](T &&v) { return std::move(v); })
+        .or_else([](std::errc) { return type<T>(payload<T>::make()); });
+  }
+};
+
+#if defined(__cpp_lib_expected)
+struct std_expected {
+  template <typename T> using type = std::expected<T, std::errc>;
+  static constexpr bool hashable = false;
+  static constexpr bool has_value_or_else = false;
+
+#if __cpp_lib_expected >= 202211L
+  template <typename T> static type<T> chain(type<T> &&r) {
+    return std::move(r)
+        .and_then([](T &&v) { return type<T>(std::move(v)); })
+        .transform([](T &&v) { return std::move(v); })
+        .or_else([](std::errc) { return type<T>(payload<T>::make()); });
+  }
+#else
+  // Without the monadic operations, written out as for std::optional
+  template <typename T> static type<T> chain(type<T> &&r) {
+    type<T> a = r ? type<T>(std::move(*r)) : type<T>(std::unexpect, r.error());
+    type<T> b = a ? type<T>(std::move(*a)) : type<T>(std::unexpect, a.error());
+    return b ? std::move(b) : type<T>(payload<T>::make());
+  }
+#endif
+};
+#endif
+
+template <typename F, typename T> void construct_destroy(benchmark::State &s) {
+  for (auto _ : s) {
+    typename F::template type<T> o(payload<T>::make());
+    benchmark::DoNotOptimize(o);
+  }
+}
+
+template <typename F, typename T> void copy(benchmark::State &s) {
+  const typename F::template type<T> src(payload<T>::make());
+  for (auto _ : s) {
+    typename F::template type<T> o(src);
+    benchmark::DoNotOptimize(o);
+  }
+}
+
+template <typename F, typename T> void copy_assign(benchmark::State &s) {
+  const typename F::template type<T> src(payload<T>::make());
+  typename F::template type<T> o(payload<T>::make());
+  for (auto _ : s) {
+    o = src;
+    benchmark::DoNotOptimize(o);
+  }
+}
+
+template <typename F, typename T> void move(benchmark::State &s) {
+  typename F::template type<T> a(payload<T>::make());
+  for (auto _ : s) {
+    typename F::template type<T> b(std::move(a));
+    benchmark::DoNotOptimize(b);
+    a = std::move(b);
+  }
+}
+
+template <typename F, typename T> void chain(benchmark::State &s) {
+  for (auto _ : s) {
+    auto r = F::chain(typename F::template type<T>(payload<T>::make()));
+    benchmark::DoNotOptimize(r);
+  }
+}
+
+template <typename F, typename T> void emplace(benchmark::State &s) {
+  typename F::template type<T> o(payload<T>::make());
+  for (auto _ : s) {
+    o.emplace(payload<T>::make());
+    benchmark::DoNotOptimize(o);
+  }
+}
+
+template <typename F, typename T> void swap(benchmark::State &s) {
+  typename F::template type<T> a(payload<T>::make());
+  typename F::template type<T> b(payload<T>::make());
+  for (auto _ : s) {
+    using std::swap;
+    swap(a, b);
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+  }
+}
+
+template <typename F, typename T> void hash(benchmark::State &s) {
+  const typename F::template type<T> o(payload<T>::make());
+  const std::hash<typename F::template type<T>> h{};
+  for (auto _ : s) {
+    benchmark::DoNotOptimize(h(o));
+  }
+}
+
+// Engaged-to-engaged copy assignment with a payload that counts its special
+// members; the per-iteration counters show one assignment and no constructor
+template <typename F> void counted_assign(benchmark::State &s) {
+  const typename F::template type<counted> src(counted(1));
+  typename F::template type<counted> o(counted(2));
+  reset_counts();
+  for (auto _ : s) {
+    o = src;
+    benchmark::DoNotOptimize(o);
+  }
+  const auto per_iteration = benchmark::Counter::kAvgIterations;
+  s.counters["constructs"] =
+      benchmark::Counter(counted_counts().constructs, per_iteration);
+  s.counters["assigns"] =
+      benchmark::Counter(counted_counts().assigns, per_iteration);
+}
+
+// value_or and value_or_else on an engaged rvalue, which move the value out
+// and, for value_or_else, never build the fallback
+template <typename F, typename T> void value_or(benchmark::State &s) {
+  for (auto _ : s) {
+    typename F::template type<T> o(payload<T>::make());
+    T v = std::move(o).value_or(payload<T>::make());
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+template <typename F, typename T> void value_or_else(benchmark::State &s) {
+  for (auto _ : s) {
+    typename F::template type<T> o(payload<T>::make());
+    T v = std::move(o).value_or_else(
+        [](auto &&...) { return payload<T>::make(); });
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+// The same with the counting payload, reporting copies and moves per iteration
+template <typename F> void counted_value_or(benchmark::State &s) {
+  typename F::template type<counted> o(counted(1));
+  reset_counts();
+  for (auto _ : s) {
+    counted v = std::move(o).value_or(counted(2));
+    benchmark::DoNotOptimize(v);
+  }
+  const auto per_iteration = benchmark::Counter::kAvgIterations;
+  s.counters["copies"] =
+      benchmark::Counter(counted_counts().copies, per_iteration);
+  s.counters["moves"] = benchmark::Counter(counted_counts().moves, per_iteration);
+}
+
+template <typename F> void counted_value_or_else(benchmark::State &s) {
+  typename F::template type<counted> o(counted(1));
+  reset_counts();
+  for (auto _ : s) {
+    counted v =
+        std::move(o).value_or_else([](auto &&...) { return counted(2); });
+    benchmark::DoNotOptimize(v);
+  }
+  const auto per_iteration = benchmark::Counter::kAvgIterations;
+  s.counters["constructs"] =
+      benchmark::Counter(counted_counts().constructs, per_iteration);
+  s.counters["copies"] =
+      benchmark::Counter(counted_counts().copies, per_iteration);
+}
+
+template <typename F, typename T>
+void add(const char *family, const char *op, void (*fn)(benchmark::State &)) {
+  benchmark::RegisterBenchmark(
+      (std::string(op) + "/" + family + "/" + payload<T>::name()).c_str(), fn);
+}
+
+template <typename F> void add_family(const char *family) {
+  add<F, int>(family, "construct_destroy", &construct_destroy<F, int>);
+  add<F, std::string>(family, "construct_destroy",
+                      &construct_destroy<F, std::string>);
+  add<F, heavy>(family, "construct_destroy", &construct_destroy<F, heavy>);
+
+  add<F, int>(family, "copy", &copy<F, int>);
+  add<F, std::string>(family, "copy", &copy<F, std::string>);
+  add<F, int>(family, "copy_assign", &copy_assign<F, int>);
+  add<F, std::string>(family, "copy_assign", &copy_assign<F, std::string>);
+  benchmark::RegisterBenchmark(
+      (std::string("copy_assign/") + family + "/counted").c_str(),
+      &counted_assign<F>);
+
+  add<F, int>(family, "move", &move<F, int>);
+  add<F, std::string>(family, "move", &move<F, std::string>);
+  add<F, heavy>(family, "move", &move<F, heavy>);
+
+  add<F, int>(family, "chain", &chain<F, int>);
+  add<F, std::string>(family, "chain", &chain<F, std::string>);
+  add<F, heavy>(family, "chain", &chain<F, heavy>);
+
+  add<F, int>(family, "emplace", &emplace<F, int>);
+  add<F, std::string>(family, "emplace", &emplace<F, std::string>);
+  add<F, heavy>(family, "emplace", &emplace<F, heavy>);
+
+  add<F, int>(family, "swap", &swap<F, int>);
+  add<F, std::string>(family, "swap", &swap<F, std::string>);
+  add<F, heavy>(family, "swap", &swap<F, heavy>);
+
+  add<F, std::string>(family, "value_or", &value_or<F, std::string>);
+  benchmark::RegisterBenchmark(
+      (std::string("value_or/") + family + "/counted").c_str(),
+      &counted_value_or<F>);
+  if constexpr (F::has_value_or_else) {
+    add<F, std::string>(family, "value_or_else",
+                        &value_or_else<F, std::string>);
+    benchmark::RegisterBenchmark(
+        (std::string("value_or_else/") + family + "/counted").c_str(),
+        &counted_value_or_else<F>);
+  }
+
+  if constexpr (F::hashable) {
+    add<F, int>(family, "hash", &hash<F, int>);
+    add<F, std::string>(family, "hash", &hash<F, std::string>);
+  }
+}
+
+template <typename T> void report_layout(const char *name) {
+  benchmark::AddCustomContext(
+      std::string("layout ") + name,
+      "sizeof " + std::to_string(sizeof(T)) + ", alignof " +
+          std::to_string(alignof(T)) +
+          (std::is_trivially_copyable<T>::value ? ", trivially copyable"
+                                                : ""));
+}
+
+void report_layouts() {
+  report_layout<tao::optional<int>>("tao::optional<int>");
+  report_layout<tao::optional<std::string>>("tao::optional<string>");
+  report_layout<tao::optional<heavy>>("tao::optional<heavy>");
+  report_layout<tao::optional<int &>>("tao::optional<int&>");
+  report_layout<tao::result<int, std::errc>>("tao::result<int, errc>");
+  report_layout<tao::result<std::string, std::errc>>(
+      "tao::result<string, errc>");
+  report_layout<tao::result<heavy, std::errc>>("tao::result<heavy, errc>");
+  report_layout<tao::result<void, std::errc>>("tao::result<void, errc>");
+  report_layout<std::optional<int>>("std::optional<int>");
+  report_layout<std::optional<std::string>>("std::optional<string>");
+  report_layout<std::optional<heavy>>("std::optional<heavy>");
+#if defined(__cpp_lib_expected)
+  report_layout<std::expected<int, std::errc>>("std::expected<int, errc>");
+  report_layout<std::expected<std::string, std::errc>>(
+      "std::expected<string, errc>");
+  report_layout<std::expected<heavy, std::errc>>(
+      "std::expected<heavy, errc>");
+#endif
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  add_family<tao_optional>("tao::optional");
+  add_family<std_optional>("std::optional");
+  add_family<tao_result>("tao::result");
+#if defined(__cpp_lib_expected)
+  add_family<std_expected>("std::expected");
+#endif
+
+  report_layouts();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,399 @@
+//! \file tao/result/any_error.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_ANY_ERROR_HPP_
+#define TAO_RESULT_ANY_ERROR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/context.hpp>
+#include <tao/result/result.hpp>
+
+// A type-erased error for library boundaries:
+//
+//   tao::result<config, tao::any_error> load(const char *path) {
+//     if (!exists(path)) return tao::make_unexpected(std::errc::no_such_file_or_directory);
+//     return parse(path).map_error([](parse_error e) { return tao::any_error(e); });
+//   }
+//
+// Payloads of up to TAO_RESULT_ANY_ERROR_BUFFER_SIZE bytes that are trivially
+// relocatable are stored inline, so raising one does not allocate; larger
+// ones go to the heap, or into a context_arena with make_any_error_in. The
+// operations are dispatched through one static table per payload type, with
+// no RTTI. Moving an any_error copies its bytes and never throws.
+
+// Inline payload capacity of any_error, in bytes
+#ifndef TAO_RESULT_ANY_ERROR_BUFFER_SIZE
+#define TAO_RESULT_ANY_ERROR_BUFFER_SIZE 24
+#endif
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+template <typename E, typename = void>
+struct is_error_code_like : std::false_type {};
+template <typename E>
+struct is_error_code_like<
+    E, void_t<decltype(std::declval<const E &>().value()),
+              decltype(std::declval<const E &>().category().name()),
+              decltype(std::declval<const E &>().message())>>
+    : std::true_type {};
+
+template <typename E, typename = void> struct has_what : std::false_type {};
+template <typename E>
+struct has_what<E, void_t<decltype(std::declval<const E &>().what())>>
+    : std::true_type {};
+
+// std::error_code, std::error_condition, or an enum that converts to one
+template <typename E>
+auto error_code_of(const E &e, std::true_type) -> decltype(make_error_code(e)) {
+  return make_error_code(e);
+}
+template <typename E>
+auto error_code_of(const E &e, std::false_type)
+    -> decltype(make_error_condition(e)) {
+  return make_error_condition(e);
+}
+
+template <typename E>
+using is_std_error_enum =
+    std::integral_constant<bool, std::is_error_code_enum<E>::value ||
+                                     std::is_error_condition_enum<E>::value>;
+
+template <typename E>
+auto as_error_code(const E &e, int)
+    -> decltype(error_code_of(e, std::is_error_code_enum<E>{})) {
+  return error_code_of(e, std::is_error_code_enum<E>{});
+}
+template <typename E> const E &as_error_code(const E &e, long) { return e; }
+
+// The defaults of error_traits: error codes and enums registered with
+// <system_error>, then anything with what(), then plain enums for the code
+template <typename E>
+std::string default_error_what(const E &e, std::true_type) {
+  return e.what();
+}
+template <typename E>
+std::string default_error_what(const E &, std::false_type) {
+  return "unknown error";
+}
+template <typename E>
+std::string default_error_message(const E &e, std::true_type) {
+  return as_error_code(e, 0).message();
+}
+template <typename E>
+std::string default_error_message(const E &e, std::false_type) {
+  return default_error_what(e, has_what<E>{});
+}
+
+template <typename E>
+const char *default_error_category(const E &e, std::true_type) noexcept {
+  return as_error_code(e, 0).category().name();
+}
+template <typename E>
+const char *default_error_category(const E &, std::false_type) noexcept {
+  return "unknown";
+}
+
+template <typename E> int default_enum_code(const E &e, std::true_type) {
+  return static_cast<int>(e);
+}
+template <typename E> int default_enum_code(const E &, std::false_type) {
+  return 0;
+}
+template <typename E> int default_error_code(const E &e, std::true_type) {
+  return as_error_code(e, 0).value();
+}
+template <typename E> int default_error_code(const E &e, std::false_type) {
+  return default_enum_code(e, std::is_enum<E>{});
+}
+
+template <typename E>
+using is_system_error =
+    std::integral_constant<bool, is_error_code_like<E>::value ||
+                                     is_std_error_enum<E>::value>;
+
+} // namespace detail
+
+/// \brief Customization point describing an error payload to `any_error`.
+///
+/// \details The primary template handles `std::error_code`,
+/// `std::error_condition` and the enums registered with `<system_error>`
+/// (such as `std::errc`) through their category, types with a `what()`
+/// member, and other enums, whose code is their value. Other payloads
+/// specialize it:
+///
+/// ```
+/// namespace tao {
+/// template <> struct error_traits<parse_error> {
+///   static std::string message(const parse_error &e) { return e.describe(); }
+///   static const char *category(const parse_error &) noexcept { return "parse"; }
+///   static int code(const parse_error &e) noexcept { return e.line; }
+/// };
+/// }
+/// ```
+template <typename E> struct error_traits {
+  static std::string message(const E &e) {
+    return detail::default_error_message(e, detail::is_system_error<E>{});
+  }
+  static const char *category(const E &e) noexcept {
+    return detail::default_error_category(e, detail::is_system_error<E>{});
+  }
+  static int code(const E &e) noexcept {
+    return detail::default_error_code(e, detail::is_system_error<E>{});
+  }
+};
+
+class any_error;
+
+/// \exclude
+namespace detail {
+
+union any_error_storage {
+  alignas(void *) unsigned char buf[TAO_RESULT_ANY_ERROR_BUFFER_SIZE];
+  const void *ptr;
+};
+
+// Payloads stored in place must keep any_error trivially relocatable
+template <typename E>
+using any_error_fits = std::integral_constant<
+    bool, sizeof(E) <= sizeof(any_error_storage) &&
+              alignof(E) <= alignof(any_error_storage) &&
+              is_trivially_relocatable<E>::value>;
+
+struct any_error_vtable {
+  const void *type;
+  const void *(*get)(const any_error_storage &) noexcept;
+  void (*copy)(const any_error_storage &, any_error_storage &);
+  void (*destroy)(any_error_storage &) noexcept;
+  std::string (*message)(const void *);
+  const char *(*category)(const void *) noexcept;
+  int (*code)(const void *) noexcept;
+};
+
+// One address per payload type, standing in for typeid
+template <typename E> struct any_error_type_id { static const char id; };
+template <typename E> const char any_error_type_id<E>::id = 0;
+
+template <typename E> struct any_error_inline {
+  static const void *get(const any_error_storage &s) noexcept {
+    return reinterpret_cast<const E *>(s.buf);
+  }
+  static void copy(const any_error_storage &from, any_error_storage &to) {
+    ::new (static_cast<void *>(to.buf))
+        E(*reinterpret_cast<const E *>(from.buf));
+  }
+  static void destroy(any_error_storage &s) noexcept {
+    reinterpret_cast<E *>(s.buf)->~E();
+  }
+};
+
+template <typename E> struct any_error_heap {
+  static const void *get(const any_error_storage &s) noexcept {
+    return s.ptr;
+  }
+  static void copy(const any_error_storage &from, any_error_storage &to) {
+    to.ptr = new E(*static_cast<const E *>(from.ptr));
+  }
+  static void destroy(any_error_storage &s) noexcept {
+    delete static_cast<const E *>(s.ptr);
+  }
+};
+
+// The payload lives in a context_arena. It is trivially destructible and
+// never modified, so copies share it.
+template <typename E> struct any_error_arena {
+  static const void *get(const any_error_storage &s) noexcept {
+    return s.ptr;
+  }
+  static void copy(const any_error_storage &from, any_error_storage &to) {
+    to.ptr = from.ptr;
+  }
+  static void destroy(any_error_storage &) noexcept {}
+};
+
+template <typename E> struct any_error_ops {
+  static std::string message(const void *p) {
+    return error_traits<E>::message(*static_cast<const E *>(p));
+  }
+  static const char *category(const void *p) noexcept {
+    return error_traits<E>::category(*static_cast<const E *>(p));
+  }
+  static int code(const void *p) noexcept {
+    return error_traits<E>::code(*static_cast<const E *>(p));
+  }
+};
+
+template <typename E, typename Storage> struct any_error_vtable_for {
+  static constexpr any_error_vtable value = {
+      &any_error_type_id<E>::id, &Storage::get,
+      &Storage::copy,            &Storage::destroy,
+      &any_error_ops<E>::message, &any_error_ops<E>::category,
+      &any_error_ops<E>::code};
+};
+
+template <typename E, typename Storage>
+constexpr any_error_vtable any_error_vtable_for<E, Storage>::value;
+
+} // namespace detail
+
+/// \brief A type-erased error: any copyable payload, with its message,
+/// category and code available through `error_traits`.
+///
+/// \details The object is a pointer to a static table plus
+/// `TAO_RESULT_ANY_ERROR_BUFFER_SIZE` bytes (24 by default), which hold the
+/// payload when it fits and is trivially relocatable. Other payloads are
+/// allocated on the heap, or in a `context_arena` by `make_any_error_in`.
+/// Moves copy the bytes and leave the source empty, so they never throw and
+/// `result<T, any_error>` stays nothrow movable. The payload is immutable.
+class any_error {
+public:
+  /// Constructs an empty error, the state a moved-from `any_error` is left in.
+  constexpr any_error() noexcept : vt_(nullptr), storage_{} {}
+
+  /// Stores a copy of `e`. Implicit, so that any error can be returned where
+  /// an `any_error` is expected.
+  template <typename E,
+            detail::enable_if_t<
+                !std::is_same<detail::decay_t<E>, any_error>::value &&
+                std::is_copy_constructible<detail::decay_t<E>>::value> * =
+                nullptr>
+  any_error(E &&e) : vt_(nullptr), storage_{} {
+    emplace<detail::decay_t<E>>(
+        detail::any_error_fits<detail::decay_t<E>>{}, std::forward<E>(e));
+  }
+
+  any_error(const any_error &rhs) : vt_(nullptr), storage_{} {
+    if (rhs.vt_) {
+      rhs.vt_->copy(rhs.storage_, storage_);
+      vt_ = rhs.vt_;
+    }
+  }
+
+  any_error(any_error &&rhs) noexcept : vt_(rhs.vt_), storage_(rhs.storage_) {
+    rhs.vt_ = nullptr;
+  }
+
+  /// Copy and move assignment
+  any_error &operator=(any_error rhs) noexcept {
+    reset();
+    vt_ = rhs.vt_;
+    storage_ = rhs.storage_;
+    rhs.vt_ = nullptr;
+    return *this;
+  }
+
+  ~any_error() { reset(); }
+
+  /// \returns whether no payload is held
+  bool empty() const noexcept { return vt_ == nullptr; }
+
+  /// \returns the message of the payload, empty if there is none
+  std::string message() const {
+    return vt_ ? vt_->message(payload()) : std::string();
+  }
+
+  /// \returns the category name of the payload, `""` if there is none
+  const char *category() const noexcept {
+    return vt_ ? vt_->category(payload()) : "";
+  }
+
+  /// \returns the code of the payload, 0 if there is none
+  int code() const noexcept { return vt_ ? vt_->code(payload()) : 0; }
+
+  /// \returns whether the payload is an `E`
+  template <typename E> bool is() const noexcept {
+    return vt_ && vt_->type == &detail::any_error_type_id<E>::id;
+  }
+
+  /// \returns the payload if it is an `E`, otherwise nullptr
+  template <typename E> const E *target() const noexcept {
+    return is<E>() ? static_cast<const E *>(payload()) : nullptr;
+  }
+
+private:
+  template <typename E>
+  friend any_error make_any_error_in_impl(context_arena &, E &&);
+
+  const void *payload() const noexcept { return vt_->get(storage_); }
+
+  void reset() noexcept {
+    if (vt_) {
+      vt_->destroy(storage_);
+      vt_ = nullptr;
+    }
+  }
+
+  template <typename E, typename Storage> void set_vtable() noexcept {
+    vt_ = &detail::any_error_vtable_for<E, Storage>::value;
+  }
+
+  template <typename E, typename G> void emplace(std::true_type, G &&g) {
+    ::new (static_cast<void *>(storage_.buf)) E(std::forward<G>(g));
+    set_vtable<E, detail::any_error_inline<E>>();
+  }
+
+  template <typename E, typename G> void emplace(std::false_type, G &&g) {
+    storage_.ptr = new E(std::forward<G>(g));
+    set_vtable<E, detail::any_error_heap<E>>();
+  }
+
+  template <typename E, typename G> bool emplace_in(context_arena &a, G &&g) {
+    void *p = a.allocate(sizeof(E), alignof(E));
+    if (!p) {
+      return false;
+    }
+    storage_.ptr = ::new (p) E(std::forward<G>(g));
+    set_vtable<E, detail::any_error_arena<E>>();
+    return true;
+  }
+
+  const detail::any_error_vtable *vt_;
+  detail::any_error_storage storage_;
+};
+
+/// \exclude
+template <typename E> any_error make_any_error_in_impl(context_arena &a, E &&e) {
+  using payload = detail::decay_t<E>;
+  any_error r;
+  if (detail::any_error_fits<payload>::value ||
+      !r.emplace_in<payload>(a, std::forward<E>(e))) {
+    return any_error(std::forward<E>(e));
+  }
+  return r;
+}
+
+/// \brief Makes an `any_error` whose payload, if it does not fit inline, is
+/// carved from `arena` instead of the heap.
+///
+/// \details The payload must be trivially destructible, like context frame
+/// arguments. As with context frames, the error must not be inspected once
+/// the arena is reset, typically at the end of the `context_scope`. When the
+/// arena is full the payload goes to the heap.
+template <typename E>
+any_error make_any_error_in(context_arena &arena, E &&e) {
+  static_assert(std::is_trivially_destructible<detail::decay_t<E>>::value,
+                "payloads placed in an arena must be trivially destructible");
+  return make_any_error_in_impl(arena, std::forward<E>(e));
+}
+
+// Inline payloads are trivially relocatable, the others are behind a pointer
+template <>
+struct is_trivially_relocatable<any_error> : std::true_type {};
+
+} // namespace tao
+
+#endif // TAO_RESULT_ANY_ERROR_HPP_
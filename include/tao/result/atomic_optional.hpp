@@ -0,0 +1,417 @@
+//! \file tao/result/atomic_optional.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_ATOMIC_OPTIONAL_HPP_
+#define TAO_RESULT_ATOMIC_OPTIONAL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// An optional published across threads without a mutex:
+//
+//   tao::atomic_optional<ticket_key> current_key;     // empty until loaded
+//   current_key.store(rotate());                      // writer
+//   if (auto k = current_key.load()) encrypt(*k);     // readers
+//
+// The optional<T> object itself is what is stored, so a T with a niche (see
+// optional_traits) keeps the empty state inside the value word. When that
+// object is 1, 2, 4 or 8 bytes, it lives in a std::atomic of that width. At
+// 16 bytes it uses a double-width compare-and-swap where the target has one
+// (x86-64 with -mcx16, AArch64). Anything else falls back to a sequence
+// lock: readers never block writers and retry if a write overlapped them.
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+inline void atomic_optional_backoff(unsigned &spins) noexcept {
+  if (++spins >= 64) {
+    std::this_thread::yield();
+  }
+}
+
+constexpr std::memory_order
+atomic_optional_failure_order(std::memory_order order) noexcept {
+  return order == std::memory_order_acq_rel
+             ? std::memory_order_acquire
+             : order == std::memory_order_release ? std::memory_order_relaxed
+                                                  : order;
+}
+
+// A std::atomic over an unsigned integer as wide as the representation
+template <typename Word> class atomic_optional_word {
+public:
+  using repr = Word;
+  static constexpr bool is_lock_free = true;
+
+  explicit atomic_optional_word(repr r) noexcept : w_(r) {}
+
+  repr load(std::memory_order order) const noexcept { return w_.load(order); }
+
+  void store(repr r, std::memory_order order) noexcept { w_.store(r, order); }
+
+  repr exchange(repr r, std::memory_order order) noexcept {
+    return w_.exchange(r, order);
+  }
+
+  bool compare_exchange_strong(repr &expected, repr desired,
+                               std::memory_order order) noexcept {
+    return w_.compare_exchange_strong(expected, desired, order,
+                                      atomic_optional_failure_order(order));
+  }
+
+  bool compare_exchange_weak(repr &expected, repr desired,
+                             std::memory_order order) noexcept {
+    return w_.compare_exchange_weak(expected, desired, order,
+                                    atomic_optional_failure_order(order));
+  }
+
+private:
+  std::atomic<repr> w_;
+};
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+__extension__ typedef unsigned __int128 atomic_optional_dword;
+
+// 16 bytes through the __sync builtins, which GCC and Clang expand inline to
+// cmpxchg16b or casp (std::atomic would call into libatomic). They are full
+// barriers, so every memory order is honoured.
+class atomic_optional_dwcas {
+public:
+  using repr = atomic_optional_dword;
+  static constexpr bool is_lock_free = true;
+
+  explicit atomic_optional_dwcas(repr r) noexcept : w_(r) {}
+
+  // A compare-and-swap that writes back what is already there
+  repr load(std::memory_order) const noexcept {
+    return __sync_val_compare_and_swap(&w_, repr(0), repr(0));
+  }
+
+  void store(repr r, std::memory_order order) noexcept { exchange(r, order); }
+
+  repr exchange(repr r, std::memory_order order) noexcept {
+    repr cur = load(order);
+    for (;;) {
+      const repr prev = __sync_val_compare_and_swap(&w_, cur, r);
+      if (prev == cur) {
+        return prev;
+      }
+      cur = prev;
+    }
+  }
+
+  bool compare_exchange_strong(repr &expected, repr desired,
+                               std::memory_order) noexcept {
+    const repr prev = __sync_val_compare_and_swap(&w_, expected, desired);
+    if (prev == expected) {
+      return true;
+    }
+    expected = prev;
+    return false;
+  }
+
+  bool compare_exchange_weak(repr &expected, repr desired,
+                             std::memory_order order) noexcept {
+    return compare_exchange_strong(expected, desired, order);
+  }
+
+private:
+  alignas(16) mutable repr w_;
+};
+#endif
+
+// A sequence lock over the representation split in words. The sequence is
+// odd while a writer is active; a reader retries when it saw an odd sequence
+// or the sequence changed under it. The words are atomics, so a read that
+// overlaps a write is torn but not a data race; they are stored with release
+// and loaded with acquire, which keeps them between the two sequence
+// accesses on either side without a fence (plain moves on x86).
+template <std::size_t Words> class atomic_optional_seqlock {
+public:
+  struct repr {
+    std::uintptr_t w[Words];
+  };
+  static constexpr bool is_lock_free = false;
+
+  explicit atomic_optional_seqlock(const repr &r) noexcept { write(r); }
+
+  repr load(std::memory_order) const noexcept {
+    unsigned spins = 0;
+    for (;;) {
+      const std::size_t s = seq_.load(std::memory_order_acquire);
+      if (!(s & 1)) {
+        const repr r = read();
+        if (seq_.load(std::memory_order_relaxed) == s) {
+          return r;
+        }
+      }
+      atomic_optional_backoff(spins);
+    }
+  }
+
+  void store(const repr &r, std::memory_order) noexcept {
+    const std::size_t s = lock();
+    write(r);
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  repr exchange(const repr &r, std::memory_order) noexcept {
+    const std::size_t s = lock();
+    const repr prev = read();
+    write(r);
+    seq_.store(s + 2, std::memory_order_release);
+    return prev;
+  }
+
+  bool compare_exchange_strong(repr &expected, const repr &desired,
+                               std::memory_order) noexcept {
+    const std::size_t s = lock();
+    const repr cur = read();
+    if (std::memcmp(&cur, &expected, sizeof(repr)) == 0) {
+      write(desired);
+      seq_.store(s + 2, std::memory_order_release);
+      return true;
+    }
+    // Nothing was written, so readers that started before may keep their copy
+    seq_.store(s, std::memory_order_release);
+    expected = cur;
+    return false;
+  }
+
+  bool compare_exchange_weak(repr &expected, const repr &desired,
+                             std::memory_order order) noexcept {
+    return compare_exchange_strong(expected, desired, order);
+  }
+
+private:
+  // \returns the even sequence number the lock was taken at
+  std::size_t lock() noexcept {
+    unsigned spins = 0;
+    std::size_t s = seq_.load(std::memory_order_relaxed);
+    for (;;) {
+      if (!(s & 1) && seq_.compare_exchange_weak(s, s + 1,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+        return s;
+      }
+      atomic_optional_backoff(spins);
+      s = seq_.load(std::memory_order_relaxed);
+    }
+  }
+
+  repr read() const noexcept {
+    repr r;
+    for (std::size_t i = 0; i < Words; ++i) {
+      r.w[i] = data_[i].load(std::memory_order_acquire);
+    }
+    return r;
+  }
+
+  void write(const repr &r) noexcept {
+    for (std::size_t i = 0; i < Words; ++i) {
+      data_[i].store(r.w[i], std::memory_order_release);
+    }
+  }
+
+  std::atomic<std::size_t> seq_{0};
+  std::atomic<std::uintptr_t> data_[Words];
+};
+
+template <std::size_t N>
+using atomic_optional_uint = conditional_t<
+    N <= 1, std::uint8_t,
+    conditional_t<N <= 2, std::uint16_t,
+                  conditional_t<N <= 4, std::uint32_t, std::uint64_t>>>;
+
+// Picks the backend for an object representation of N bytes
+template <std::size_t N, bool = (N <= 8 && ATOMIC_LLONG_LOCK_FREE == 2)>
+struct atomic_optional_backend {
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+  using type =
+      conditional_t<N <= 16, atomic_optional_dwcas,
+                    atomic_optional_seqlock<(N + sizeof(std::uintptr_t) - 1) /
+                                            sizeof(std::uintptr_t)>>;
+#else
+  using type = atomic_optional_seqlock<(N + sizeof(std::uintptr_t) - 1) /
+                                       sizeof(std::uintptr_t)>;
+#endif
+};
+
+template <std::size_t N> struct atomic_optional_backend<N, true> {
+  using type = atomic_optional_word<atomic_optional_uint<N>>;
+};
+
+} // namespace detail
+
+/// \brief An `optional<T>` that can be loaded, stored and compared-and-swapped
+/// atomically.
+///
+/// \details `T` must be trivially copyable. The stored object is the
+/// `optional<T>` itself. It is lock-free (`is_always_lock_free`) when that
+/// object is at most 8 bytes, and at 16 bytes where the target has a
+/// double-width compare-and-swap (x86-64 with `-mcx16`, AArch64). Opting `T`
+/// into a niche through `optional_traits` keeps e.g. `atomic_optional<double>`
+/// at 8 bytes. Larger objects are protected by a sequence lock: loads retry
+/// around concurrent writes and never block them.
+///
+/// Values are compared by their object representation, as with
+/// `std::atomic`. Padding is cleared where the compiler supports it, and an
+/// empty optional always has the same representation.
+template <typename T> class atomic_optional {
+  static_assert(!std::is_reference<T>::value,
+                "atomic_optional of a reference is ill-formed, use "
+                "std::atomic<T *>");
+  static_assert(std::is_trivially_copyable<optional<T>>::value,
+                "atomic_optional requires a trivially copyable T");
+
+  using backend =
+      typename detail::atomic_optional_backend<sizeof(optional<T>)>::type;
+  using repr = typename backend::repr;
+
+public:
+  using value_type = T;
+
+  /// Whether every operation is lock-free for this `T`
+  static constexpr bool is_always_lock_free = backend::is_lock_free;
+
+  /// Constructs an empty atomic optional.
+  atomic_optional() noexcept : storage_(encode_empty()) {}
+
+  /// Constructs an atomic optional holding `v`.
+  atomic_optional(const optional<T> &v) noexcept : storage_(encode(v)) {}
+
+  atomic_optional(const atomic_optional &) = delete;
+  atomic_optional &operator=(const atomic_optional &) = delete;
+
+  /// \returns `is_always_lock_free`
+  bool is_lock_free() const noexcept { return is_always_lock_free; }
+
+  /// \returns the current value
+  optional<T> load(std::memory_order order = std::memory_order_seq_cst) const
+      noexcept {
+    return decode(storage_.load(order));
+  }
+
+  /// Replaces the value with `v`.
+  void store(const optional<T> &v,
+             std::memory_order order = std::memory_order_seq_cst) noexcept {
+    storage_.store(encode(v), order);
+  }
+
+  /// Makes the optional empty.
+  void reset(std::memory_order order = std::memory_order_seq_cst) noexcept {
+    storage_.store(encode_empty(), order);
+  }
+
+  /// Replaces the value with `v`.
+  /// \returns the previous value
+  optional<T> exchange(const optional<T> &v,
+                       std::memory_order order = std::memory_order_seq_cst)
+      noexcept {
+    return decode(storage_.exchange(encode(v), order));
+  }
+
+  /// Replaces the value with `desired` if it is equal to `expected`.
+  /// Otherwise loads the current value into `expected`.
+  /// \returns whether the value was replaced
+  /// \group compare_exchange
+  bool compare_exchange_strong(
+      optional<T> &expected, const optional<T> &desired,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    repr e = encode(expected);
+    if (storage_.compare_exchange_strong(e, encode(desired), order)) {
+      return true;
+    }
+    expected = decode(e);
+    return false;
+  }
+
+  /// May fail spuriously, so it is meant for a loop.
+  /// \group compare_exchange
+  bool compare_exchange_weak(
+      optional<T> &expected, const optional<T> &desired,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    repr e = encode(expected);
+    if (storage_.compare_exchange_weak(e, encode(desired), order)) {
+      return true;
+    }
+    expected = decode(e);
+    return false;
+  }
+
+  /// Stores a `T` constructed from `args` if the optional is empty, for lazy
+  /// one-time initialization: of several racing callers, exactly one wins.
+  /// \returns whether this call stored its value
+  template <typename... Args> bool emplace_if_empty(Args &&... args) {
+    repr e = encode_empty();
+    return storage_.compare_exchange_strong(
+        e, encode(optional<T>(in_place, std::forward<Args>(args)...)),
+        std::memory_order_acq_rel);
+  }
+
+private:
+  // The same value always encodes to the same bytes. An engaged optional is
+  // copied with its padding cleared. An empty one is all zero bytes when it
+  // keeps a flag, whatever its value storage held, and its niche value
+  // otherwise; the bytes past the optional in repr stay zero.
+  static repr encode(const optional<T> &v) noexcept {
+    if (!v.has_value()) {
+      return encode_empty();
+    }
+    repr r;
+    std::memset(static_cast<void *>(&r), 0, sizeof(repr));
+    optional<T> o(in_place, *v);
+    copy_bytes(o, r);
+    return r;
+  }
+
+  static repr encode_empty() noexcept {
+    repr r;
+    std::memset(static_cast<void *>(&r), 0, sizeof(repr));
+    if (detail::has_niche<T>::value) {
+      optional<T> o;
+      copy_bytes(o, r);
+    }
+    return r;
+  }
+
+  static void copy_bytes(optional<T> &o, repr &r) noexcept {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+    __builtin_clear_padding(&o);
+#endif
+#endif
+    std::memcpy(static_cast<void *>(&r), &o, sizeof(o));
+  }
+
+  static optional<T> decode(const repr &r) noexcept {
+    optional<T> v;
+    std::memcpy(static_cast<void *>(&v), &r, sizeof(v));
+    return v;
+  }
+
+  backend storage_;
+};
+
+template <typename T>
+constexpr bool atomic_optional<T>::is_always_lock_free;
+
+} // namespace tao
+
+#endif // TAO_RESULT_ATOMIC_OPTIONAL_HPP_
@@ -0,0 +1,246 @@
+//! \file tao/result/bulk.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_BULK_HPP_
+#define TAO_RESULT_BULK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include <tao/result/optional_vector.hpp>
+
+// Bulk operations over the values + validity bitmap layout of
+// optional_vector. The instruction set is chosen at compile time from the
+// target flags (-mavx512f, -mavx2, NEON on AArch64); there is no runtime
+// dispatch. Every kernel has a portable scalar path with identical results.
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+TAO_RESULT_INLINE_VAR constexpr std::size_t bulk_word_bits = 64;
+
+inline bool bulk_bit(const std::uint64_t *bits, std::size_t i) noexcept {
+  return (bits[i / bulk_word_bits] >> (i % bulk_word_bits)) & 1;
+}
+
+// Scalar blend, also used for the tail of the vector kernels
+template <typename T>
+void blend_scalar(const T *values, const std::uint64_t *bits, std::size_t first,
+                  std::size_t last, const T &fallback, T *out) {
+  for (std::size_t i = first; i < last; ++i) {
+    out[i] = bulk_bit(bits, i) ? values[i] : fallback;
+  }
+}
+
+// Picks the vector kernel matching sizeof(T); 0 means no kernel
+template <typename T>
+using blend_kernel = std::integral_constant<
+    std::size_t,
+    std::is_trivially_copyable<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)
+        ? sizeof(T)
+        : 0>;
+
+template <typename T>
+void blend(std::integral_constant<std::size_t, 0>, const T *values,
+           const std::uint64_t *bits, std::size_t n, const T &fallback, T *out) {
+  blend_scalar(values, bits, 0, n, fallback, out);
+}
+
+// The blend only moves bit patterns, so any trivially copyable T of the
+// right size goes through the integer lanes
+template <typename T>
+void blend(std::integral_constant<std::size_t, 4>, const T *values,
+           const std::uint64_t *bits, std::size_t n, const T &fallback, T *out) {
+  std::uint32_t fb;
+  std::memcpy(&fb, &fallback, sizeof(fb));
+  std::size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i vfb = _mm512_set1_epi32(static_cast<int>(fb));
+  for (; i + 16 <= n; i += 16) {
+    const __mmask16 m = static_cast<__mmask16>(
+        bits[i / bulk_word_bits] >> (i % bulk_word_bits));
+    const __m512i v = _mm512_loadu_si512(values + i);
+    _mm512_storeu_si512(out + i, _mm512_mask_blend_epi32(m, vfb, v));
+  }
+#elif defined(__AVX2__)
+  const __m256i vfb = _mm256_set1_epi32(static_cast<int>(fb));
+  const __m256i lane_bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  for (; i + 8 <= n; i += 8) {
+    const int m = static_cast<int>(
+        (bits[i / bulk_word_bits] >> (i % bulk_word_bits)) & 0xFF);
+    const __m256i mask = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(m), lane_bit), lane_bit);
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_blendv_epi8(vfb, v, mask));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint32x4_t vfb = vdupq_n_u32(fb);
+  const uint32_t lane_bit_init[4] = {1, 2, 4, 8};
+  const uint32x4_t lane_bit = vld1q_u32(lane_bit_init);
+  for (; i + 4 <= n; i += 4) {
+    const uint32_t m = static_cast<uint32_t>(
+        (bits[i / bulk_word_bits] >> (i % bulk_word_bits)) & 0xF);
+    const uint32x4_t mask = vtstq_u32(vdupq_n_u32(m), lane_bit);
+    const uint32x4_t v =
+        vld1q_u32(reinterpret_cast<const uint32_t *>(values + i));
+    vst1q_u32(reinterpret_cast<uint32_t *>(out + i), vbslq_u32(mask, v, vfb));
+  }
+#endif
+  blend_scalar(values, bits, i, n, fallback, out);
+}
+
+template <typename T>
+void blend(std::integral_constant<std::size_t, 8>, const T *values,
+           const std::uint64_t *bits, std::size_t n, const T &fallback, T *out) {
+  std::uint64_t fb;
+  std::memcpy(&fb, &fallback, sizeof(fb));
+  std::size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i vfb = _mm512_set1_epi64(static_cast<long long>(fb));
+  for (; i + 8 <= n; i += 8) {
+    const __mmask8 m = static_cast<__mmask8>(
+        bits[i / bulk_word_bits] >> (i % bulk_word_bits));
+    const __m512i v = _mm512_loadu_si512(values + i);
+    _mm512_storeu_si512(out + i, _mm512_mask_blend_epi64(m, vfb, v));
+  }
+#elif defined(__AVX2__)
+  const __m256i vfb = _mm256_set1_epi64x(static_cast<long long>(fb));
+  const __m256i lane_bit = _mm256_setr_epi64x(1, 2, 4, 8);
+  for (; i + 4 <= n; i += 4) {
+    const long long m = static_cast<long long>(
+        (bits[i / bulk_word_bits] >> (i % bulk_word_bits)) & 0xF);
+    const __m256i mask = _mm256_cmpeq_epi64(
+        _mm256_and_si256(_mm256_set1_epi64x(m), lane_bit), lane_bit);
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_blendv_epi8(vfb, v, mask));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint64x2_t vfb = vdupq_n_u64(fb);
+  const uint64_t lane_bit_init[2] = {1, 2};
+  const uint64x2_t lane_bit = vld1q_u64(lane_bit_init);
+  for (; i + 2 <= n; i += 2) {
+    const uint64_t m = (bits[i / bulk_word_bits] >> (i % bulk_word_bits)) & 0x3;
+    const uint64x2_t mask = vtstq_u64(vdupq_n_u64(m), lane_bit);
+    const uint64x2_t v =
+        vld1q_u64(reinterpret_cast<const uint64_t *>(values + i));
+    vst1q_u64(reinterpret_cast<uint64_t *>(out + i), vbslq_u64(mask, v, vfb));
+  }
+#endif
+  blend_scalar(values, bits, i, n, fallback, out);
+}
+
+// Walks the bitmap one word at a time. Fully engaged words run `dense` over a
+// contiguous range, which the compiler can vectorize without ever touching an
+// empty lane; partial words visit set bits only. Both callbacks return false
+// to stop early.
+template <typename Dense, typename Sparse>
+bool for_each_engaged_run(const std::uint64_t *bits, std::size_t n,
+                          Dense &&dense, Sparse &&sparse) {
+  const std::size_t words = (n + bulk_word_bits - 1) / bulk_word_bits;
+  for (std::size_t w = 0; w < words; ++w) {
+    std::uint64_t word = bits[w];
+    const std::size_t base = w * bulk_word_bits;
+    if (word == ~std::uint64_t(0)) {
+      if (!dense(base, base + bulk_word_bits)) {
+        return false;
+      }
+      continue;
+    }
+    while (word != 0) {
+      if (!sparse(base + countr_zero64(word))) {
+        return false;
+      }
+      word &= word - 1;
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+/// Writes the value of every lane of `v` to `out`, or `fallback` for empty
+/// lanes. `out` must have room for `v.size()` elements.
+///
+/// For trivially copyable `T` of 4 or 8 bytes this is a masked blend (AVX-512,
+/// AVX2 or NEON, depending on the target), with a scalar loop for the tail and
+/// for every other `T`.
+template <typename T>
+void value_or(const optional_vector<T> &v, const T &fallback, T *out) {
+  detail::blend(detail::blend_kernel<T>{}, v.values_data(), v.validity_data(),
+                v.size(), fallback, out);
+}
+
+/// Writes `in[i].value_or(fallback)` to `out[i]` for `n` optionals stored
+/// contiguously (the array-of-structures layout).
+template <typename T>
+void value_or(const optional<T> *in, std::size_t n, const T &fallback, T *out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = in[i].has_value() ? *in[i] : fallback;
+  }
+}
+
+/// Writes `f(value)` to `out[i]` for every engaged lane `i` of `v`. Slots of
+/// empty lanes in `out` are left untouched and `f` is never called for them.
+/// Runs of 64 engaged lanes are processed as one contiguous loop.
+template <typename T, typename U, typename F>
+void transform_engaged(const optional_vector<T> &v, U *out, F &&f) {
+  const T *values = v.values_data();
+  detail::for_each_engaged_run(
+      v.validity_data(), v.size(),
+      [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          out[i] = detail::invoke(f, values[i]);
+        }
+        return true;
+      },
+      [&](std::size_t i) {
+        out[i] = detail::invoke(f, values[i]);
+        return true;
+      });
+}
+
+/// \returns true if `pred(value)` holds for every engaged lane of `v`
+/// (vacuously true if there is none). Stops at the first failing lane.
+template <typename T, typename P>
+bool all_of_engaged(const optional_vector<T> &v, P &&pred) {
+  const T *values = v.values_data();
+  return detail::for_each_engaged_run(
+      v.validity_data(), v.size(),
+      [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          if (!detail::invoke(pred, values[i])) {
+            return false;
+          }
+        }
+        return true;
+      },
+      [&](std::size_t i) {
+        return static_cast<bool>(detail::invoke(pred, values[i]));
+      });
+}
+
+} // namespace tao
+
+#endif // TAO_RESULT_BULK_HPP_
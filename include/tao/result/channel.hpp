@@ -0,0 +1,495 @@
+//! \file tao/result/channel.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_CHANNEL_HPP_
+#define TAO_RESULT_CHANNEL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// A one-shot, single-producer / single-consumer channel carrying one
+// result<T, E>, in place of std::promise<std::optional<T>>:
+//
+//   tao::promise_result<reply, std::errc> p;
+//   auto f = p.get_future();
+//   pool.submit([p = std::move(p)]() mutable { p.set_result(handle()); });
+//   auto r = std::move(f).then(&render).get();
+//
+// The shared state is one allocation holding the result itself, a state word
+// and a reference count, both atomics; there is no mutex and no condition
+// variable. Waiting uses std::atomic::wait where available (C++20) and spins
+// with yield otherwise.
+
+namespace tao {
+
+template <typename T, typename E> class promise_result;
+template <typename T, typename E> class future_result;
+
+/// \brief Thrown by `future_result::get()` when the promise was destroyed
+/// without setting a result.
+class broken_promise : public std::exception {
+public:
+  broken_promise() = default;
+  const char *what() const noexcept {
+    return "tao::future_result: promise destroyed without a result";
+  }
+};
+
+/// \exclude
+namespace detail {
+
+[[noreturn]] TAO_RESULT_COLD inline void throw_broken_promise() {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+  report_failure(broken_promise().what());
+#else
+  throw broken_promise();
+#endif
+}
+
+// Bits of the state word. ready is set once, by the producer, after the
+// result is constructed (or with broken, when the promise dies unsatisfied).
+// continuation is set once, by the consumer, after the continuation is
+// stored. Whoever sets the second of ready / continuation runs it.
+enum : unsigned {
+  channel_ready = 1,
+  channel_continuation = 2,
+  channel_broken = 4,
+};
+
+class channel_state_base {
+public:
+  // The producer and the consumer side each own one reference
+  void release() noexcept {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      destroy_(this);
+    }
+  }
+
+  bool ready() const noexcept {
+    return state_.load(std::memory_order_acquire) & channel_ready;
+  }
+
+  void wait() const noexcept {
+#if defined(__cpp_lib_atomic_wait)
+    unsigned s = state_.load(std::memory_order_acquire);
+    while (!(s & channel_ready)) {
+      state_.wait(s, std::memory_order_acquire);
+      s = state_.load(std::memory_order_acquire);
+    }
+#else
+    for (unsigned spins = 0; !ready(); ++spins) {
+      if (spins >= 64) {
+        std::this_thread::yield();
+      }
+    }
+#endif
+  }
+
+protected:
+  using destroyer = void (*)(channel_state_base *);
+
+  explicit channel_state_base(destroyer d) noexcept : destroy_(d) {}
+  ~channel_state_base() = default;
+
+  // \returns the previous state
+  unsigned publish(unsigned bits) noexcept {
+    const unsigned prev = state_.fetch_or(bits, std::memory_order_acq_rel);
+#if defined(__cpp_lib_atomic_wait)
+    if (bits & channel_ready) {
+      state_.notify_one();
+    }
+#endif
+    return prev;
+  }
+
+  std::atomic<unsigned> state_{0};
+
+private:
+  std::atomic<unsigned> refs_{2};
+  destroyer destroy_;
+};
+
+template <typename T, typename E>
+class channel_state : public channel_state_base {
+public:
+  using result_type = result<T, E>;
+  using continuation = void (*)(channel_state &, void *target);
+
+  template <typename... Args> void set(Args &&... args) {
+    ::new (std::addressof(value_)) result_type(std::forward<Args>(args)...);
+    if (publish(channel_ready) & channel_continuation) {
+      run_(*this, target_);
+    }
+  }
+
+  void set_broken() noexcept {
+    if (publish(channel_ready | channel_broken) & channel_continuation) {
+      run_(*this, target_);
+    }
+  }
+
+  // Called at most once, by the consumer. Runs `run` right away if the
+  // result is already there, otherwise leaves it to the producer.
+  void set_continuation(continuation run, void *target) {
+    run_ = run;
+    target_ = target;
+    if (publish(channel_continuation) & channel_ready) {
+      run_(*this, target_);
+    }
+  }
+
+  bool broken() const noexcept {
+    return state_.load(std::memory_order_acquire) & channel_broken;
+  }
+
+  // Requires ready() and !broken()
+  result_type take() { return std::move(value_); }
+
+protected:
+  explicit channel_state(destroyer d) noexcept : channel_state_base(d) {}
+
+  ~channel_state() {
+    if ((state_.load(std::memory_order_acquire) &
+         (channel_ready | channel_broken)) == channel_ready) {
+      value_.~result_type();
+    }
+  }
+
+private:
+  union {
+    result_type value_;
+  };
+  continuation run_ = nullptr;
+  void *target_ = nullptr;
+};
+
+// A channel_state allocated with `Alloc`, which it keeps to free itself
+template <typename State, typename Alloc>
+class channel_allocated final : public State {
+  using alloc_type = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<channel_allocated>;
+  using traits = std::allocator_traits<alloc_type>;
+
+public:
+  template <typename... Args>
+  static channel_allocated *create(const Alloc &a, Args &&... args) {
+    alloc_type alloc(a);
+    channel_allocated *p = traits::allocate(alloc, 1);
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+    ::new (static_cast<void *>(p))
+        channel_allocated(alloc, std::forward<Args>(args)...);
+#else
+    try {
+      ::new (static_cast<void *>(p))
+          channel_allocated(alloc, std::forward<Args>(args)...);
+    } catch (...) {
+      traits::deallocate(alloc, p, 1);
+      throw;
+    }
+#endif
+    return p;
+  }
+
+private:
+  template <typename... Args>
+  channel_allocated(const alloc_type &a, Args &&... args)
+      : State(&destroy, std::forward<Args>(args)...), alloc_(a) {}
+
+  static void destroy(channel_state_base *b) {
+    channel_allocated *p = static_cast<channel_allocated *>(b);
+    alloc_type alloc(std::move(p->alloc_));
+    p->~channel_allocated();
+    traits::deallocate(alloc, p, 1);
+  }
+
+  alloc_type alloc_;
+};
+
+template <typename T, typename E>
+class channel_plain_state : public channel_state<T, E> {
+protected:
+  using channel_state<T, E>::channel_state;
+};
+
+template <typename T, typename E, typename F>
+using channel_then_result =
+    decay_t<decltype(std::declval<result<T, E>>().and_then(std::declval<F>()))>;
+
+// The state of the future returned by then(). It is the producer of its own
+// channel: the upstream runs it with the upstream result, which goes through
+// and_then.
+template <typename T, typename E, typename F>
+class channel_then_state
+    : public channel_state<typename channel_then_result<T, E, F>::value_type,
+                           typename channel_then_result<T, E, F>::error_type> {
+  using base =
+      channel_state<typename channel_then_result<T, E, F>::value_type,
+                    typename channel_then_result<T, E, F>::error_type>;
+  using destroyer = typename base::destroyer;
+
+public:
+  // Runs on whichever side completes the upstream, possibly inside the
+  // noexcept set_broken(), so it must not throw: a throwing continuation
+  // breaks the chained channel instead.
+  static void run(channel_state<T, E> &upstream, void *target) noexcept {
+    channel_then_state &self = *static_cast<channel_then_state *>(target);
+    if (upstream.broken()) {
+      self.set_broken();
+    } else {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+      self.set(upstream.take().and_then(std::move(self.f_)));
+#else
+      try {
+        self.set(upstream.take().and_then(std::move(self.f_)));
+      } catch (...) {
+        self.set_broken();
+      }
+#endif
+    }
+    self.release();
+  }
+
+protected:
+  template <typename G>
+  channel_then_state(destroyer d, G &&g)
+      : base(d), f_(std::forward<G>(g)) {}
+
+private:
+  F f_;
+};
+
+} // namespace detail
+
+/// The consumer end of a one-shot channel carrying a `result<T, E>`.
+///
+/// Move-only. A default-constructed or consumed future is not `valid()`.
+template <typename T, typename E> class future_result {
+  using state_type = detail::channel_state<T, E>;
+
+public:
+  using result_type = result<T, E>;
+
+  /// Constructs a future with no channel.
+  constexpr future_result() noexcept = default;
+
+  future_result(future_result &&rhs) noexcept : state_(rhs.state_) {
+    rhs.state_ = nullptr;
+  }
+
+  future_result &operator=(future_result &&rhs) noexcept {
+    future_result(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  future_result(const future_result &) = delete;
+  future_result &operator=(const future_result &) = delete;
+
+  /// Gives up the result. The producer may still set it.
+  ~future_result() {
+    if (state_) {
+      state_->release();
+    }
+  }
+
+  void swap(future_result &rhs) noexcept { std::swap(state_, rhs.state_); }
+
+  /// \returns whether the future refers to a channel
+  bool valid() const noexcept { return state_ != nullptr; }
+
+  /// \returns whether the result has been set, or the promise destroyed
+  /// without one. Never blocks.
+  /// \requires `valid()`
+  bool is_ready() const noexcept { return state_->ready(); }
+
+  /// \returns whether the promise was destroyed without setting a result, in
+  /// which case `get()` throws. Never blocks.
+  /// \requires `valid()`
+  bool broken() const noexcept { return state_->broken(); }
+
+  /// Blocks until the result has been set.
+  /// \requires `valid()`
+  void wait() const noexcept { state_->wait(); }
+
+  /// Waits for the result and moves it out, leaving the future invalid.
+  /// Throws `broken_promise` if the promise was destroyed without setting a
+  /// result (calls the failure handler in an exception-free build).
+  /// \requires `valid()`
+  result_type get() {
+    state_->wait();
+    state_type *s = state_;
+    state_ = nullptr;
+    if (s->broken()) {
+      s->release();
+      detail::throw_broken_promise();
+    }
+    const release_on_exit guard{s};
+    return s->take();
+  }
+
+  /// \brief Chains `f` onto the channel with `and_then` semantics.
+  /// \returns a future of `get().and_then(f)`. `f` runs on the producer
+  /// thread when it sets the result, or right here if it already has. An
+  /// error skips `f` and is forwarded, a broken promise or a throwing `f`
+  /// breaks the returned future. Leaves `*this` invalid.
+  /// \requires `valid()`
+  /// \group then
+  template <typename F>
+  future_result<
+      typename detail::channel_then_result<T, E, detail::decay_t<F>>::value_type,
+      typename detail::channel_then_result<T, E, detail::decay_t<F>>::error_type>
+  then(F &&f) {
+    return then(std::allocator_arg, std::allocator<char>(), std::forward<F>(f));
+  }
+
+  /// \group then
+  /// Allocates the state of the returned future with `a`.
+  template <typename Alloc, typename F>
+  future_result<
+      typename detail::channel_then_result<T, E, detail::decay_t<F>>::value_type,
+      typename detail::channel_then_result<T, E, detail::decay_t<F>>::error_type>
+  then(std::allocator_arg_t, const Alloc &a, F &&f) {
+    using then_state = detail::channel_then_state<T, E, detail::decay_t<F>>;
+    using allocated = detail::channel_allocated<then_state, Alloc>;
+
+    then_state *next = allocated::create(a, std::forward<F>(f));
+    state_type *s = state_;
+    state_ = nullptr;
+    s->set_continuation(&then_state::run, static_cast<void *>(next));
+    s->release();
+    return future_result<typename then_state::result_type::value_type,
+                         typename then_state::result_type::error_type>(next);
+  }
+
+private:
+  template <typename U, typename G> friend class promise_result;
+  template <typename U, typename G> friend class future_result;
+
+  explicit future_result(state_type *s) noexcept : state_(s) {}
+
+  // Drops the consumer's reference once the result has been moved out, or
+  // when moving it out throws
+  struct release_on_exit {
+    state_type *state;
+    ~release_on_exit() { state->release(); }
+  };
+
+  state_type *state_ = nullptr;
+};
+
+/// The producer end of a one-shot channel carrying a `result<T, E>`.
+///
+/// Move-only. The result is set at most once, from any thread. Destroying a
+/// promise that has not set its result breaks the channel.
+template <typename T, typename E> class promise_result {
+  using state_type = detail::channel_state<T, E>;
+
+public:
+  using result_type = result<T, E>;
+
+  /// Allocates the shared state with `std::allocator`.
+  promise_result() : promise_result(std::allocator_arg, std::allocator<char>()) {}
+
+  /// Allocates the shared state with `a`, e.g. a pool allocator.
+  template <typename Alloc>
+  promise_result(std::allocator_arg_t, const Alloc &a)
+      : state_(detail::channel_allocated<detail::channel_plain_state<T, E>,
+                                         Alloc>::create(a)) {}
+
+  promise_result(promise_result &&rhs) noexcept
+      : state_(rhs.state_), future_retrieved_(rhs.future_retrieved_),
+        satisfied_(rhs.satisfied_) {
+    rhs.state_ = nullptr;
+  }
+
+  promise_result &operator=(promise_result &&rhs) noexcept {
+    promise_result(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  promise_result(const promise_result &) = delete;
+  promise_result &operator=(const promise_result &) = delete;
+
+  ~promise_result() {
+    if (!state_) {
+      return;
+    }
+    if (!satisfied_) {
+      state_->set_broken();
+    }
+    if (!future_retrieved_) {
+      state_->release();
+    }
+    state_->release();
+  }
+
+  void swap(promise_result &rhs) noexcept {
+    std::swap(state_, rhs.state_);
+    std::swap(future_retrieved_, rhs.future_retrieved_);
+    std::swap(satisfied_, rhs.satisfied_);
+  }
+
+  /// \returns the consumer end. Calls the failure handler if called twice.
+  future_result<T, E> get_future() {
+    if (future_retrieved_) {
+      detail::report_failure("tao::promise_result: future already retrieved");
+    }
+    future_retrieved_ = true;
+    return future_result<T, E>(state_);
+  }
+
+  /// Sets a result holding the value constructed from `args`.
+  template <typename... Args> void set_value(Args &&... args) {
+    set(in_place, std::forward<Args>(args)...);
+  }
+
+  /// Sets a result holding the error constructed from `args`.
+  template <typename... Args> void set_error(Args &&... args) {
+    set(unexpect, std::forward<Args>(args)...);
+  }
+
+  /// Sets the result to `r`.
+  template <typename R> void set_result(R &&r) { set(std::forward<R>(r)); }
+
+private:
+  template <typename... Args> void set(Args &&... args) {
+    if (satisfied_) {
+      detail::report_failure("tao::promise_result: result already set");
+    }
+    state_->set(std::forward<Args>(args)...);
+    satisfied_ = true;
+  }
+
+  state_type *state_;
+  bool future_retrieved_ = false;
+  bool satisfied_ = false;
+};
+
+/// \group swap
+template <typename T, typename E>
+void swap(future_result<T, E> &lhs, future_result<T, E> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+/// \group swap
+template <typename T, typename E>
+void swap(promise_result<T, E> &lhs, promise_result<T, E> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace tao
+
+#endif // TAO_RESULT_CHANNEL_HPP_
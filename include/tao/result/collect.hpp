@@ -0,0 +1,337 @@
+//! \file tao/result/collect.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_COLLECT_HPP_
+#define TAO_RESULT_COLLECT_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(TAO_RESULT_NO_EXECUTION) && __cplusplus >= 201703L &&           \
+    defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#include <tao/result/result.hpp>
+
+// Turning a range into result<std::vector<U>, E>, where the first error wins:
+//
+//   tao::result<std::vector<row>, parse_error> rows =
+//       tao::transform_collect(lines, parse_row);
+//
+// Every element goes through the result returned by `f` via map, exactly as
+// a hand-written loop would. The output is reserved once for forward ranges
+// and the walk stops at the first error.
+//
+// With <execution> available (C++17; define TAO_RESULT_NO_EXECUTION to keep
+// it out, libstdc++ may then need -ltbb), transform_collect also takes
+// std::execution::par over random access ranges.
+
+namespace tao {
+/// \exclude
+namespace detail {
+
+template <typename F, typename Ref>
+using collect_step_t = decay_t<invoke_result_t<F &, Ref>>;
+
+template <typename F, typename Ref>
+using collect_result_t =
+    result<std::vector<typename collect_step_t<F, Ref>::value_type>,
+           typename collect_step_t<F, Ref>::error_type>;
+
+template <typename F, typename Ref> struct collect_check {
+  using step = collect_step_t<F, Ref>;
+  static_assert(is_result<step>::value, "f must return a tao::result");
+  static_assert(!std::is_void<typename step::value_type>::value,
+                "f must return a result with a value");
+  static constexpr bool value = true;
+};
+
+// Forwards the result stored in the range, for collect
+struct collect_identity {
+  template <typename R> constexpr R &&operator()(R &&r) const noexcept {
+    return std::forward<R>(r);
+  }
+};
+
+template <typename V, typename It>
+void collect_reserve(V &, It, It, std::input_iterator_tag) {}
+
+template <typename V, typename It>
+void collect_reserve(V &v, It first, It last, std::forward_iterator_tag) {
+  v.reserve(static_cast<std::size_t>(std::distance(first, last)));
+}
+
+// Runs one element through `f` and appends its value to `out`.
+// \returns the error, if any, as a result<void, E>
+template <typename V, typename F, typename Ref>
+auto collect_one(V &out, F &f, Ref &&ref) {
+  return detail::invoke(f, std::forward<Ref>(ref))
+      .map([&out](auto &&v) -> void {
+        out.push_back(std::forward<decltype(v)>(v));
+      });
+}
+
+template <typename Range> struct collect_range {
+  using iterator = decltype(std::begin(std::declval<Range &>()));
+  // Elements of an rvalue range are moved out
+  using move_iterator =
+      conditional_t<std::is_lvalue_reference<Range>::value, iterator,
+                    std::move_iterator<iterator>>;
+
+  static move_iterator begin(Range &r) { return move_iterator(std::begin(r)); }
+  static move_iterator end(Range &r) { return move_iterator(std::end(r)); }
+};
+
+template <typename It>
+using collect_ref_t = decltype(*std::declval<It &>());
+
+} // namespace detail
+
+/// \brief Calls `f` on every element of `[first, last)` and collects the
+/// values of the results.
+/// \requires `f(*first)` returns a `tao::result<U, E>` with `U` not void.
+/// \returns `result<std::vector<U>, E>` holding all the values in order, or
+/// the first error. Elements after the first error are not visited.
+/// \group transform_collect
+template <typename It, typename F,
+          bool = detail::collect_check<F, detail::collect_ref_t<It>>::value>
+detail::collect_result_t<F, detail::collect_ref_t<It>>
+transform_collect(It first, It last, F &&f) {
+  using ret = detail::collect_result_t<F, detail::collect_ref_t<It>>;
+  typename ret::value_type out;
+  detail::collect_reserve(
+      out, first, last,
+      typename std::iterator_traits<It>::iterator_category{});
+  for (; first != last; ++first) {
+    auto step = detail::collect_one(out, f, *first);
+    if (!step.has_value()) {
+      return ret(unexpect, std::move(step).error());
+    }
+  }
+  return ret(in_place, std::move(out));
+}
+
+/// \group transform_collect
+/// Elements of an rvalue range are moved into `f`.
+template <typename Range, typename F,
+          typename It = typename detail::collect_range<Range>::move_iterator>
+auto transform_collect(Range &&r, F &&f)
+    -> decltype(transform_collect(std::declval<It>(), std::declval<It>(),
+                                  std::forward<F>(f))) {
+  using range = detail::collect_range<Range>;
+  return transform_collect(range::begin(r), range::end(r), std::forward<F>(f));
+}
+
+/// \brief Collects the values of a range of results.
+/// \returns `result<std::vector<T>, E>` holding every value in order, or a
+/// copy of the first error. Elements of an rvalue range are moved.
+/// \group collect
+template <typename It>
+auto collect(It first, It last)
+    -> decltype(transform_collect(first, last, detail::collect_identity{})) {
+  return transform_collect(first, last, detail::collect_identity{});
+}
+
+/// \group collect
+template <typename Range>
+auto collect(Range &&r)
+    -> decltype(transform_collect(std::forward<Range>(r),
+                                  detail::collect_identity{})) {
+  return transform_collect(std::forward<Range>(r), detail::collect_identity{});
+}
+
+#ifdef __cpp_lib_execution
+
+/// \exclude
+namespace detail {
+
+template <typename Policy>
+struct is_parallel_policy
+    : std::integral_constant<
+          bool,
+          std::is_same<Policy, std::execution::parallel_policy>::value ||
+              std::is_same<Policy,
+                           std::execution::parallel_unsequenced_policy>::value> {
+};
+
+template <typename V, typename E> struct collect_chunk {
+  V values;
+  optional<E> error;
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+  std::exception_ptr exception;
+#endif
+};
+
+// Number of chunks handed to each thread, for load balancing
+TAO_RESULT_INLINE_VAR constexpr std::size_t collect_chunks_per_thread = 8;
+
+// The range is cut into chunks, claimed in increasing order by the workers
+// through an atomic counter. `failed` is the index of the lowest chunk that
+// failed: chunks above it are not started, and chunks in progress above it
+// stop at their next element. Chunks below it always run to completion, so
+// the error reported is the one a sequential walk would find.
+template <typename It, typename F>
+collect_result_t<F, collect_ref_t<It>>
+transform_collect_parallel(It first, It last, F &f) {
+  using ret = collect_result_t<F, collect_ref_t<It>>;
+  using vector_type = typename ret::value_type;
+  using error_type = typename ret::error_type;
+  using chunk_type = collect_chunk<vector_type, error_type>;
+
+  const std::size_t n = static_cast<std::size_t>(last - first);
+  const std::size_t threads =
+      std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  const std::size_t chunk_size = std::max<std::size_t>(
+      1, n / (threads * collect_chunks_per_thread));
+  const std::size_t chunks = (n + chunk_size - 1) / chunk_size;
+
+  if (threads == 1 || chunks <= 1) {
+    return transform_collect(first, last, f);
+  }
+
+  std::vector<chunk_type> slots(chunks);
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> failed{chunks};
+
+  auto fail = [&failed](std::size_t c) {
+    std::size_t cur = failed.load(std::memory_order_relaxed);
+    while (c < cur && !failed.compare_exchange_weak(
+                          cur, c, std::memory_order_relaxed)) {
+    }
+  };
+
+  auto work = [&]() noexcept {
+    for (;;) {
+      const std::size_t c = next.fetch_add(1, std::memory_order_relaxed);
+      if (c >= chunks || c > failed.load(std::memory_order_relaxed)) {
+        return;
+      }
+      chunk_type &slot = slots[c];
+      const std::size_t begin = c * chunk_size;
+      const std::size_t end = std::min(n, begin + chunk_size);
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+      try {
+#endif
+        slot.values.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) {
+          if (failed.load(std::memory_order_relaxed) < c) {
+            break;
+          }
+          auto step = collect_one(slot.values, f, first[i]);
+          if (!step.has_value()) {
+            slot.error.emplace(std::move(step).error());
+            fail(c);
+            break;
+          }
+        }
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+      } catch (...) {
+        slot.exception = std::current_exception();
+        fail(c);
+      }
+#endif
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(std::min(threads, chunks) - 1);
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+  try {
+#endif
+    for (std::size_t t = 1; t < std::min(threads, chunks); ++t) {
+      pool.emplace_back(work);
+    }
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+  } catch (...) {
+    // Fewer threads than planned: the chunks are claimed from the shared
+    // counter, so the ones they would have run fall to the threads already
+    // started and to this one, and all of them are joined below
+  }
+#endif
+  work();
+  for (auto &t : pool) {
+    t.join();
+  }
+
+  const std::size_t stop = failed.load(std::memory_order_relaxed);
+  if (stop < chunks) {
+    chunk_type &slot = slots[stop];
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+    if (slot.exception) {
+      std::rethrow_exception(slot.exception);
+    }
+#endif
+    return ret(unexpect, std::move(*slot.error));
+  }
+
+  vector_type out;
+  out.reserve(n);
+  for (auto &slot : slots) {
+    std::move(slot.values.begin(), slot.values.end(), std::back_inserter(out));
+  }
+  return ret(in_place, std::move(out));
+}
+
+} // namespace detail
+
+/// \brief `transform_collect` under an execution policy.
+/// \details With `std::execution::par` or `par_unseq`, the range is split
+/// into chunks processed by `std::thread::hardware_concurrency()` threads,
+/// the calling thread included. Once an element fails, chunks after it are
+/// cancelled. The outcome is the same as the sequential version: the values
+/// in order, or the error of the first failing element. `f` is called
+/// concurrently and must be safe to do so; an exception it throws is
+/// rethrown on the calling thread. Other policies run sequentially.
+/// \requires `It` is a random access iterator.
+/// \group transform_collect_policy
+template <typename Policy, typename It, typename F,
+          detail::enable_if_t<std::is_execution_policy<
+              detail::decay_t<Policy>>::value> * = nullptr,
+          bool = detail::collect_check<F, detail::collect_ref_t<It>>::value>
+detail::collect_result_t<F, detail::collect_ref_t<It>>
+transform_collect(Policy &&, It first, It last, F &&f) {
+  static_assert(
+      std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<It>::iterator_category>::value,
+      "parallel transform_collect requires random access iterators");
+  if (detail::is_parallel_policy<detail::decay_t<Policy>>::value) {
+    return detail::transform_collect_parallel(first, last, f);
+  }
+  return transform_collect(first, last, f);
+}
+
+/// \group transform_collect_policy
+template <typename Policy, typename Range, typename F,
+          detail::enable_if_t<std::is_execution_policy<
+              detail::decay_t<Policy>>::value> * = nullptr,
+          typename It = typename detail::collect_range<Range>::move_iterator>
+auto transform_collect(Policy &&policy, Range &&r, F &&f)
+    -> decltype(transform_collect(std::forward<Policy>(policy),
+                                  std::declval<It>(), std::declval<It>(),
+                                  std::forward<F>(f))) {
+  using range = detail::collect_range<Range>;
+  return transform_collect(std::forward<Policy>(policy), range::begin(r),
+                           range::end(r), std::forward<F>(f));
+}
+
+#endif // __cpp_lib_execution
+
+} // namespace tao
+
+#endif // TAO_RESULT_COLLECT_HPP_
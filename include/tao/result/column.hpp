@@ -0,0 +1,677 @@
+//! \file tao/result/column.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_COLUMN_HPP_
+#define TAO_RESULT_COLUMN_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tao/result/optional_vector.hpp>
+#include <tao/result/result.hpp>
+
+// A binary column format for arrays of optional<T> and result<T, E>, laid
+// out so that a file can be mapped and read in place:
+//
+//   auto w = tao::make_column_writer<tao::optional<double>>(
+//       [f](const void *p, std::size_t n) { return fwrite(p, 1, n, f) == n; });
+//   w.append(prices);                    // an optional_vector<double>
+//   auto done = w.finish();              // result<void, column_error>
+//
+//   auto col = tao::view_column<tao::optional<double>>(map_base, map_size);
+//   if (col && col->has_value(i)) use(*(*col)[i]);   // no decoding pass
+//
+// The file is a 64-byte header, a sequence of blocks and a 64-byte trailer.
+// Every block holds TAO_RESULT_COLUMN_BLOCK_LANES lanes (4096 by default, a
+// power of two no smaller than 64) except possibly the last one, and is laid
+// out as
+//
+//   block header  64 bytes: "TAOBLK1\0", u64 lane count, zero padding
+//   validity      one u64 word per 64 lanes, bit i % 64 of word i / 64
+//   values        lanes * sizeof(T), at the next multiple of 64
+//   errors        lanes * sizeof(E), at the next multiple of 64 (results only)
+//
+// with the block size rounded up to 64 bytes, so every section of every
+// block is 64-byte aligned relative to the start of the file. Integers are
+// little-endian. T and E must be trivially copyable and are stored as their
+// object representation. The slots a lane does not use (the value slot of
+// an empty or error lane, the error slot of a value lane) hold unspecified
+// bytes, zero unless appended from an optional_vector. The writer and the
+// reader keep one block in memory, so a column of any size streams through
+// a bounded buffer.
+
+#ifndef TAO_RESULT_COLUMN_BLOCK_LANES
+#define TAO_RESULT_COLUMN_BLOCK_LANES 4096
+#endif
+
+namespace tao {
+
+/// \brief Why a column could not be written or read.
+enum class column_error {
+  truncated,       ///< the data ends before the trailer, or sizes disagree
+  bad_magic,       ///< not a column, or a corrupted header, block or trailer
+  bad_version,     ///< written by an incompatible version of the format
+  layout_mismatch, ///< the lane type of the file is not the requested one
+  misaligned,      ///< a mapped column must start on a 64-byte boundary
+  io_error,        ///< the sink or the source failed
+};
+
+/// \exclude
+namespace detail {
+
+TAO_RESULT_INLINE_VAR constexpr std::size_t column_align = 64;
+TAO_RESULT_INLINE_VAR constexpr std::uint32_t column_version = 1;
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+TAO_RESULT_INLINE_VAR constexpr bool column_little_endian =
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#else
+TAO_RESULT_INLINE_VAR constexpr bool column_little_endian = true;
+#endif
+
+struct column_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t kind;
+  std::uint32_t value_size;
+  std::uint32_t value_align;
+  std::uint32_t error_size;
+  std::uint32_t error_align;
+  std::uint32_t block_lanes;
+  unsigned char reserved[28];
+};
+
+struct column_block_header {
+  char magic[8];
+  std::uint64_t lanes;
+  unsigned char reserved[48];
+};
+
+struct column_trailer {
+  char magic[8];
+  std::uint64_t count;
+  std::uint64_t blocks;
+  unsigned char reserved[40];
+};
+
+static_assert(sizeof(column_header) == column_align, "");
+static_assert(sizeof(column_block_header) == column_align, "");
+static_assert(sizeof(column_trailer) == column_align, "");
+
+TAO_RESULT_INLINE_VAR constexpr char column_header_magic[8] = "TAOCOL1";
+TAO_RESULT_INLINE_VAR constexpr char column_block_magic[8] = "TAOBLK1";
+TAO_RESULT_INLINE_VAR constexpr char column_trailer_magic[8] = "TAOEND1";
+
+constexpr std::size_t column_round(std::size_t n) noexcept {
+  return (n + column_align - 1) & ~(column_align - 1);
+}
+
+// What a lane of each kind stores
+template <typename Lane> struct column_lane;
+
+template <typename T> struct column_lane<optional<T>> {
+  using value_type = T;
+  using error_type = monostate;
+  static constexpr std::uint32_t kind = 1;
+  static constexpr std::size_t error_size = 0;
+  static constexpr std::size_t error_align = 0;
+};
+
+template <typename T, typename E> struct column_lane<result<T, E>> {
+  using value_type = T;
+  using error_type = E;
+  static constexpr std::uint32_t kind = 2;
+  static constexpr std::size_t error_size = sizeof(E);
+  static constexpr std::size_t error_align = alignof(E);
+};
+
+template <typename Lane> struct column_check {
+  using traits = column_lane<Lane>;
+  using T = typename traits::value_type;
+  using E = typename traits::error_type;
+
+  static_assert(column_little_endian,
+                "the column format is little-endian, and this target is not");
+  static_assert(std::is_trivially_copyable<T>::value &&
+                    std::is_trivially_copyable<E>::value,
+                "columns store trivially copyable values and errors");
+  static_assert(alignof(T) <= column_align && alignof(E) <= column_align,
+                "columns align their sections to 64 bytes");
+};
+
+// The offsets of the sections in a block of `lanes` lanes
+struct column_layout {
+  std::size_t lanes = 0;
+  std::size_t lane_shift = 0;
+  std::size_t values = 0;
+  std::size_t errors = 0;
+  std::size_t block_size = 0;
+
+  static column_layout make(std::size_t lanes, std::size_t value_size,
+                            std::size_t error_size) noexcept {
+    column_layout l;
+    l.lanes = lanes;
+    while ((std::size_t(1) << l.lane_shift) < lanes) {
+      ++l.lane_shift;
+    }
+    l.values = column_round(sizeof(column_block_header) + lanes / 8);
+    l.errors = column_round(l.values + lanes * value_size);
+    l.block_size = column_round(l.errors + lanes * error_size);
+    return l;
+  }
+
+  static bool valid_lanes(std::size_t lanes) noexcept {
+    return lanes >= 64 && (lanes & (lanes - 1)) == 0;
+  }
+};
+
+template <typename Lane> column_header make_column_header(std::size_t lanes) {
+  using traits = column_lane<Lane>;
+  column_header h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, column_header_magic, sizeof(h.magic));
+  h.version = column_version;
+  h.kind = traits::kind;
+  h.value_size = sizeof(typename traits::value_type);
+  h.value_align = alignof(typename traits::value_type);
+  h.error_size = traits::error_size;
+  h.error_align = traits::error_align;
+  h.block_lanes = static_cast<std::uint32_t>(lanes);
+  return h;
+}
+
+// Checks a header against the lane type and returns the block layout
+template <typename Lane>
+result<column_layout, column_error> read_column_header(const void *p) {
+  column_header h;
+  std::memcpy(&h, p, sizeof(h));
+  if (std::memcmp(h.magic, column_header_magic, sizeof(h.magic)) != 0)
+    return make_unexpected(column_error::bad_magic);
+  if (h.version != column_version)
+    return make_unexpected(column_error::bad_version);
+  const column_header want = make_column_header<Lane>(h.block_lanes);
+  if (h.kind != want.kind || h.value_size != want.value_size ||
+      h.value_align != want.value_align || h.error_size != want.error_size ||
+      h.error_align != want.error_align)
+    return make_unexpected(column_error::layout_mismatch);
+  if (!column_layout::valid_lanes(h.block_lanes))
+    return make_unexpected(column_error::bad_magic);
+  using traits = column_lane<Lane>;
+  return column_layout::make(h.block_lanes,
+                             sizeof(typename traits::value_type),
+                             traits::error_size);
+}
+
+// ORs the `n` bits of `src` starting at bit `from` into `dst` starting at
+// bit `to`; `src` is `src_words` words long
+inline void column_copy_bits(std::uint64_t *dst, std::size_t to,
+                             const std::uint64_t *src, std::size_t src_words,
+                             std::size_t from, std::size_t n) noexcept {
+  while (n != 0) {
+    const std::size_t w = from / 64, s = from % 64;
+    std::uint64_t bits = src[w] >> s;
+    if (s != 0 && w + 1 < src_words) {
+      bits |= src[w + 1] << (64 - s);
+    }
+    const std::size_t d = to % 64;
+    const std::size_t k = n < 64 - d ? n : 64 - d;
+    if (k < 64) {
+      bits &= (std::uint64_t(1) << k) - 1;
+    }
+    dst[to / 64] |= bits << d;
+    from += k;
+    to += k;
+    n -= k;
+  }
+}
+
+} // namespace detail
+
+/// \brief A read-only view of a column, in place in the memory it was
+/// written to or mapped from.
+///
+/// \details `Lane` is `optional<T>` or `result<T, E>`. `operator[]` returns
+/// an `optional<const T&>` into the mapped bytes; for result columns
+/// `error(i)` refers to the error of an error lane. The view does not own
+/// the memory, which must stay mapped while it is in use. Views are made by
+/// `view_column` or handed out per block by `column_reader`.
+template <typename Lane> class column_view {
+  static_assert(sizeof(detail::column_check<Lane>) != 0, "");
+  using traits = detail::column_lane<Lane>;
+
+public:
+  using value_type = typename traits::value_type;
+  using error_type = typename traits::error_type;
+  using size_type = std::size_t;
+  using const_reference = optional<const value_type &>;
+
+  /// Constructs an empty view.
+  column_view() = default;
+
+  /// \returns the number of lanes
+  size_type size() const noexcept { return count_; }
+
+  /// \returns whether the view has no lanes
+  bool empty() const noexcept { return count_ == 0; }
+
+  /// \returns whether lane `i` holds a value
+  bool has_value(size_type i) const noexcept {
+    const std::uint64_t *bits = validity(i >> layout_.lane_shift);
+    const size_type j = i & (layout_.lanes - 1);
+    return (bits[j / 64] >> (j % 64)) & 1;
+  }
+
+  /// \returns a reference to the value of lane `i` if it has one, otherwise
+  /// an empty optional
+  const_reference operator[](size_type i) const noexcept {
+    if (has_value(i))
+      return const_reference(value_unchecked(i));
+    return nullopt;
+  }
+
+  /// \returns the error of lane `i`
+  /// \requires `Lane` is a result and lane `i` holds an error
+  template <typename L = Lane,
+            detail::enable_if_t<detail::is_result<L>::value> * = nullptr>
+  const error_type &error(size_type i) const noexcept {
+    const size_type b = i >> layout_.lane_shift;
+    const size_type j = i & (layout_.lanes - 1);
+    return reinterpret_cast<const error_type *>(block(b) + layout_.errors)[j];
+  }
+
+  /// \returns the number of lanes holding a value
+  size_type count_engaged() const noexcept {
+    size_type n = 0;
+    for (size_type b = 0; b < blocks_; ++b) {
+      const std::uint64_t *bits = validity(b);
+      for (size_type w = 0; w < words_in(b); ++w) {
+        n += detail::popcount64(bits[w]);
+      }
+    }
+    return n;
+  }
+
+  /// Calls `f(i, value)` for every lane holding a value, in order, skipping
+  /// empty lanes a whole word at a time.
+  template <typename F> void for_each_engaged(F &&f) const {
+    for (size_type b = 0; b < blocks_; ++b) {
+      const std::uint64_t *bits = validity(b);
+      const value_type *values =
+          reinterpret_cast<const value_type *>(block(b) + layout_.values);
+      for (size_type w = 0; w < words_in(b); ++w) {
+        std::uint64_t x = bits[w];
+        while (x != 0) {
+          const size_type j = w * 64 + detail::countr_zero64(x);
+          f((b << layout_.lane_shift) + j, values[j]);
+          x &= x - 1;
+        }
+      }
+    }
+  }
+
+private:
+  template <typename L>
+  friend result<column_view<L>, column_error> view_column(const void *,
+                                                          std::size_t);
+  template <typename L, typename Source> friend class column_reader;
+
+  column_view(const unsigned char *first, size_type blocks, size_type count,
+              detail::column_layout layout) noexcept
+      : first_(first), blocks_(blocks), count_(count), layout_(layout) {}
+
+  const unsigned char *block(size_type b) const noexcept {
+    return first_ + b * layout_.block_size;
+  }
+
+  const std::uint64_t *validity(size_type b) const noexcept {
+    return reinterpret_cast<const std::uint64_t *>(
+        block(b) + sizeof(detail::column_block_header));
+  }
+
+  size_type words_in(size_type b) const noexcept {
+    const size_type lanes = b + 1 < blocks_
+                                ? layout_.lanes
+                                : count_ - (b << layout_.lane_shift);
+    return (lanes + 63) / 64;
+  }
+
+  const value_type &value_unchecked(size_type i) const noexcept {
+    const size_type b = i >> layout_.lane_shift;
+    const size_type j = i & (layout_.lanes - 1);
+    return reinterpret_cast<const value_type *>(block(b) + layout_.values)[j];
+  }
+
+  const unsigned char *first_ = nullptr;
+  size_type blocks_ = 0;
+  size_type count_ = 0;
+  detail::column_layout layout_ = detail::column_layout::make(64, 0, 0);
+};
+
+/// \brief Views the column in the `size` bytes at `data`, e.g. a mapped file,
+/// without copying or decoding it.
+/// \details Checks the header, the trailer and the sizes; the lanes are read
+/// as they are. `data` must be 64-byte aligned, which `mmap` guarantees.
+template <typename Lane>
+result<column_view<Lane>, column_error> view_column(const void *data,
+                                                    std::size_t size) {
+  const auto *p = static_cast<const unsigned char *>(data);
+  if (reinterpret_cast<std::uintptr_t>(p) % detail::column_align != 0)
+    return make_unexpected(column_error::misaligned);
+  if (size < sizeof(detail::column_header) + sizeof(detail::column_trailer))
+    return make_unexpected(column_error::truncated);
+
+  auto layout = detail::read_column_header<Lane>(p);
+  if (!layout)
+    return make_unexpected(layout.error());
+
+  detail::column_trailer t;
+  std::memcpy(&t, p + size - sizeof(t), sizeof(t));
+  if (std::memcmp(t.magic, detail::column_trailer_magic, sizeof(t.magic)) != 0)
+    return make_unexpected(column_error::truncated);
+  const std::size_t body =
+      size - sizeof(detail::column_header) - sizeof(detail::column_trailer);
+  if (body % layout->block_size != 0 || body / layout->block_size != t.blocks ||
+      t.count > t.blocks * layout->lanes ||
+      (t.blocks != 0 && t.count <= (t.blocks - 1) * layout->lanes))
+    return make_unexpected(column_error::truncated);
+
+  return column_view<Lane>(p + sizeof(detail::column_header),
+                           static_cast<std::size_t>(t.blocks),
+                           static_cast<std::size_t>(t.count), *layout);
+}
+
+/// \brief Writes a column block by block to a sink.
+///
+/// \details `Sink` is called as `sink(const void *data, std::size_t size)`
+/// and returns whether all of `data` was written. The writer buffers one
+/// block; the file is only complete, and readable, after `finish()`.
+template <typename Lane, typename Sink> class column_writer {
+  static_assert(sizeof(detail::column_check<Lane>) != 0, "");
+  using traits = detail::column_lane<Lane>;
+  using value_type = typename traits::value_type;
+  using error_type = typename traits::error_type;
+
+public:
+  using size_type = std::size_t;
+
+  /// Starts a column whose blocks hold `block_lanes` lanes, a power of two
+  /// no smaller than 64, and writes its header.
+  explicit column_writer(Sink sink,
+                         size_type block_lanes = TAO_RESULT_COLUMN_BLOCK_LANES)
+      : sink_(std::move(sink)),
+        layout_(detail::column_layout::make(block_lanes, sizeof(value_type),
+                                            traits::error_size)),
+        buf_(layout_.block_size, 0) {
+    if (!detail::column_layout::valid_lanes(block_lanes)) {
+      failed_ = true;
+      error_ = column_error::layout_mismatch;
+      return;
+    }
+    const detail::column_header h = detail::make_column_header<Lane>(block_lanes);
+    emit(&h, sizeof(h));
+  }
+
+  /// \returns the number of lanes written so far
+  size_type size() const noexcept { return count_; }
+
+  /// Appends a lane.
+  void push_back(const Lane &lane) {
+    push(lane, std::integral_constant<bool, detail::is_result<Lane>::value>{});
+  }
+
+  /// Appends an empty lane.
+  template <typename L = Lane,
+            detail::enable_if_t<detail::is_optional<L>::value> * = nullptr>
+  void push_back(nullopt_t) {
+    advance();
+  }
+
+  /// Appends every lane of `v`, copying the values and the validity bitmap
+  /// in runs of up to a block instead of lane by lane.
+  template <typename L = Lane,
+            detail::enable_if_t<detail::is_optional<L>::value> * = nullptr>
+  void append(const optional_vector<value_type> &v) {
+    const size_type words = (v.size() + 63) / 64;
+    for (size_type i = 0; i < v.size();) {
+      const size_type room = layout_.lanes - fill_;
+      const size_type k = v.size() - i < room ? v.size() - i : room;
+      std::memcpy(values() + fill_ * sizeof(value_type), v.values_data() + i,
+                  k * sizeof(value_type));
+      detail::column_copy_bits(validity(), fill_, v.validity_data(), words, i,
+                               k);
+      fill_ += k;
+      count_ += k;
+      i += k;
+      if (fill_ == layout_.lanes) {
+        flush();
+      }
+    }
+  }
+
+  /// Writes the last block and the trailer.
+  /// \returns the first error of the sink, if any
+  result<void, column_error> finish() {
+    if (fill_ != 0) {
+      flush();
+    }
+    detail::column_trailer t;
+    std::memset(&t, 0, sizeof(t));
+    std::memcpy(t.magic, detail::column_trailer_magic, sizeof(t.magic));
+    t.count = count_;
+    t.blocks = blocks_;
+    emit(&t, sizeof(t));
+    if (failed_)
+      return make_unexpected(error_);
+    return {};
+  }
+
+private:
+  unsigned char *values() noexcept { return buf_.data() + layout_.values; }
+
+  std::uint64_t *validity() noexcept {
+    return reinterpret_cast<std::uint64_t *>(
+        buf_.data() + sizeof(detail::column_block_header));
+  }
+
+  void set_bit() noexcept {
+    validity()[fill_ / 64] |= std::uint64_t(1) << (fill_ % 64);
+  }
+
+  void push(const Lane &lane, std::false_type) {
+    if (lane.has_value()) {
+      std::memcpy(values() + fill_ * sizeof(value_type),
+                  std::addressof(*lane), sizeof(value_type));
+      set_bit();
+    }
+    advance();
+  }
+
+  void push(const Lane &lane, std::true_type) {
+    if (lane.has_value()) {
+      std::memcpy(values() + fill_ * sizeof(value_type),
+                  std::addressof(*lane), sizeof(value_type));
+      set_bit();
+    } else {
+      std::memcpy(buf_.data() + layout_.errors + fill_ * sizeof(error_type),
+                  std::addressof(lane.error()), sizeof(error_type));
+    }
+    advance();
+  }
+
+  void advance() {
+    ++count_;
+    if (++fill_ == layout_.lanes) {
+      flush();
+    }
+  }
+
+  void flush() {
+    detail::column_block_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, detail::column_block_magic, sizeof(h.magic));
+    h.lanes = fill_;
+    std::memcpy(buf_.data(), &h, sizeof(h));
+    emit(buf_.data(), buf_.size());
+    std::memset(buf_.data(), 0, buf_.size());
+    fill_ = 0;
+    ++blocks_;
+  }
+
+  void emit(const void *p, size_type n) {
+    if (!failed_ && !sink_(p, n)) {
+      failed_ = true;
+      error_ = column_error::io_error;
+    }
+  }
+
+  Sink sink_;
+  detail::column_layout layout_;
+  std::vector<unsigned char> buf_;
+  size_type fill_ = 0;
+  size_type count_ = 0;
+  size_type blocks_ = 0;
+  bool failed_ = false;
+  column_error error_ = column_error::io_error;
+};
+
+/// \brief Makes a `column_writer` for `Lane` writing to `sink`.
+template <typename Lane, typename Sink>
+column_writer<Lane, detail::decay_t<Sink>>
+make_column_writer(Sink &&sink,
+                   std::size_t block_lanes = TAO_RESULT_COLUMN_BLOCK_LANES) {
+  return column_writer<Lane, detail::decay_t<Sink>>(std::forward<Sink>(sink),
+                                                   block_lanes);
+}
+
+/// \brief Reads a column block by block from a source, for columns that are
+/// not mapped or do not fit in memory.
+///
+/// \details `Source` is called as `source(void *data, std::size_t size)` and
+/// returns the number of bytes it read, less than `size` only at the end of
+/// the data. The reader holds one block, which `block()` views in place.
+///
+/// *Examples*:
+/// ```
+/// auto r = tao::make_column_reader<tao::optional<double>>(read_fn);
+/// while (auto more = r.next()) {
+///   if (!*more) break;               // the trailer was read and checked
+///   r.block().for_each_engaged(sum);
+/// }
+/// ```
+template <typename Lane, typename Source> class column_reader {
+  static_assert(sizeof(detail::column_check<Lane>) != 0, "");
+
+public:
+  using size_type = std::size_t;
+
+  explicit column_reader(Source source) : source_(std::move(source)) {}
+
+  /// Loads the next block.
+  /// \returns true if a block was loaded, false at the end of a well-formed
+  /// column, or the error that stopped the reader
+  result<bool, column_error> next() {
+    if (done_)
+      return false;
+    if (layout_.lanes == 0) {
+      auto r = read_header();
+      if (!r)
+        return fail(r.error());
+    }
+
+    unsigned char *b = block_data();
+    if (!read(b, sizeof(detail::column_block_header)))
+      return fail(column_error::truncated);
+
+    if (std::memcmp(b, detail::column_trailer_magic, 8) == 0) {
+      detail::column_trailer t;
+      std::memcpy(&t, b, sizeof(t));
+      if (t.count != count_ || t.blocks != blocks_)
+        return fail(column_error::truncated);
+      lanes_ = 0;
+      done_ = true;
+      return false;
+    }
+
+    detail::column_block_header h;
+    std::memcpy(&h, b, sizeof(h));
+    if (std::memcmp(h.magic, detail::column_block_magic, 8) != 0 ||
+        h.lanes == 0 || h.lanes > layout_.lanes)
+      return fail(column_error::bad_magic);
+    if (!read(b + sizeof(h), layout_.block_size - sizeof(h)))
+      return fail(column_error::truncated);
+    lanes_ = static_cast<size_type>(h.lanes);
+    count_ += lanes_;
+    ++blocks_;
+    return true;
+  }
+
+  /// \returns a view of the block loaded by the last call to `next()`,
+  /// valid until the next call
+  column_view<Lane> block() const noexcept {
+    return column_view<Lane>(block_data(), lanes_ != 0 ? 1 : 0, lanes_,
+                             layout_);
+  }
+
+  /// \returns the number of lanes read so far, including the current block
+  size_type size() const noexcept { return count_; }
+
+private:
+  // Errors are final: the reader stops at the first one
+  unexpected<column_error> fail(column_error e) noexcept {
+    lanes_ = 0;
+    done_ = true;
+    return make_unexpected(e);
+  }
+
+  result<void, column_error> read_header() {
+    unsigned char h[sizeof(detail::column_header)];
+    if (!read(h, sizeof(h)))
+      return make_unexpected(column_error::truncated);
+    auto layout = detail::read_column_header<Lane>(h);
+    if (!layout)
+      return make_unexpected(layout.error());
+    layout_ = *layout;
+    // One spare alignment's worth, so that the block can start on 64 bytes
+    buf_.assign(layout_.block_size + detail::column_align, 0);
+    return {};
+  }
+
+  unsigned char *block_data() const noexcept {
+    const auto p = reinterpret_cast<std::uintptr_t>(buf_.data());
+    const auto aligned = (p + detail::column_align - 1) &
+                         ~std::uintptr_t(detail::column_align - 1);
+    return const_cast<unsigned char *>(buf_.data()) + (aligned - p);
+  }
+
+  bool read(void *p, size_type n) { return source_(p, n) == n; }
+
+  Source source_;
+  detail::column_layout layout_;
+  std::vector<unsigned char> buf_;
+  size_type lanes_ = 0;
+  size_type count_ = 0;
+  size_type blocks_ = 0;
+  bool done_ = false;
+};
+
+/// \brief Makes a `column_reader` for `Lane` reading from `source`.
+template <typename Lane, typename Source>
+column_reader<Lane, detail::decay_t<Source>> make_column_reader(Source &&source) {
+  return column_reader<Lane, detail::decay_t<Source>>(
+      std::forward<Source>(source));
+}
+
+} // namespace tao
+
+#endif // TAO_RESULT_COLUMN_HPP_
@@ -0,0 +1,438 @@
+//! \file tao/result/context.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_CONTEXT_HPP_
+#define TAO_RESULT_CONTEXT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_lib_string_view) ||                                          \
+    (defined(__has_include) && __cplusplus >= 201703L)
+#include <string_view>
+#endif
+
+#include <tao/result/result.hpp>
+
+// Error context chaining, the equivalent of anyhow's `.context()`:
+//
+//   tao::result<header, tao::contextual<std::errc>> read_header(file &f) {
+//     return read_block(f, 0).with_context("while reading header of {}",
+//                                          f.name());
+//   }
+//
+// Every with_context call on an error pushes a frame onto the error: the
+// format string and a copy of the arguments, nothing else. Text is produced
+// only when the context is written out. Frames are carved from a bump arena
+// that the caller installs with context_scope and are never freed
+// individually; the arena is reset when the scope ends, once per request.
+// The success path only tests has_value().
+//
+// A context_scope is required: there is no per-thread default arena, since
+// nothing could tell when it is safe to reset one. Outside any scope, frames
+// are dropped and counted by current_context_arena().dropped(), and the
+// first drop on each thread is reported on stderr.
+
+namespace tao {
+
+/// A bump allocator over a caller-provided buffer, holding context frames.
+///
+/// Allocation never fails over to the heap: once the buffer is full, new
+/// frames are dropped and counted. Everything allocated is released at once
+/// by `reset()`, which invalidates every context frame taken from the arena.
+class context_arena {
+public:
+  /// Uses the `size` bytes at `buffer`, which must outlive the arena.
+  context_arena(void *buffer, std::size_t size) noexcept
+      : buf_(static_cast<unsigned char *>(buffer)), size_(size) {}
+
+  context_arena(const context_arena &) = delete;
+  context_arena &operator=(const context_arena &) = delete;
+
+  /// \returns `n` bytes aligned to `align`, or nullptr if the arena is full
+  void *allocate(std::size_t n, std::size_t align) noexcept {
+    const auto base = reinterpret_cast<std::uintptr_t>(buf_);
+    const std::size_t first =
+        ((base + top_ + align - 1) & ~(std::uintptr_t(align) - 1)) - base;
+    if (first > size_ || size_ - first < n) {
+      ++dropped_;
+      return nullptr;
+    }
+    top_ = first + n;
+    return buf_ + first;
+  }
+
+  /// Releases every frame. Errors still holding context from this arena
+  /// must not be inspected afterwards.
+  void reset() noexcept {
+    top_ = 0;
+    dropped_ = 0;
+  }
+
+  /// \returns the number of bytes in use
+  std::size_t used() const noexcept { return top_; }
+
+  /// \returns the number of frames dropped because the arena was full since
+  /// the last reset
+  std::size_t dropped() const noexcept { return dropped_; }
+
+private:
+  unsigned char *buf_;
+  std::size_t size_;
+  std::size_t top_ = 0;
+  std::size_t dropped_ = 0;
+};
+
+/// \exclude
+namespace detail {
+
+inline context_arena *&installed_context_arena() noexcept {
+  static thread_local context_arena *arena = nullptr;
+  return arena;
+}
+
+// Stands in when no context_scope is live: it holds nothing, so every frame
+// pushed outside a scope is dropped and counted here
+inline context_arena &unscoped_context_arena() noexcept {
+  static thread_local context_arena arena(nullptr, 0);
+  return arena;
+}
+
+TAO_RESULT_COLD inline void report_unscoped_context() noexcept {
+  static thread_local bool reported = false;
+  if (!reported) {
+    reported = true;
+    std::fputs("tao::contextual: context frame dropped, no context_scope is "
+               "live on this thread\n",
+               stderr);
+  }
+}
+
+} // namespace detail
+
+/// \returns the arena context frames of this thread go to: the one installed
+/// by the innermost live `context_scope`, or, outside any scope, an empty
+/// arena whose `dropped()` counts the frames lost that way.
+inline context_arena &current_context_arena() noexcept {
+  if (context_arena *a = detail::installed_context_arena()) {
+    return *a;
+  }
+  return detail::unscoped_context_arena();
+}
+
+/// Installs `arena` as the current context arena of this thread for the
+/// lifetime of the scope, typically one request, and resets it on exit.
+///
+/// *Examples*:
+/// ```
+/// alignas(std::max_align_t) unsigned char buf[1024];
+/// tao::context_arena arena(buf, sizeof(buf));
+/// for (auto &req : requests) {
+///   tao::context_scope scope(arena);
+///   if (auto r = handle(req); !r) {
+///     log(r.error().context_string());
+///   }
+/// }
+/// ```
+class context_scope {
+public:
+  explicit context_scope(context_arena &arena) noexcept
+      : arena_(arena), prev_(detail::installed_context_arena()) {
+    detail::installed_context_arena() = &arena;
+  }
+
+  context_scope(const context_scope &) = delete;
+  context_scope &operator=(const context_scope &) = delete;
+
+  ~context_scope() {
+    arena_.reset();
+    detail::installed_context_arena() = prev_;
+  }
+
+private:
+  context_arena &arena_;
+  context_arena *prev_;
+};
+
+/// \exclude
+namespace detail {
+
+// Formatting of frame arguments, only run when the context is written out.
+// Other argument types can be supported by declaring
+//   void write_context_arg(std::string &out, const my_type &x);
+// next to them.
+inline void write_context_arg(std::string &out, const char *s) {
+  out += s ? s : "(null)";
+}
+
+inline void write_context_arg(std::string &out, char c) { out += c; }
+
+inline void write_context_arg(std::string &out, bool b) {
+  out += b ? "true" : "false";
+}
+
+template <typename T,
+          enable_if_t<std::is_integral<T>::value ||
+                      std::is_floating_point<T>::value> * = nullptr>
+void write_context_arg(std::string &out, T v) {
+  out += std::to_string(v);
+}
+
+template <typename T, enable_if_t<std::is_enum<T>::value> * = nullptr>
+void write_context_arg(std::string &out, T v) {
+  out += std::to_string(
+      static_cast<typename std::underlying_type<T>::type>(v));
+}
+
+inline void write_context_arg(std::string &out, const void *p) {
+  char buf[2 + 2 * sizeof(void *) + 1];
+  std::snprintf(buf, sizeof(buf), "%p", p);
+  out += buf;
+}
+
+#ifdef __cpp_lib_string_view
+inline void write_context_arg(std::string &out, std::string_view s) {
+  out.append(s.data(), s.size());
+}
+#endif
+
+template <typename T> void write_context_erased(std::string &out, const void *p) {
+  write_context_arg(out, *static_cast<const T *>(p));
+}
+
+using context_arg_writer = void (*)(std::string &, const void *);
+
+// Copies `what` to `out`, replacing each `{}` with the next argument.
+// Arguments without a placeholder are dropped.
+inline void format_context(std::string &out, const char *what,
+                           const void *const *args,
+                           const context_arg_writer *writers, std::size_t n) {
+  std::size_t i = 0;
+  for (const char *p = what; *p; ++p) {
+    if (p[0] == '{' && p[1] == '}' && i < n) {
+      writers[i](out, args[i]);
+      ++i;
+      ++p;
+    } else {
+      out += *p;
+    }
+  }
+}
+
+// Frame arguments are copied into the arena, which never runs destructors
+template <typename T> using context_arg_t = decay_t<T>;
+
+} // namespace detail
+
+/// One frame of error context: a format string and its arguments, formatted
+/// on demand.
+class context_frame {
+public:
+  /// \returns the frame that was attached before this one, closer to where
+  /// the error was raised, or nullptr
+  const context_frame *next() const noexcept { return next_; }
+
+  /// \returns the unformatted message
+  const char *what() const noexcept { return what_; }
+
+  /// Appends the formatted message to `out`.
+  void write(std::string &out) const { write_(this, out); }
+
+protected:
+  using writer = void (*)(const context_frame *, std::string &);
+
+  context_frame(const char *what, const context_frame *next,
+                writer w) noexcept
+      : what_(what), next_(next), write_(w) {}
+
+private:
+  const char *what_;
+  const context_frame *next_;
+  writer write_;
+};
+
+/// \exclude
+namespace detail {
+
+template <typename... Args> class context_frame_impl : public context_frame {
+public:
+  template <typename... Us>
+  context_frame_impl(const char *what, const context_frame *next, Us &&... us)
+      : context_frame(what, next, &write_impl), args_(std::forward<Us>(us)...) {}
+
+private:
+  static void write_impl(const context_frame *f, std::string &out) {
+    const auto &self = *static_cast<const context_frame_impl *>(f);
+    self.write_args(out, std::index_sequence_for<Args...>{});
+  }
+
+  template <std::size_t... I>
+  void write_args(std::string &out, std::index_sequence<I...>) const {
+    const void *args[] = {nullptr, std::addressof(std::get<I>(args_))...};
+    const context_arg_writer writers[] = {nullptr,
+                                          &write_context_erased<Args>...};
+    format_context(out, what(), args + 1, writers + 1, sizeof...(Args));
+  }
+
+  std::tuple<Args...> args_;
+};
+
+} // namespace detail
+
+/// An error of type `E` with a chain of context frames.
+///
+/// The chain is two pointers' worth of state on top of `E`: the frames
+/// themselves live in a `context_arena`. Copies share their frames, which
+/// are immutable. Comparisons and hashing look at the error only.
+template <typename E> class contextual {
+public:
+  using error_type = E;
+
+  /// Constructs the error, with no context. Implicit, so that an `E` can be
+  /// returned wherever a `contextual<E>` is expected.
+  template <typename G = E,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * =
+                nullptr>
+  constexpr contextual(G &&e) : error_(std::forward<G>(e)) {}
+
+  /// \returns the wrapped error
+  /// \group error
+  constexpr const E &error() const & noexcept { return error_; }
+  /// \group error
+  E &error() & noexcept { return error_; }
+  /// \group error
+  E &&error() && noexcept { return std::move(error_); }
+
+  /// \returns the most recently attached frame, or nullptr
+  const context_frame *context() const noexcept { return context_; }
+
+  /// Records a frame in the current context arena. If the arena is full, or
+  /// no `context_scope` is live, the frame is dropped and counted in
+  /// `context_arena::dropped()`; the first drop outside a scope on a thread
+  /// is also reported on stderr.
+  template <typename... Args> void push(const char *what, Args &&... args) {
+    using frame = detail::context_frame_impl<detail::context_arg_t<Args>...>;
+    static_assert(detail::conjunction<std::is_trivially_destructible<
+                      detail::context_arg_t<Args>>...>::value,
+                  "context arguments must be trivially destructible, pass "
+                  "views instead of owning strings");
+    void *p = current_context_arena().allocate(sizeof(frame), alignof(frame));
+    if (p) {
+      context_ = ::new (p) frame(what, context_, std::forward<Args>(args)...);
+    } else if (!detail::installed_context_arena()) {
+      detail::report_unscoped_context();
+    }
+  }
+
+  /// Calls `f(frame)` for every frame, most recently attached first.
+  template <typename F> void for_each_context(F &&f) const {
+    for (const context_frame *c = context_; c; c = c->next()) {
+      f(*c);
+    }
+  }
+
+  /// Appends every frame to `out`, most recently attached first, separated
+  /// by `separator`.
+  void write_context(std::string &out, const char *separator = ": ") const {
+    for (const context_frame *c = context_; c; c = c->next()) {
+      c->write(out);
+      if (c->next()) {
+        out += separator;
+      }
+    }
+  }
+
+  /// \returns the formatted context, see `write_context`
+  std::string context_string(const char *separator = ": ") const {
+    std::string out;
+    write_context(out, separator);
+    return out;
+  }
+
+private:
+  E error_;
+  const context_frame *context_ = nullptr;
+};
+
+/// Compares the errors, ignoring the context.
+/// \group relop
+template <typename E, typename G>
+constexpr bool operator==(const contextual<E> &lhs, const contextual<G> &rhs) {
+  return lhs.error() == rhs.error();
+}
+/// \group relop
+template <typename E, typename G>
+constexpr bool operator!=(const contextual<E> &lhs, const contextual<G> &rhs) {
+  return lhs.error() != rhs.error();
+}
+
+// The frames live in the arena, not in the object
+template <typename E>
+struct is_trivially_relocatable<contextual<E>> : is_trivially_relocatable<E> {};
+
+/// \exclude
+namespace detail {
+
+template <typename G, typename... Args>
+G &push_context(G &e, const char *what, Args &&... args) {
+  e.push(what, std::forward<Args>(args)...);
+  return e;
+}
+
+} // namespace detail
+
+// Backs result<T, E>::with_context. An error that already carries context
+// gets one more frame through or_else, keeping the result type; a plain
+// error is wrapped through map_error. Found by ADL from the member.
+/// \exclude
+template <typename R, typename... Args,
+          detail::enable_if_t<detail::is_contextual<
+              typename detail::decay_t<R>::error_type>::value> * = nullptr>
+detail::decay_t<R> tao_result_with_context(R &&r, const char *what,
+                                           Args &&... args) {
+  using error_type = typename detail::decay_t<R>::error_type;
+  return detail::decay_t<R>(std::forward<R>(r)).or_else([&](error_type &e) {
+    e.push(what, std::forward<Args>(args)...);
+  });
+}
+
+/// \exclude
+template <typename R, typename... Args,
+          detail::enable_if_t<!detail::is_contextual<
+              typename detail::decay_t<R>::error_type>::value> * = nullptr>
+detail::with_context_result<typename detail::decay_t<R>::value_type,
+                            typename detail::decay_t<R>::error_type>
+tao_result_with_context(R &&r, const char *what, Args &&... args) {
+  using error_type = typename detail::decay_t<R>::error_type;
+  return std::forward<R>(r).map_error([&](error_type e) {
+    contextual<error_type> c(std::move(e));
+    c.push(what, std::forward<Args>(args)...);
+    return c;
+  });
+}
+
+} // namespace tao
+
+namespace std {
+/// Hashes the error of a `contextual`, so that it hashes like it compares.
+template <typename E> struct hash<tao::contextual<E>> {
+  std::size_t operator()(const tao::contextual<E> &c) const {
+    return std::hash<E>()(c.error());
+  }
+};
+} // namespace std
+
+#endif // TAO_RESULT_CONTEXT_HPP_
@@ -0,0 +1,212 @@
+//! \file tao/result/hash.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_HASH_HPP_
+#define TAO_RESULT_HASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// hash_append in the style of N3980 ("Types Don't Know #"): a type describes
+// which bytes make up its value by calling hash_append on its parts, and a
+// single hash algorithm consumes them. Composite keys are hashed in one pass
+// instead of combining the std::hash of every member.
+//
+// A hash algorithm is any type `H` with
+//   void operator()(const void *data, std::size_t len);
+// To make a user type hashable, declare next to it
+//   template <typename H> void hash_append(H &h, const my_type &x);
+// and call hash_append on each member.
+
+namespace tao {
+
+/// A fast, non-cryptographic hash algorithm for `hash_append`. Consumes
+/// 8 bytes per step and finishes with the MurmurHash3 avalanche.
+class default_hasher {
+public:
+  using result_type = std::size_t;
+
+  void operator()(const void *key, std::size_t len) noexcept {
+    const unsigned char *p = static_cast<const unsigned char *>(key);
+    for (; len >= 8; p += 8, len -= 8) {
+      std::uint64_t k;
+      std::memcpy(&k, p, 8);
+      mix(k);
+    }
+    if (len != 0) {
+      std::uint64_t k = 0;
+      std::memcpy(&k, p, len);
+      mix(k ^ (std::uint64_t(len) << 56));
+    }
+  }
+
+  explicit operator result_type() noexcept {
+    std::uint64_t h = state_;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<result_type>(h);
+  }
+
+private:
+  void mix(std::uint64_t k) noexcept {
+    state_ = (state_ ^ k) * 0x9e3779b97f4a7c15ULL;
+    state_ ^= state_ >> 29;
+  }
+
+  std::uint64_t state_ = 0xcbf29ce484222325ULL;
+};
+
+/// \exclude
+namespace detail {
+
+// Types whose value is exactly their object representation
+template <typename T>
+struct is_contiguously_hashable
+    : std::integral_constant<bool, std::is_integral<T>::value ||
+                                       std::is_enum<T>::value ||
+                                       std::is_pointer<T>::value> {};
+
+struct hash_bytes_tag {};
+struct hash_float_tag {};
+struct hash_std_tag {};
+
+template <typename T>
+using hash_append_tag = conditional_t<
+    is_contiguously_hashable<T>::value, hash_bytes_tag,
+    conditional_t<std::is_floating_point<T>::value, hash_float_tag,
+                  hash_std_tag>>;
+
+template <typename H, typename T>
+void hash_append_impl(H &h, const T &t, hash_bytes_tag) noexcept {
+  h(std::addressof(t), sizeof(t));
+}
+
+// +0.0 and -0.0 compare equal, so they must hash equal
+template <typename H, typename T>
+void hash_append_impl(H &h, const T &t, hash_float_tag) noexcept {
+  const T v = t == T(0) ? T(0) : t;
+  h(std::addressof(v), sizeof(v));
+}
+
+// Anything else falls back to its std::hash
+template <typename H, typename T>
+void hash_append_impl(H &h, const T &t, hash_std_tag) {
+  const std::size_t v = std::hash<T>()(t);
+  h(std::addressof(v), sizeof(v));
+}
+
+} // namespace detail
+
+/// Feeds the value of `t` to the hash algorithm `h`. Integral, enumeration
+/// and pointer types are hashed as bytes, floating point values after folding
+/// `-0.0` into `+0.0`, and any other type through its `std::hash`.
+template <typename H, typename T> void hash_append(H &h, const T &t) {
+  detail::hash_append_impl(h, t, detail::hash_append_tag<T>{});
+}
+
+/// \exclude
+template <typename H> void hash_append(H &h, const monostate &) noexcept {
+  const unsigned char tag = 0;
+  h(&tag, 1);
+}
+
+template <typename H, typename T> void hash_append(H &h, const optional<T> &o);
+template <typename H, typename T, typename E>
+void hash_append(H &h, const result<T, E> &r);
+template <typename H, typename E>
+void hash_append(H &h, const result<void, E> &r);
+template <typename H, typename T, typename U>
+void hash_append(H &h, const std::pair<T, U> &p);
+template <typename H, typename... Ts>
+void hash_append(H &h, const std::tuple<Ts...> &t);
+
+/// Feeds the engagement flag and, if engaged, the value.
+template <typename H, typename T> void hash_append(H &h, const optional<T> &o) {
+  const unsigned char engaged = o.has_value();
+  h(&engaged, 1);
+  if (o.has_value()) {
+    hash_append(h, *o);
+  }
+}
+
+/// Feeds the discriminant, then the value or the error.
+template <typename H, typename T, typename E>
+void hash_append(H &h, const result<T, E> &r) {
+  const unsigned char has_value = r.has_value();
+  h(&has_value, 1);
+  if (r.has_value()) {
+    hash_append(h, *r);
+  } else {
+    hash_append(h, r.error());
+  }
+}
+
+/// \exclude
+template <typename H, typename E>
+void hash_append(H &h, const result<void, E> &r) {
+  const unsigned char has_value = r.has_value();
+  h(&has_value, 1);
+  if (!r.has_value()) {
+    hash_append(h, r.error());
+  }
+}
+
+/// Feeds both members, in order.
+template <typename H, typename T, typename U>
+void hash_append(H &h, const std::pair<T, U> &p) {
+  hash_append(h, p.first);
+  hash_append(h, p.second);
+}
+
+/// \exclude
+namespace detail {
+template <typename H, typename Tuple, std::size_t... I>
+void hash_append_tuple(H &h, const Tuple &t, std::index_sequence<I...>) {
+  using swallow = int[];
+  (void)swallow{0, (hash_append(h, std::get<I>(t)), 0)...};
+}
+} // namespace detail
+
+/// Feeds every element, in order.
+template <typename H, typename... Ts>
+void hash_append(H &h, const std::tuple<Ts...> &t) {
+  detail::hash_append_tuple(h, t, std::index_sequence_for<Ts...>{});
+}
+
+/// A hash function object for unordered containers that runs `hash_append`
+/// with the algorithm `H` over the whole key.
+///
+/// *Examples*:
+/// ```
+/// std::unordered_map<std::tuple<tao::optional<int>, tao::optional<int>>,
+///                    std::string, tao::uhash<>> m;
+/// ```
+template <typename H = default_hasher> struct uhash {
+  using result_type = typename H::result_type;
+
+  template <typename T> result_type operator()(const T &t) const {
+    H h;
+    hash_append(h, t);
+    return static_cast<result_type>(h);
+  }
+};
+
+} // namespace tao
+
+#endif // TAO_RESULT_HASH_HPP_
@@ -0,0 +1,99 @@
+//! \file tao/result/instrument.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_INSTRUMENT_HPP_
+#define TAO_RESULT_INSTRUMENT_HPP_
+
+#include <string>
+
+#include <tao/result/result.hpp>
+
+// Exporting the call-site counters recorded under TAO_RESULT_INSTRUMENT.
+// Built without it, the functions here write nothing, so a metrics endpoint
+// can call them unconditionally.
+
+namespace tao {
+namespace instrument {
+
+/// \exclude
+namespace detail {
+
+inline const char *event_name(unsigned e) noexcept {
+  static const char *const names[] = {"empty_construct", "error_construct",
+                                      "bad_access", "or_else_fallback"};
+  return names[e];
+}
+
+// Label values escape backslash, double quote and newline
+inline void append_label(std::string &out, const char *s) {
+  for (; *s; ++s) {
+    switch (*s) {
+    case '\\':
+      out += "\\\\";
+      break;
+    case '"':
+      out += "\\\"";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      out += *s;
+    }
+  }
+}
+
+} // namespace detail
+
+/// \brief Appends every non-zero counter to `out` in the Prometheus text
+/// exposition format, as the counter `tao_result_events_total` labelled with
+/// `event`, `file`, `line` and `function`.
+///
+/// *Examples*:
+/// ```
+/// tao_result_events_total{event="error_construct",file="src/parse.cpp",line="42",function="header parse(span)"} 17
+/// ```
+inline void write_prometheus(std::string &out) {
+#ifdef TAO_RESULT_INSTRUMENT
+  out += "# TYPE tao_result_events_total counter\n";
+  for_each_site([&out](const site_counts &c) {
+    for (unsigned e = 0; e < event_count; ++e) {
+      if (c.counts[e] == 0) {
+        continue;
+      }
+      out += "tao_result_events_total{event=\"";
+      out += detail::event_name(e);
+      out += "\",file=\"";
+      detail::append_label(out, c.file ? c.file : "<overflow>");
+      out += "\",line=\"";
+      out += std::to_string(c.line);
+      out += "\",function=\"";
+      detail::append_label(out, c.function ? c.function : "");
+      out += "\"} ";
+      out += std::to_string(c.counts[e]);
+      out += '\n';
+    }
+  });
+#else
+  (void)out;
+#endif
+}
+
+/// \returns the counters in the Prometheus text exposition format, see
+/// `write_prometheus`
+inline std::string prometheus_text() {
+  std::string out;
+  write_prometheus(out);
+  return out;
+}
+
+} // namespace instrument
+} // namespace tao
+
+#endif // TAO_RESULT_INSTRUMENT_HPP_
@@ -0,0 +1,1628 @@
+//! \file tao/result/multi_error.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_MULTI_ERROR_HPP_
+#define TAO_RESULT_MULTI_ERROR_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// result<T, E1, E2, ...> holds a value or one of several errors, for code
+// that fails in more than one typed way without collapsing the errors into a
+// single sum type:
+//
+//   tao::result<message, std::errc, parse_error> read_message(socket &s) {
+//     tao::result<bytes, std::errc> b = s.read();
+//     if (!b) return tao::make_unexpected(b.error());
+//     return parse(*b); // a result<message, parse_error> widens implicitly
+//   }
+//
+//   read_message(s).match([](message &m) { dispatch(m); },
+//                         [](std::errc e) { retry(e); },
+//                         [](parse_error &p) { reject(p); });
+//
+// The value and every error share one union and one discriminant of the
+// smallest unsigned type that numbers them, so result<int, std::errc,
+// parse_error> is as large as result<int, std::errc> when parse_error fits
+// in an int. Visitation goes through a switch over the discriminant, eight
+// alternatives per switch, with each case calling the handler directly.
+
+namespace tao {
+
+/// \brief A tag type to tell a multi-error result to construct its error
+/// alternative `I` in-place
+template <std::size_t I> struct in_place_error_t {
+  explicit in_place_error_t() = default;
+};
+/// \brief A tag to tell a multi-error result to construct its error
+/// alternative `I` in-place
+template <std::size_t I>
+TAO_RESULT_INLINE_VAR constexpr in_place_error_t<I> in_place_error{};
+
+/// \exclude
+namespace detail {
+
+template <typename T> struct is_in_place_error : std::false_type {};
+template <std::size_t I>
+struct is_in_place_error<in_place_error_t<I>> : std::true_type {};
+
+template <typename T> struct is_multi_result_impl : std::false_type {};
+template <typename T, typename E1, typename E2, typename... Es>
+struct is_multi_result_impl<result<T, E1, E2, Es...>> : std::true_type {};
+template <typename T> using is_multi_result = is_multi_result_impl<decay_t<T>>;
+
+// Whether R is a result<U, Es...> for some U, with exactly these errors
+template <typename R, typename... Es> struct multi_has_errors : std::false_type {};
+template <typename U, typename... Es>
+struct multi_has_errors<result<U, Es...>, Es...> : std::true_type {};
+
+template <bool...> struct multi_bools {};
+template <bool... Bs>
+using multi_all = std::is_same<multi_bools<true, Bs...>, multi_bools<Bs..., true>>;
+
+// The index of the first G in Ts..., or sizeof...(Ts) if there is none
+template <typename G, typename... Ts> struct multi_find;
+template <typename G>
+struct multi_find<G> : std::integral_constant<std::size_t, 0> {};
+template <typename G, typename... Ts>
+struct multi_find<G, G, Ts...> : std::integral_constant<std::size_t, 0> {};
+template <typename G, typename H, typename... Ts>
+struct multi_find<G, H, Ts...>
+    : std::integral_constant<std::size_t, 1 + multi_find<G, Ts...>::value> {};
+
+// The alternative of the error G among the alternatives T0, Es..., where T0
+// is the value
+template <typename G, typename T0, typename... Es>
+struct multi_find_error
+    : std::integral_constant<std::size_t, 1 + multi_find<G, Es...>::value> {};
+
+// How many times G occurs in Ts...
+template <typename G, typename... Ts>
+struct multi_count : std::integral_constant<std::size_t, 0> {};
+template <typename G, typename H, typename... Ts>
+struct multi_count<G, H, Ts...>
+    : std::integral_constant<std::size_t, std::is_same<G, H>::value +
+                                              multi_count<G, Ts...>::value> {};
+
+template <std::size_t I, typename... Ts> struct multi_nth;
+template <typename H, typename... Ts> struct multi_nth<0, H, Ts...> {
+  using type = H;
+};
+template <std::size_t I, typename H, typename... Ts>
+struct multi_nth<I, H, Ts...> : multi_nth<I - 1, Ts...> {};
+
+// The smallest unsigned type that numbers N alternatives
+template <std::size_t N>
+using multi_index_t = conditional_t<
+    (N <= std::numeric_limits<unsigned char>::max()), unsigned char,
+    conditional_t<(N <= std::numeric_limits<unsigned short>::max()),
+                  unsigned short, unsigned int>>;
+
+template <std::size_t I> struct multi_index_tag {};
+
+// The alternatives of a multi-error result, the value first, and the traits
+// that select the trivial special members below
+template <typename... Ts> struct multi_alternatives {
+  template <std::size_t I> using at = typename multi_nth<I, Ts...>::type;
+
+  static constexpr bool trivially_destructible =
+      multi_all<std::is_trivially_destructible<Ts>::value...>::value;
+  static constexpr bool trivially_copy_constructible =
+      multi_all<TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(Ts)...>::value;
+  static constexpr bool trivially_copy_assignable =
+      multi_all<(TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(Ts) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(Ts) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(Ts))...>::value;
+#ifndef TAO_OPTIONAL_GCC49
+  static constexpr bool trivially_move_constructible =
+      multi_all<std::is_trivially_move_constructible<Ts>::value...>::value;
+  static constexpr bool trivially_move_assignable =
+      multi_all<(std::is_trivially_destructible<Ts>::value &&
+                 std::is_trivially_move_constructible<Ts>::value &&
+                 std::is_trivially_move_assignable<Ts>::value)...>::value;
+#else
+  static constexpr bool trivially_move_constructible = false;
+  static constexpr bool trivially_move_assignable = false;
+#endif
+
+  static constexpr bool nothrow_move_constructible =
+      multi_all<std::is_nothrow_move_constructible<Ts>::value...>::value;
+  static constexpr bool nothrow_move_assignable =
+      multi_all<std::is_nothrow_move_assignable<Ts>::value...>::value;
+  static constexpr bool swappable =
+      multi_all<(std::is_move_constructible<Ts>::value &&
+                 is_swappable<Ts>::value)...>::value;
+  static constexpr bool nothrow_swappable =
+      multi_all<(std::is_nothrow_move_constructible<Ts>::value &&
+                 is_nothrow_swappable<Ts>::value)...>::value;
+};
+
+// A union of the alternatives, the first one as head_ and the rest nested in
+// tail_. It is trivially destructible when all of them are; otherwise whoever
+// holds it destroys the active member.
+template <bool TrivialDtor, typename... Ts> union multi_union {};
+
+template <typename H, typename... Ts> union multi_union<true, H, Ts...> {
+  constexpr multi_union() noexcept : dummy_() {}
+
+  template <typename... Args>
+  constexpr multi_union(multi_index_tag<0>, Args &&... args)
+      : head_(std::forward<Args>(args)...) {}
+
+  template <std::size_t I, typename... Args>
+  constexpr multi_union(multi_index_tag<I>, Args &&... args)
+      : tail_(multi_index_tag<I - 1>{}, std::forward<Args>(args)...) {}
+
+  struct dummy {};
+
+  dummy dummy_;
+  H head_;
+  multi_union<true, Ts...> tail_;
+};
+
+template <typename H, typename... Ts> union multi_union<false, H, Ts...> {
+  constexpr multi_union() noexcept : dummy_() {}
+
+  template <typename... Args>
+  constexpr multi_union(multi_index_tag<0>, Args &&... args)
+      : head_(std::forward<Args>(args)...) {}
+
+  template <std::size_t I, typename... Args>
+  constexpr multi_union(multi_index_tag<I>, Args &&... args)
+      : tail_(multi_index_tag<I - 1>{}, std::forward<Args>(args)...) {}
+
+  TAO_RESULT_CONSTEXPR20 ~multi_union() {}
+
+  struct dummy {};
+
+  dummy dummy_;
+  H head_;
+  multi_union<false, Ts...> tail_;
+};
+
+// The member of a multi_union for alternative I, with the value category of
+// the union
+template <std::size_t I> struct multi_get {
+  template <typename U> static constexpr decltype(auto) get(U &&u) noexcept {
+    return multi_get<I - 1>::get(std::forward<U>(u).tail_);
+  }
+};
+
+template <> struct multi_get<0> {
+  template <typename U> static constexpr decltype(auto) get(U &&u) noexcept {
+    return (std::forward<U>(u).head_);
+  }
+};
+
+template <std::size_t N, std::size_t B, bool = (B < N)>
+struct multi_switch_next;
+
+// Calls f(multi_index_tag<I>{}) for the alternative I == i of N. Each block
+// of eight alternatives is one switch with every case calling f directly,
+// which compilers lower to a jump table or a short compare chain; the cases
+// past N are constant-false and fold away. Longer lists chain blocks.
+template <std::size_t N, std::size_t B = 0> struct multi_switch {
+  template <std::size_t K>
+  using tag = multi_index_tag<(B + K < N ? B + K : N - 1)>;
+
+  template <typename R, typename F>
+  static constexpr R call(std::size_t i, F &&f) {
+#define TAO_RESULT_MULTI_CASE(K)                                               \
+  case K:                                                                      \
+    if (B + K < N)                                                             \
+      return std::forward<F>(f)(tag<K>{});                                     \
+    break;
+
+    switch (i - B) {
+      TAO_RESULT_MULTI_CASE(0)
+      TAO_RESULT_MULTI_CASE(1)
+      TAO_RESULT_MULTI_CASE(2)
+      TAO_RESULT_MULTI_CASE(3)
+      TAO_RESULT_MULTI_CASE(4)
+      TAO_RESULT_MULTI_CASE(5)
+      TAO_RESULT_MULTI_CASE(6)
+      TAO_RESULT_MULTI_CASE(7)
+    default:
+      break;
+    }
+#undef TAO_RESULT_MULTI_CASE
+    return multi_switch_next<N, B + 8>::template call<R>(i,
+                                                         std::forward<F>(f));
+  }
+};
+
+template <std::size_t N, std::size_t B, bool>
+struct multi_switch_next : multi_switch<N, B> {};
+
+// Past the last block; i < N always, so this is not reached
+template <std::size_t N, std::size_t B> struct multi_switch_next<N, B, false> {
+  template <typename R, typename F>
+  static constexpr R call(std::size_t, F &&f) {
+    return std::forward<F>(f)(multi_index_tag<N - 1>{});
+  }
+};
+
+template <typename Self, typename Other> struct multi_copier {
+  Self &self;
+  Other &&rhs;
+
+  template <std::size_t I>
+  TAO_RESULT_CONSTEXPR20 void operator()(multi_index_tag<I>) const {
+    self.template construct<I>(
+        multi_get<I>::get(std::forward<Other>(rhs).union_));
+  }
+};
+
+template <typename Self> struct multi_destroyer {
+  Self &self;
+
+  template <std::size_t I>
+  TAO_RESULT_CONSTEXPR20 void operator()(multi_index_tag<I>) const {
+    using alt = typename Self::alternatives::template at<I>;
+    multi_get<I>::get(self.union_).~alt();
+  }
+};
+
+// Uniform access to result<U, G> and result<U, G1, G2, ...>: alternative 0
+// is the value, alternative J + 1 the error J
+template <typename R> struct multi_result_traits;
+template <typename U, typename... Gs>
+struct multi_result_traits<result<U, Gs...>> {
+  using value_type = U;
+  static constexpr std::size_t size = 1 + sizeof...(Gs);
+  template <std::size_t J> using error_type = typename multi_nth<J, Gs...>::type;
+  template <typename... Es>
+  using errors_within = multi_all<(multi_count<Gs, Es...>::value != 0)...>;
+};
+
+template <typename R, enable_if_t<is_result<R>::value> * = nullptr>
+constexpr std::size_t multi_index_of(const R &r) noexcept {
+  return r.has_value() ? 0 : 1;
+}
+
+template <typename R, enable_if_t<!is_result<R>::value> * = nullptr>
+constexpr std::size_t multi_index_of(const R &r) noexcept {
+  return r.index();
+}
+
+template <std::size_t J, typename R,
+          enable_if_t<is_result<R>::value> * = nullptr>
+constexpr decltype(auto) multi_error_of(R &&r) noexcept {
+  return std::forward<R>(r).error();
+}
+
+template <std::size_t J, typename R,
+          enable_if_t<!is_result<R>::value> * = nullptr>
+constexpr decltype(auto) multi_error_of(R &&r) noexcept {
+  return std::forward<R>(r).template error<J>();
+}
+
+// Whether the result Other can be converted to one with value T and errors
+// Es..., given that its value is passed on as V: each of its errors must be
+// one of Es..., and a void value only converts to a void value
+template <typename T, typename V> struct multi_value_converts
+    : std::is_constructible<T, V> {};
+template <> struct multi_value_converts<void, void> : std::true_type {};
+
+template <typename T, typename V> struct multi_value_implicit
+    : std::is_convertible<V, T> {};
+template <> struct multi_value_implicit<void, void> : std::true_type {};
+
+template <typename Other>
+using multi_value_arg = decltype(*std::declval<Other>());
+
+template <typename Self, typename T, typename Other, typename... Es>
+using enable_multi_from_other = enable_if_t<
+    !std::is_same<decay_t<Other>, Self>::value &&
+    (is_result<Other>::value || is_multi_result<Other>::value) &&
+    multi_value_converts<T, multi_value_arg<Other>>::value &&
+    multi_result_traits<decay_t<Other>>::template errors_within<Es...>::value>;
+
+template <typename Self, typename Other> struct multi_converter {
+  Self &self;
+  Other &&rhs;
+
+  template <std::size_t J>
+  TAO_RESULT_CONSTEXPR20 void operator()(multi_index_tag<J> tag) const {
+    convert(tag, std::integral_constant<bool, J == 0>{});
+  }
+
+  template <std::size_t J>
+  TAO_RESULT_CONSTEXPR20 void convert(multi_index_tag<J>,
+                                      std::true_type) const {
+    construct_value(std::is_void<
+                    typename multi_result_traits<decay_t<Other>>::value_type>{});
+  }
+
+  template <std::size_t J>
+  TAO_RESULT_CONSTEXPR20 void convert(multi_index_tag<J>,
+                                      std::false_type) const {
+    using error_type = typename multi_result_traits<
+        decay_t<Other>>::template error_type<J - 1>;
+    self.template construct<Self::template error_index<error_type>::value>(
+        multi_error_of<J - 1>(std::forward<Other>(rhs)));
+  }
+
+  TAO_RESULT_CONSTEXPR20 void construct_value(std::false_type) const {
+    self.template construct<0>(*std::forward<Other>(rhs));
+  }
+
+  TAO_RESULT_CONSTEXPR20 void construct_value(std::true_type) const {
+    self.template construct<0>();
+  }
+};
+
+// The storage holds the alternatives Ts..., the value first, in a single
+// union with index_ naming the active one
+template <typename L> struct multi_storage;
+
+template <typename... Ts> struct multi_storage<multi_alternatives<Ts...>> {
+  using alternatives = multi_alternatives<Ts...>;
+  using index_type = multi_index_t<sizeof...(Ts)>;
+  using dispatch = multi_switch<sizeof...(Ts)>;
+
+  // The alternative of the error G
+  template <typename G> using error_index = multi_find_error<G, Ts...>;
+
+  constexpr multi_storage() : union_(multi_index_tag<0>{}), index_(0) {}
+
+  template <std::size_t I, typename... Args>
+  constexpr multi_storage(multi_index_tag<I> tag, Args &&... args)
+      : union_(tag, std::forward<Args>(args)...), index_(I) {}
+
+  template <typename Other>
+  TAO_RESULT_CONSTEXPR20 multi_storage(from_storage_t, Other &&rhs)
+      : union_(), index_(rhs.index_) {
+    dispatch::template call<void>(
+        index_, multi_copier<multi_storage, Other>{*this,
+                                                   std::forward<Other>(rhs)});
+  }
+
+  template <typename Other>
+  TAO_RESULT_CONSTEXPR20 multi_storage(from_result_t, Other &&rhs)
+      : union_(), index_(0) {
+    multi_switch<multi_result_traits<decay_t<Other>>::size>::template call<
+        void>(multi_index_of(rhs),
+              multi_converter<multi_storage, Other>{*this,
+                                                    std::forward<Other>(rhs)});
+  }
+
+  // Constructs alternative I in storage that holds none
+  template <std::size_t I, typename... Args>
+  TAO_RESULT_CONSTEXPR20 void construct(Args &&... args) {
+    detail::construct_at(std::addressof(multi_get<I>::get(union_)),
+                         std::forward<Args>(args)...);
+    index_ = static_cast<index_type>(I);
+  }
+
+  TAO_RESULT_CONSTEXPR20 void destroy() {
+    dispatch::template call<void>(index_,
+                                  multi_destroyer<multi_storage>{*this});
+  }
+
+  multi_union<alternatives::trivially_destructible, Ts...> union_;
+  index_type index_;
+};
+
+template <typename L, bool = L::trivially_destructible>
+struct multi_storage_base : multi_storage<L> {
+  using multi_storage<L>::multi_storage;
+};
+
+template <typename L> struct multi_storage_base<L, false> : multi_storage<L> {
+  using multi_storage<L>::multi_storage;
+
+  multi_storage_base() = default;
+  multi_storage_base(const multi_storage_base &) = default;
+  multi_storage_base(multi_storage_base &&) = default;
+  multi_storage_base &operator=(const multi_storage_base &) = default;
+  multi_storage_base &operator=(multi_storage_base &&) = default;
+
+  TAO_RESULT_CONSTEXPR20 ~multi_storage_base() { this->destroy(); }
+};
+
+template <typename Self, typename Other> struct multi_assigner {
+  Self &self;
+  Other &&rhs;
+
+  template <std::size_t I>
+  TAO_RESULT_CONSTEXPR20 void operator()(multi_index_tag<I>) const {
+    if (self.index_ == I) {
+      multi_get<I>::get(self.union_) =
+          multi_get<I>::get(std::forward<Other>(rhs).union_);
+    } else {
+      self.template emplace_alternative<I>(
+          multi_get<I>::get(std::forward<Other>(rhs).union_));
+    }
+  }
+};
+
+template <typename Self> struct multi_swapper {
+  Self &self;
+  Self &rhs;
+
+  template <std::size_t I>
+  TAO_RESULT_CONSTEXPR20 void operator()(multi_index_tag<I>) const {
+    using std::swap;
+    swap(multi_get<I>::get(self.union_), multi_get<I>::get(rhs.union_));
+  }
+};
+
+// This base class provides the state changes that keep one alternative
+// alive at all times
+template <typename L> struct multi_operations_base : multi_storage_base<L> {
+  using multi_storage_base<L>::multi_storage_base;
+  using dispatch = typename multi_storage_base<L>::dispatch;
+
+  // Switches to alternative I constructed from args. If that construction
+  // may throw, it is made into a temporary first, so that a failure leaves
+  // the current alternative in place.
+  template <std::size_t I, typename... Args>
+  TAO_RESULT_CONSTEXPR20 void emplace_alternative(Args &&... args) {
+    using alt = typename L::template at<I>;
+    static_assert(std::is_nothrow_constructible<alt, Args &&...>::value ||
+                      std::is_nothrow_move_constructible<alt>::value,
+                  "emplacing an alternative that may throw on construction "
+                  "requires it to be nothrow move constructible");
+    emplace_impl<I>(std::integral_constant<
+                        bool, std::is_nothrow_constructible<
+                                  alt, Args &&...>::value>{},
+                    std::forward<Args>(args)...);
+  }
+
+  template <std::size_t I, typename... Args>
+  TAO_RESULT_CONSTEXPR20 void emplace_impl(std::true_type, Args &&... args) {
+    this->destroy();
+    this->template construct<I>(std::forward<Args>(args)...);
+  }
+
+  template <std::size_t I, typename... Args>
+  TAO_RESULT_CONSTEXPR20 void emplace_impl(std::false_type, Args &&... args) {
+    typename L::template at<I> tmp(std::forward<Args>(args)...);
+    this->destroy();
+    this->template construct<I>(std::move(tmp));
+  }
+
+  // Assigns the alternative of rhs if it is the current one, otherwise
+  // switches to it
+  template <typename Other>
+  TAO_RESULT_CONSTEXPR20 void assign(Other &&rhs) {
+    dispatch::template call<void>(
+        rhs.index_, multi_assigner<multi_operations_base, Other>{
+                        *this, std::forward<Other>(rhs)});
+  }
+
+  TAO_RESULT_CONSTEXPR20 void swap_same(multi_operations_base &rhs) {
+    dispatch::template call<void>(
+        this->index_, multi_swapper<multi_operations_base>{*this, rhs});
+  }
+};
+
+// This class manages conditionally having a trivial copy constructor
+// This specialization is for when all alternatives are trivially copy
+// constructible
+template <typename L, bool = L::trivially_copy_constructible>
+struct multi_copy_base : multi_operations_base<L> {
+  using multi_operations_base<L>::multi_operations_base;
+};
+
+// This specialization is for when some alternative is not trivially copy
+// constructible
+template <typename L> struct multi_copy_base<L, false> : multi_operations_base<L> {
+  using multi_operations_base<L>::multi_operations_base;
+
+  multi_copy_base() = default;
+  TAO_RESULT_CONSTEXPR20 multi_copy_base(const multi_copy_base &rhs)
+      : multi_operations_base<L>(from_storage_t{}, rhs) {}
+
+  multi_copy_base(multi_copy_base &&rhs) = default;
+  multi_copy_base &operator=(const multi_copy_base &rhs) = default;
+  multi_copy_base &operator=(multi_copy_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial move constructor
+template <typename L, bool = L::trivially_move_constructible>
+struct multi_move_base : multi_copy_base<L> {
+  using multi_copy_base<L>::multi_copy_base;
+};
+
+template <typename L> struct multi_move_base<L, false> : multi_copy_base<L> {
+  using multi_copy_base<L>::multi_copy_base;
+
+  multi_move_base() = default;
+  multi_move_base(const multi_move_base &rhs) = default;
+
+  TAO_RESULT_CONSTEXPR20 multi_move_base(multi_move_base &&rhs) noexcept(
+      L::nothrow_move_constructible)
+      : multi_copy_base<L>(from_storage_t{}, std::move(rhs)) {}
+  multi_move_base &operator=(const multi_move_base &rhs) = default;
+  multi_move_base &operator=(multi_move_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial copy assignment operator
+template <typename L, bool = L::trivially_copy_assignable>
+struct multi_copy_assign_base : multi_move_base<L> {
+  using multi_move_base<L>::multi_move_base;
+};
+
+template <typename L>
+struct multi_copy_assign_base<L, false> : multi_move_base<L> {
+  using multi_move_base<L>::multi_move_base;
+
+  multi_copy_assign_base() = default;
+  multi_copy_assign_base(const multi_copy_assign_base &rhs) = default;
+
+  multi_copy_assign_base(multi_copy_assign_base &&rhs) = default;
+  TAO_RESULT_CONSTEXPR20 multi_copy_assign_base &
+  operator=(const multi_copy_assign_base &rhs) {
+    this->assign(rhs);
+    return *this;
+  }
+  multi_copy_assign_base &operator=(multi_copy_assign_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial move assignment operator
+template <typename L, bool = L::trivially_move_assignable>
+struct multi_move_assign_base : multi_copy_assign_base<L> {
+  using multi_copy_assign_base<L>::multi_copy_assign_base;
+};
+
+template <typename L>
+struct multi_move_assign_base<L, false> : multi_copy_assign_base<L> {
+  using multi_copy_assign_base<L>::multi_copy_assign_base;
+
+  multi_move_assign_base() = default;
+  multi_move_assign_base(const multi_move_assign_base &rhs) = default;
+
+  multi_move_assign_base(multi_move_assign_base &&rhs) = default;
+
+  multi_move_assign_base &
+  operator=(const multi_move_assign_base &rhs) = default;
+
+  TAO_RESULT_CONSTEXPR20 multi_move_assign_base &
+  operator=(multi_move_assign_base &&rhs) noexcept(
+      L::nothrow_move_constructible && L::nothrow_move_assignable) {
+    this->assign(std::move(rhs));
+    return *this;
+  }
+};
+
+// Copy and move construction need every alternative to be copy/move
+// constructible; assignment additionally needs all of them to be nothrow
+// move constructible, so that switching alternatives can go through a
+// temporary
+template <typename... Ts>
+using multi_delete_ctor_base = optional_delete_ctor_base<
+    multi_alternatives<Ts...>,
+    multi_all<std::is_copy_constructible<Ts>::value...>::value,
+    multi_all<std::is_move_constructible<Ts>::value...>::value>;
+
+template <typename... Ts>
+using multi_delete_assign_base = optional_delete_assign_base<
+    multi_alternatives<Ts...>,
+    multi_all<(std::is_copy_constructible<Ts>::value &&
+               std::is_copy_assignable<Ts>::value &&
+               std::is_nothrow_move_constructible<Ts>::value)...>::value,
+    multi_all<(std::is_move_constructible<Ts>::value &&
+               std::is_move_assignable<Ts>::value &&
+               std::is_nothrow_move_constructible<Ts>::value)...>::value>;
+
+// The references the value accessors of a multi-error result return; none
+// for a void value
+template <typename T> struct multi_value_refs {
+  using ref = T &;
+  using cref = const T &;
+  using rref = T &&;
+  using crref = const T &&;
+};
+template <> struct multi_value_refs<void> {
+  using ref = void;
+  using cref = void;
+  using rref = void;
+  using crref = void;
+};
+
+// Invokes f with alternative I of the storage s. The value of a
+// result<void, ...> is the one alternative passed as no argument at all.
+template <bool NoArg> struct multi_apply {
+  template <std::size_t I, typename F, typename S>
+  static constexpr auto call(F &&f, S &&s)
+      -> decltype(detail::invoke(std::forward<F>(f),
+                                 multi_get<I>::get(std::forward<S>(s).union_))) {
+    return detail::invoke(std::forward<F>(f),
+                          multi_get<I>::get(std::forward<S>(s).union_));
+  }
+};
+
+template <> struct multi_apply<true> {
+  template <std::size_t I, typename F, typename S>
+  static constexpr auto call(F &&f, S &&)
+      -> decltype(detail::invoke(std::forward<F>(f))) {
+    return detail::invoke(std::forward<F>(f));
+  }
+};
+
+template <std::size_t I, bool Void, typename F, typename S>
+using multi_apply_result = decltype(multi_apply<(Void && I == 0)>::template call<I>(
+    std::declval<F>(), std::declval<S>()));
+
+// The common return type of f over the alternatives, if there is one
+template <bool Void, typename F, typename S, typename Seq, typename = void>
+struct multi_visit_result {};
+template <bool Void, typename F, typename S, std::size_t... Is>
+struct multi_visit_result<
+    Void, F, S, std::index_sequence<Is...>,
+    void_t<typename std::common_type<
+        multi_apply_result<Is, Void, F, S>...>::type>> {
+  using type =
+      typename std::common_type<multi_apply_result<Is, Void, F, S>...>::type;
+};
+
+// The same with handler I for alternative I. With the wrong number of
+// handlers the result is void, and match reports it.
+template <bool Ok, bool Void, typename S, typename Seq, typename Fs,
+          typename = void>
+struct multi_match_result {};
+template <bool Void, typename S, typename Seq, typename... Fs>
+struct multi_match_result<false, Void, S, Seq, std::tuple<Fs...>> {
+  using type = void;
+};
+template <bool Void, typename S, std::size_t... Is, typename... Fs>
+struct multi_match_result<
+    true, Void, S, std::index_sequence<Is...>, std::tuple<Fs...>,
+    void_t<typename std::common_type<
+        multi_apply_result<Is, Void, Fs, S>...>::type>> {
+  using type =
+      typename std::common_type<multi_apply_result<Is, Void, Fs, S>...>::type;
+};
+
+template <typename R, bool Void, typename F, typename S> struct multi_visitor {
+  F &&f;
+  S &&s;
+
+  template <std::size_t I>
+  constexpr R operator()(multi_index_tag<I>) const {
+    return multi_apply<(Void && I == 0)>::template call<I>(
+        std::forward<F>(f), std::forward<S>(s));
+  }
+};
+
+template <typename R, bool Void, typename S, typename... Fs>
+struct multi_matcher {
+  S &&s;
+  std::tuple<Fs &&...> fs;
+
+  template <std::size_t I>
+  constexpr R operator()(multi_index_tag<I>) const {
+    return multi_apply<(Void && I == 0)>::template call<I>(
+        std::forward<typename multi_nth<I, Fs...>::type>(std::get<I>(fs)),
+        std::forward<S>(s));
+  }
+};
+
+// Rebuilds the error of s, which holds one, as the same error of Ret. When
+// Mapped names an error, that one is replaced by the return value of f.
+template <typename Ret, std::size_t Mapped, typename F, typename S>
+struct multi_error_rebuilder {
+  F &&f;
+  S &&s;
+
+  // J is the index of the error; alternative J + 1 of s
+  template <std::size_t J>
+  constexpr Ret operator()(multi_index_tag<J> tag) const {
+    return rebuild(tag, std::integral_constant<bool, J == Mapped>{});
+  }
+
+  template <std::size_t J>
+  constexpr Ret rebuild(multi_index_tag<J>, std::false_type) const {
+    return Ret(in_place_error<J>,
+               multi_get<J + 1>::get(std::forward<S>(s).union_));
+  }
+
+  template <std::size_t J>
+  constexpr Ret rebuild(multi_index_tag<J> tag, std::true_type) const {
+    return map(tag, std::is_void<decltype(detail::invoke(
+                        std::declval<F>(),
+                        multi_get<J + 1>::get(std::declval<S>().union_)))>{});
+  }
+
+  template <std::size_t J>
+  constexpr Ret map(multi_index_tag<J>, std::false_type) const {
+    return Ret(in_place_error<J>,
+               detail::invoke(std::forward<F>(f),
+                              multi_get<J + 1>::get(std::forward<S>(s).union_)));
+  }
+
+  template <std::size_t J>
+  Ret map(multi_index_tag<J>, std::true_type) const {
+    detail::invoke(std::forward<F>(f),
+                   multi_get<J + 1>::get(std::forward<S>(s).union_));
+    return Ret(in_place_error<J>);
+  }
+};
+
+template <typename S> struct multi_thrower {
+  S &&s;
+
+  template <std::size_t J> void operator()(multi_index_tag<J>) const {
+    detail::throw_bad_result_access(
+        multi_get<J + 1>::get(std::forward<S>(s).union_));
+  }
+};
+
+template <typename R> struct multi_equal {
+  const R &lhs;
+  const R &rhs;
+
+  template <std::size_t I>
+  constexpr bool operator()(multi_index_tag<I> tag) const {
+    return equal(tag, std::integral_constant<bool, I == 0>{});
+  }
+
+  template <std::size_t I>
+  constexpr bool equal(multi_index_tag<I>, std::false_type) const {
+    return lhs.template error<I - 1>() == rhs.template error<I - 1>();
+  }
+
+  template <std::size_t I>
+  constexpr bool equal(multi_index_tag<I>, std::true_type) const {
+    return value_equal(std::is_void<typename R::value_type>{});
+  }
+
+  constexpr bool value_equal(std::false_type) const { return *lhs == *rhs; }
+  constexpr bool value_equal(std::true_type) const { return true; }
+};
+
+} // namespace detail
+
+/// A result object that holds either a value of type `T` or one of the
+/// errors `E1, E2, ...`. The value and the errors share a single union and
+/// a discriminant of the smallest unsigned type that numbers them, and the
+/// special member functions are trivial whenever they are trivial for every
+/// alternative, so `result<int, std::errc, parse_error>` is trivially
+/// copyable if `parse_error` is.
+///
+/// \details Errors are named by their position, `error<0>()` being `E1`,
+/// or by their type when it occurs once among them. `T` may be `void`.
+/// Results with fewer errors convert to this one when each of their errors
+/// is one of `E1, E2, ...`.
+///
+/// *Examples*:
+/// ```
+/// tao::result<config, std::errc, parse_error> r = load(path);
+/// if (r.has_error<parse_error>())
+///     log(r.error<parse_error>().line);
+///
+/// auto s = r.match([](config &c) { return c.name; },
+///                  [](std::errc e) { return std::string("io"); },
+///                  [](parse_error &p) { return p.message; });
+/// ```
+template <typename T, typename E1, typename E2, typename... Es>
+class result<T, E1, E2, Es...>
+    : private detail::multi_move_assign_base<
+          detail::multi_alternatives<detail::fixup_void<T>, E1, E2, Es...>>,
+      private detail::result_default_ctor_base<detail::fixup_void<T>>,
+      private detail::multi_delete_ctor_base<detail::fixup_void<T>, E1, E2,
+                                             Es...>,
+      private detail::multi_delete_assign_base<detail::fixup_void<T>, E1, E2,
+                                               Es...> {
+  using alternatives =
+      detail::multi_alternatives<detail::fixup_void<T>, E1, E2, Es...>;
+  using base = detail::multi_move_assign_base<alternatives>;
+  using ctor_base = detail::result_default_ctor_base<detail::fixup_void<T>>;
+  using refs = detail::multi_value_refs<T>;
+  using is_void = std::is_void<T>;
+
+  static constexpr std::size_t size = 3 + sizeof...(Es);
+  using dispatch = detail::multi_switch<size>;
+  using error_dispatch = detail::multi_switch<size - 1>;
+
+  template <typename G>
+  using error_index = detail::multi_find<G, E1, E2, Es...>;
+
+  template <typename G>
+  using unique_error =
+      std::integral_constant<bool,
+                             detail::multi_count<G, E1, E2, Es...>::value == 1>;
+
+  static_assert(!std::is_reference<T>::value, "T must not be a reference");
+  static_assert(!std::is_same<detail::decay_t<T>, in_place_t>::value,
+                "instantiation of result with in_place_t is ill-formed");
+  static_assert(!std::is_same<detail::decay_t<T>, unexpect_t>::value,
+                "instantiation of result with unexpect_t is ill-formed");
+  static_assert(!detail::is_unexpected<T>::value,
+                "instantiation of result with unexpected<E> is ill-formed");
+  static_assert(detail::multi_all<(!std::is_reference<E1>::value &&
+                                   !std::is_void<E1>::value),
+                                  (!std::is_reference<E2>::value &&
+                                   !std::is_void<E2>::value),
+                                  (!std::is_reference<Es>::value &&
+                                   !std::is_void<Es>::value)...>::value,
+                "the errors must not be references or void");
+
+  constexpr base &storage() & noexcept { return *this; }
+  constexpr const base &storage() const & noexcept { return *this; }
+  constexpr base &&storage() && noexcept { return std::move(*this); }
+  constexpr const base &&storage() const && noexcept {
+    return std::move(*this);
+  }
+
+  template <typename Ret, std::size_t Mapped = size, typename F, typename S>
+  static constexpr Ret rebuild_error(S &&s, F &&f) {
+    return error_dispatch::template call<Ret>(
+        s.index_ - 1u, detail::multi_error_rebuilder<Ret, Mapped, F, S>{
+                           std::forward<F>(f), std::forward<S>(s)});
+  }
+
+  struct no_map {};
+
+  template <typename S> TAO_RESULT_COLD static void throw_error(S &&s) {
+    error_dispatch::template call<void>(
+        s.index_ - 1u, detail::multi_thrower<S>{std::forward<S>(s)});
+  }
+
+  template <typename R, typename Self, typename F>
+  static constexpr R visit_impl(Self &&self, F &&f) {
+    return dispatch::template call<R>(
+        self.index_, detail::multi_visitor<R, is_void::value, F, Self>{
+                         std::forward<F>(f), std::forward<Self>(self)});
+  }
+
+  template <typename R, typename Self, typename... Fs>
+  static constexpr R match_impl(Self &&self, Fs &&... fs) {
+    static_assert(sizeof...(Fs) == size,
+                  "match takes one handler for the value and one for each "
+                  "error, in order");
+    return dispatch::template call<R>(
+        self.index_,
+        detail::multi_matcher<R, is_void::value, Self, Fs...>{
+            std::forward<Self>(self),
+            std::forward_as_tuple(std::forward<Fs>(fs)...)});
+  }
+
+public:
+  using value_type = T;
+  /// The error alternative `I`, `E1` for `I == 0`
+  template <std::size_t I>
+  using error_type = typename detail::multi_nth<I, E1, E2, Es...>::type;
+
+  /// \group and_then
+  /// Carries out some operation which returns a result on the stored
+  /// value if there is one. \requires `std::invoke(std::forward<F>(f),
+  /// value())` returns a `tao::result<U, E1, E2, ...>` for some `U`, with
+  /// the same errors. \returns The error of `*this` if there is one,
+  /// otherwise the return value of `std::invoke(std::forward<F>(f),
+  /// value())`.
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &;
+  template <typename F>
+  constexpr detail::multi_apply_result<0, is_void::value, F, base &>
+  and_then(F &&f) & {
+    using ret_t = detail::multi_apply_result<0, is_void::value, F, base &>;
+    static_assert(detail::multi_has_errors<ret_t, E1, E2, Es...>::value,
+                  "F must return a result with the same errors");
+
+    if (detail::engaged(*this))
+      return detail::multi_apply<is_void::value>::template call<0>(
+          std::forward<F>(f), storage());
+    return rebuild_error<ret_t>(storage(), no_map{});
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &&;
+  template <typename F>
+  constexpr detail::multi_apply_result<0, is_void::value, F, base &&>
+  and_then(F &&f) && {
+    using ret_t = detail::multi_apply_result<0, is_void::value, F, base &&>;
+    static_assert(detail::multi_has_errors<ret_t, E1, E2, Es...>::value,
+                  "F must return a result with the same errors");
+
+    if (detail::engaged(*this))
+      return detail::multi_apply<is_void::value>::template call<0>(
+          std::forward<F>(f), std::move(*this).storage());
+    return rebuild_error<ret_t>(std::move(*this).storage(), no_map{});
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) const &;
+  template <typename F>
+  constexpr detail::multi_apply_result<0, is_void::value, F, const base &>
+  and_then(F &&f) const & {
+    using ret_t =
+        detail::multi_apply_result<0, is_void::value, F, const base &>;
+    static_assert(detail::multi_has_errors<ret_t, E1, E2, Es...>::value,
+                  "F must return a result with the same errors");
+
+    if (detail::engaged(*this))
+      return detail::multi_apply<is_void::value>::template call<0>(
+          std::forward<F>(f), storage());
+    return rebuild_error<ret_t>(storage(), no_map{});
+  }
+
+  /// \brief Carries out some operation on the stored value if there is one.
+  /// \returns Let `U` be the result of `std::invoke(std::forward<F>(f),
+  /// value())`. Returns a `tao::result<U, E1, E2, ...>` holding either that
+  /// value or the error of `*this`.
+  ///
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &;
+  template <typename F> constexpr auto map(F &&f) & {
+    return map_impl(storage(), std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &&;
+  template <typename F> constexpr auto map(F &&f) && {
+    return map_impl(std::move(*this).storage(), std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) const &;
+  template <typename F> constexpr auto map(F &&f) const & {
+    return map_impl(storage(), std::forward<F>(f));
+  }
+
+  /// \brief Carries out some operation on the error alternative `I` (or the
+  /// error of type `G`) if that is what the result holds, leaving the value
+  /// and the other errors as they are.
+  /// \returns Let `U` be the result of `std::invoke(std::forward<F>(f),
+  /// error<I>())`. Returns a result whose error `I` is `U` (`monostate` if
+  /// it is `void`), holding the value, the other error or the return value
+  /// of `f`.
+  ///
+  /// *Examples*:
+  /// ```
+  /// tao::result<row, std::errc, parse_error> r = read_row(in);
+  /// tao::result<row, std::errc, std::string> s =
+  ///     std::move(r).map_error<parse_error>(&parse_error::describe);
+  /// ```
+  /// \group map_error
+  /// \synopsis template <std::size_t I, typename F> constexpr auto map_error(F &&f) &;
+  template <std::size_t I, typename F> constexpr auto map_error(F &&f) & {
+    return map_error_impl<I>(storage(), std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <std::size_t I, typename F> constexpr auto map_error(F &&f) &&;
+  template <std::size_t I, typename F> constexpr auto map_error(F &&f) && {
+    return map_error_impl<I>(std::move(*this).storage(), std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <std::size_t I, typename F> constexpr auto map_error(F &&f) const &;
+  template <std::size_t I, typename F>
+  constexpr auto map_error(F &&f) const & {
+    return map_error_impl<I>(storage(), std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename G, typename F> constexpr auto map_error(F &&f) &;
+  template <typename G, typename F> constexpr auto map_error(F &&f) & {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return map_error<error_index<G>::value>(std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename G, typename F> constexpr auto map_error(F &&f) &&;
+  template <typename G, typename F> constexpr auto map_error(F &&f) && {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return std::move(*this).template map_error<error_index<G>::value>(
+        std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename G, typename F> constexpr auto map_error(F &&f) const &;
+  template <typename G, typename F> constexpr auto map_error(F &&f) const & {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return map_error<error_index<G>::value>(std::forward<F>(f));
+  }
+
+  /// \brief Calls `f` with whichever of the value and the errors is stored.
+  /// \details The value of a `result<void, E1, E2, ...>` is passed as no
+  /// argument. The call goes through a switch over the discriminant.
+  /// \returns the return value of `f`, converted to the common type of its
+  /// return types over all the alternatives
+  /// \group visit
+  /// \synopsis template <typename F> constexpr auto visit(F &&f) &;
+  template <typename F>
+  constexpr typename detail::multi_visit_result<
+      is_void::value, F, base &, std::make_index_sequence<size>>::type
+  visit(F &&f) & {
+    using ret_t = typename detail::multi_visit_result<
+        is_void::value, F, base &, std::make_index_sequence<size>>::type;
+    return visit_impl<ret_t>(storage(), std::forward<F>(f));
+  }
+
+  /// \group visit
+  /// \synopsis template <typename F> constexpr auto visit(F &&f) &&;
+  template <typename F>
+  constexpr typename detail::multi_visit_result<
+      is_void::value, F, base &&, std::make_index_sequence<size>>::type
+  visit(F &&f) && {
+    using ret_t = typename detail::multi_visit_result<
+        is_void::value, F, base &&, std::make_index_sequence<size>>::type;
+    return visit_impl<ret_t>(std::move(*this).storage(), std::forward<F>(f));
+  }
+
+  /// \group visit
+  /// \synopsis template <typename F> constexpr auto visit(F &&f) const &;
+  template <typename F>
+  constexpr typename detail::multi_visit_result<
+      is_void::value, F, const base &, std::make_index_sequence<size>>::type
+  visit(F &&f) const & {
+    using ret_t = typename detail::multi_visit_result<
+        is_void::value, F, const base &, std::make_index_sequence<size>>::type;
+    return visit_impl<ret_t>(storage(), std::forward<F>(f));
+  }
+
+  /// \brief Calls the handler for whichever of the value and the errors is
+  /// stored: `fs` are one handler for the value followed by one for each
+  /// error, in order.
+  /// \details The value of a `result<void, E1, E2, ...>` is passed as no
+  /// argument. The call goes through a switch over the discriminant.
+  /// \returns the return value of the handler, converted to the common type
+  /// of the return types of all the handlers
+  /// \group match
+  /// \synopsis template <typename... Fs> constexpr auto match(Fs &&... fs) &;
+  template <typename... Fs>
+  constexpr typename detail::multi_match_result<
+      sizeof...(Fs) == size, is_void::value, base &,
+      std::make_index_sequence<size>, std::tuple<Fs...>>::type
+  match(Fs &&... fs) & {
+    using ret_t = typename detail::multi_match_result<
+        sizeof...(Fs) == size, is_void::value, base &,
+        std::make_index_sequence<size>, std::tuple<Fs...>>::type;
+    return match_impl<ret_t>(storage(), std::forward<Fs>(fs)...);
+  }
+
+  /// \group match
+  /// \synopsis template <typename... Fs> constexpr auto match(Fs &&... fs) &&;
+  template <typename... Fs>
+  constexpr typename detail::multi_match_result<
+      sizeof...(Fs) == size, is_void::value, base &&,
+      std::make_index_sequence<size>, std::tuple<Fs...>>::type
+  match(Fs &&... fs) && {
+    using ret_t = typename detail::multi_match_result<
+        sizeof...(Fs) == size, is_void::value, base &&,
+        std::make_index_sequence<size>, std::tuple<Fs...>>::type;
+    return match_impl<ret_t>(std::move(*this).storage(),
+                             std::forward<Fs>(fs)...);
+  }
+
+  /// \group match
+  /// \synopsis template <typename... Fs> constexpr auto match(Fs &&... fs) const &;
+  template <typename... Fs>
+  constexpr typename detail::multi_match_result<
+      sizeof...(Fs) == size, is_void::value, const base &,
+      std::make_index_sequence<size>, std::tuple<Fs...>>::type
+  match(Fs &&... fs) const & {
+    using ret_t = typename detail::multi_match_result<
+        sizeof...(Fs) == size, is_void::value, const base &,
+        std::make_index_sequence<size>, std::tuple<Fs...>>::type;
+    return match_impl<ret_t>(storage(), std::forward<Fs>(fs)...);
+  }
+
+  /// Constructs a result holding a value-initialized `T`.
+  /// \group ctor_default
+  constexpr result() = default;
+
+  /// Copy constructor
+  ///
+  /// Copies the value or the error from `rhs`.
+  constexpr result(const result &rhs) = default;
+
+  /// Move constructor
+  ///
+  /// Moves the value or the error from `rhs`.
+  constexpr result(result &&rhs) = default;
+
+  /// Constructs the stored value in-place using the given arguments.
+  /// \group in_place
+  /// \synopsis template <typename... Args> constexpr explicit result(in_place_t, Args&&... args);
+  template <typename... Args,
+            detail::enable_if_t<std::is_constructible<
+                detail::fixup_void<T>, Args &&...>::value> * = nullptr>
+  constexpr explicit result(in_place_t, Args &&... args)
+      : base(detail::multi_index_tag<0>{}, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs the error alternative `I` in-place using the given
+  /// arguments.
+  /// \group in_place_error
+  /// \synopsis template <std::size_t I, typename... Args> constexpr explicit result(in_place_error_t<I>, Args&&... args);
+  template <std::size_t I, typename... Args,
+            detail::enable_if_t<std::is_constructible<
+                error_type<I>, Args &&...>::value> * = nullptr>
+  constexpr explicit result(in_place_error_t<I>, Args &&... args)
+      : base(detail::multi_index_tag<I + 1>{}, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs the stored error from an `unexpected<G>`, where `G` occurs
+  /// once among the errors.
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(const unexpected<G>& e);
+  template <typename G,
+            detail::enable_if_t<unique_error<G>::value &&
+                                std::is_copy_constructible<G>::value> * =
+                nullptr>
+  constexpr result(const unexpected<G> &e)
+      : base(detail::multi_index_tag<1 + error_index<G>::value>{}, e.value()),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(unexpected<G>&& e);
+  template <typename G,
+            detail::enable_if_t<unique_error<G>::value &&
+                                std::is_move_constructible<G>::value> * =
+                nullptr>
+  constexpr result(unexpected<G> &&e) noexcept(
+      std::is_nothrow_move_constructible<G>::value)
+      : base(detail::multi_index_tag<1 + error_index<G>::value>{},
+             std::move(e.value())),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs the stored value with `u`.
+  /// \synopsis template <typename U=T> constexpr result(U&& u);
+  template <
+      typename U = T,
+      detail::enable_if_t<std::is_convertible<U &&, T>::value> * = nullptr,
+      detail::enable_if_t<std::is_constructible<T, U &&>::value &&
+                          !std::is_same<detail::decay_t<U>, in_place_t>::value &&
+                          !detail::is_in_place_error<detail::decay_t<U>>::value &&
+                          !detail::is_unexpected<U>::value &&
+                          !detail::is_result<U>::value &&
+                          !detail::is_multi_result<U>::value> * = nullptr>
+  constexpr result(U &&u)
+      : base(detail::multi_index_tag<0>{}, std::forward<U>(u)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <
+      typename U = T,
+      detail::enable_if_t<!std::is_convertible<U &&, T>::value> * = nullptr,
+      detail::enable_if_t<std::is_constructible<T, U &&>::value &&
+                          !std::is_same<detail::decay_t<U>, in_place_t>::value &&
+                          !detail::is_in_place_error<detail::decay_t<U>>::value &&
+                          !detail::is_unexpected<U>::value &&
+                          !detail::is_result<U>::value &&
+                          !detail::is_multi_result<U>::value> * = nullptr>
+  constexpr explicit result(U &&u)
+      : base(detail::multi_index_tag<0>{}, std::forward<U>(u)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Converting constructor from a result with fewer (or other) errors:
+  /// `result<U, G>` or `result<U, G1, G2, ...>` where each `G` is one of
+  /// `E1, E2, ...`. The value is converted to `T`; the error is kept as the
+  /// first error of the same type.
+  /// \group ctor_widen
+  /// \synopsis template <typename U, typename... Gs> result(const result<U, Gs...>& rhs);
+  template <typename Other,
+            detail::enable_multi_from_other<result, T, const Other &, E1, E2,
+                                            Es...> * = nullptr,
+            detail::enable_if_t<detail::multi_value_implicit<
+                T, detail::multi_value_arg<const Other &>>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(const Other &rhs)
+      : base(detail::from_result_t{}, rhs),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <typename Other,
+            detail::enable_multi_from_other<result, T, const Other &, E1, E2,
+                                            Es...> * = nullptr,
+            detail::enable_if_t<!detail::multi_value_implicit<
+                T, detail::multi_value_arg<const Other &>>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(const Other &rhs)
+      : base(detail::from_result_t{}, rhs),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group ctor_widen
+  /// \synopsis template <typename U, typename... Gs> result(result<U, Gs...>&& rhs);
+  template <typename Other,
+            detail::enable_if_t<!std::is_lvalue_reference<Other>::value> * =
+                nullptr,
+            detail::enable_multi_from_other<result, T, Other &&, E1, E2,
+                                            Es...> * = nullptr,
+            detail::enable_if_t<detail::multi_value_implicit<
+                T, detail::multi_value_arg<Other &&>>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(Other &&rhs)
+      : base(detail::from_result_t{}, std::move(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <typename Other,
+            detail::enable_if_t<!std::is_lvalue_reference<Other>::value> * =
+                nullptr,
+            detail::enable_multi_from_other<result, T, Other &&, E1, E2,
+                                            Es...> * = nullptr,
+            detail::enable_if_t<!detail::multi_value_implicit<
+                T, detail::multi_value_arg<Other &&>>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(Other &&rhs)
+      : base(detail::from_result_t{}, std::move(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Destroys the stored value or error.
+  ~result() = default;
+
+  /// Copy assignment.
+  ///
+  /// Copies the value or the error from `rhs`, destroying whatever `*this`
+  /// held if the alternative changes.
+  result &operator=(const result &rhs) = default;
+
+  /// Move assignment.
+  ///
+  /// Moves the value or the error from `rhs`, destroying whatever `*this`
+  /// held if the alternative changes.
+  result &operator=(result &&rhs) = default;
+
+  /// Assigns the stored value from `u`, destroying the error if there was
+  /// one.
+  /// \synopsis result &operator=(U&& u);
+  template <typename U = T,
+            detail::enable_if_t<
+                std::is_constructible<T, U &&>::value &&
+                std::is_assignable<detail::fixup_void<T> &, U &&>::value &&
+                !std::is_same<detail::decay_t<U>, result>::value &&
+                !detail::is_unexpected<U>::value &&
+                !detail::is_result<U>::value &&
+                !detail::is_multi_result<U>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(U &&u) {
+    if (has_value())
+      detail::multi_get<0>::get(this->union_) = std::forward<U>(u);
+    else
+      this->template emplace_alternative<0>(std::forward<U>(u));
+    return *this;
+  }
+
+  /// Assigns the stored error from `e`, destroying the value or the other
+  /// error if there was one.
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(const unexpected<G>& e);
+  template <typename G,
+            detail::enable_if_t<unique_error<G>::value &&
+                                std::is_copy_assignable<G>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(const unexpected<G> &e) {
+    assign_error<error_index<G>::value>(e.value());
+    return *this;
+  }
+
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(unexpected<G>&& e);
+  template <typename G,
+            detail::enable_if_t<unique_error<G>::value &&
+                                std::is_move_assignable<G>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(unexpected<G> &&e) {
+    assign_error<error_index<G>::value>(std::move(e.value()));
+    return *this;
+  }
+
+  /// Constructs the value in-place, destroying the current value or error.
+  /// \requires constructing `T` from `args` is `noexcept`, or `T` is nothrow
+  /// move constructible; if the construction throws, `*this` is unchanged
+  /// \group emplace
+  /// \synopsis template <typename... Args>\nT& emplace(Args &&... args);
+  template <typename... Args>
+  TAO_RESULT_CONSTEXPR20 typename refs::ref emplace(Args &&... args) {
+    this->template emplace_alternative<0>(std::forward<Args>(args)...);
+    return **this;
+  }
+
+  /// Constructs the error alternative `I` (or the error of type `G`)
+  /// in-place, destroying the current value or error.
+  /// \requires constructing the error from `args` is `noexcept`, or the
+  /// error is nothrow move constructible; if the construction throws,
+  /// `*this` is unchanged
+  /// \group emplace_error
+  /// \synopsis template <std::size_t I, typename... Args>\nerror_type<I>& emplace_error(Args &&... args);
+  template <std::size_t I, typename... Args>
+  TAO_RESULT_CONSTEXPR20 error_type<I> &emplace_error(Args &&... args) {
+    this->template emplace_alternative<I + 1>(std::forward<Args>(args)...);
+    return error<I>();
+  }
+
+  /// \group emplace_error
+  /// \synopsis template <typename G, typename... Args>\nG& emplace_error(Args &&... args);
+  template <typename G, typename... Args>
+  TAO_RESULT_CONSTEXPR20 G &emplace_error(Args &&... args) {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return emplace_error<error_index<G>::value>(std::forward<Args>(args)...);
+  }
+
+  /// Swaps this result with the other.
+  ///
+  /// If both hold the same alternative they are swapped with `swap`.
+  /// Otherwise the two results are exchanged through a temporary.
+  TAO_RESULT_CONSTEXPR20 void swap(result &rhs) noexcept(
+      alternatives::nothrow_swappable) {
+    if (this->index_ == rhs.index_) {
+      this->swap_same(rhs);
+    } else {
+      result tmp(std::move(rhs));
+      rhs = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+  /// \returns a pointer to the stored value
+  /// \requires a value is stored, and `T` is not `void`
+  /// \group pointer
+  /// \synopsis constexpr const T *operator->() const;
+  template <typename U = T,
+            detail::enable_if_t<!std::is_void<U>::value> * = nullptr>
+  constexpr const U *operator->() const {
+    return std::addressof(detail::multi_get<0>::get(this->union_));
+  }
+
+  /// \group pointer
+  /// \synopsis constexpr T *operator->();
+  template <typename U = T,
+            detail::enable_if_t<!std::is_void<U>::value> * = nullptr>
+  constexpr U *operator->() {
+    return std::addressof(detail::multi_get<0>::get(this->union_));
+  }
+
+  /// \returns the stored value, nothing if `T` is `void`
+  /// \requires a value is stored
+  /// \group deref
+  /// \synopsis constexpr T &operator*();
+  constexpr typename refs::ref operator*() & {
+    return value_ref(is_void{}, storage());
+  }
+
+  /// \group deref
+  /// \synopsis constexpr const T &operator*() const;
+  constexpr typename refs::cref operator*() const & {
+    return value_ref(is_void{}, storage());
+  }
+
+  /// \exclude
+  constexpr typename refs::rref operator*() && {
+    return value_ref(is_void{}, std::move(*this).storage());
+  }
+
+  /// \exclude
+  constexpr typename refs::crref operator*() const && {
+    return value_ref(is_void{}, std::move(*this).storage());
+  }
+
+  /// \returns whether or not the result holds a value
+  /// \group has_value
+  constexpr bool has_value() const noexcept { return this->index_ == 0; }
+
+  /// \group has_value
+  constexpr explicit operator bool() const noexcept { return has_value(); }
+
+  /// \returns which alternative is stored: 0 for the value, `I + 1` for the
+  /// error `I`
+  constexpr std::size_t index() const noexcept { return this->index_; }
+
+  /// \returns whether the result holds the error alternative `I` (or the
+  /// error of type `G`)
+  /// \group has_error
+  /// \synopsis template <std::size_t I> constexpr bool has_error() const noexcept;
+  template <std::size_t I> constexpr bool has_error() const noexcept {
+    static_assert(I < size - 1, "there is no such error");
+    return this->index_ == I + 1;
+  }
+
+  /// \group has_error
+  /// \synopsis template <typename G> constexpr bool has_error() const noexcept;
+  template <typename G> constexpr bool has_error() const noexcept {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return has_error<error_index<G>::value>();
+  }
+
+  /// \returns the stored value if there is one, otherwise throws
+  /// [bad_result_access] carrying a copy of the stored error (or calls the
+  /// failure handler under `TAO_RESULT_NO_EXCEPTIONS`)
+  /// \group value
+  /// \synopsis constexpr T &value();
+  TAO_RESULT_CONSTEXPR20 typename refs::ref value() & {
+    if (!detail::engaged(*this))
+      throw_error(storage());
+    return **this;
+  }
+
+  /// \group value
+  /// \synopsis constexpr const T &value() const;
+  TAO_RESULT_CONSTEXPR20 typename refs::cref value() const & {
+    if (!detail::engaged(*this))
+      throw_error(storage());
+    return **this;
+  }
+
+  /// \exclude
+  TAO_RESULT_CONSTEXPR20 typename refs::rref value() && {
+    if (!detail::engaged(*this))
+      throw_error(std::move(*this).storage());
+    return std::move(**this);
+  }
+
+  /// \returns the error alternative `I` (or the error of type `G`)
+  /// \requires that error is stored
+  /// \group error
+  /// \synopsis template <std::size_t I> constexpr error_type<I> &error();
+  template <std::size_t I> constexpr error_type<I> &error() & {
+    return detail::multi_get<I + 1>::get(this->union_);
+  }
+
+  /// \group error
+  /// \synopsis template <std::size_t I> constexpr const error_type<I> &error() const;
+  template <std::size_t I> constexpr const error_type<I> &error() const & {
+    return detail::multi_get<I + 1>::get(this->union_);
+  }
+
+  /// \exclude
+  template <std::size_t I> constexpr error_type<I> &&error() && {
+    return std::move(detail::multi_get<I + 1>::get(this->union_));
+  }
+
+  /// \group error
+  /// \synopsis template <typename G> constexpr G &error();
+  template <typename G> constexpr G &error() & {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return error<error_index<G>::value>();
+  }
+
+  /// \group error
+  /// \synopsis template <typename G> constexpr const G &error() const;
+  template <typename G> constexpr const G &error() const & {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return error<error_index<G>::value>();
+  }
+
+  /// \exclude
+  template <typename G> constexpr G &&error() && {
+    static_assert(unique_error<G>::value, "G must occur once among the errors");
+    return std::move(*this).template error<error_index<G>::value>();
+  }
+
+  /// \returns the stored value if there is one, otherwise returns `u`
+  /// \group value_or
+  template <typename U, typename V = T,
+            detail::enable_if_t<!std::is_void<V>::value> * = nullptr>
+  constexpr V value_or(U &&u) const & {
+    static_assert(std::is_copy_constructible<V>::value &&
+                      std::is_convertible<U &&, V>::value,
+                  "T must be copy constructible and convertible to from U&&");
+    return has_value() ? **this : static_cast<V>(std::forward<U>(u));
+  }
+
+  /// \group value_or
+  template <typename U, typename V = T,
+            detail::enable_if_t<!std::is_void<V>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 V value_or(U &&u) && {
+    static_assert(std::is_move_constructible<V>::value &&
+                      std::is_convertible<U &&, V>::value,
+                  "T must be move constructible and convertible to from U&&");
+    return has_value() ? std::move(**this) : static_cast<V>(std::forward<U>(u));
+  }
+
+private:
+  template <typename S>
+  static constexpr decltype(auto) value_ref(std::false_type, S &&s) noexcept {
+    return detail::multi_get<0>::get(std::forward<S>(s).union_);
+  }
+
+  template <typename S>
+  static constexpr void value_ref(std::true_type, S &&) noexcept {}
+
+  template <std::size_t I, typename G>
+  TAO_RESULT_CONSTEXPR20 void assign_error(G &&g) {
+    if (this->index_ == I + 1)
+      detail::multi_get<I + 1>::get(this->union_) = std::forward<G>(g);
+    else
+      this->template emplace_alternative<I + 1>(std::forward<G>(g));
+  }
+
+  template <typename S, typename F,
+            typename U = detail::multi_apply_result<0, is_void::value, F, S>>
+  static constexpr result<U, E1, E2, Es...> map_impl(S &&s, F &&f) {
+    return map_value<result<U, E1, E2, Es...>>(std::is_void<U>{},
+                                               std::forward<S>(s),
+                                               std::forward<F>(f));
+  }
+
+  template <typename Ret, typename S, typename F>
+  static constexpr Ret map_value(std::false_type, S &&s, F &&f) {
+    if (s.index_ == 0)
+      return Ret(in_place, detail::multi_apply<is_void::value>::template call<0>(
+                               std::forward<F>(f), std::forward<S>(s)));
+    return rebuild_error<Ret>(std::forward<S>(s), no_map{});
+  }
+
+  template <typename Ret, typename S, typename F>
+  static TAO_RESULT_CONSTEXPR20 Ret map_value(std::true_type, S &&s, F &&f) {
+    if (s.index_ == 0) {
+      detail::multi_apply<is_void::value>::template call<0>(
+          std::forward<F>(f), std::forward<S>(s));
+      return Ret(in_place);
+    }
+    return rebuild_error<Ret>(std::forward<S>(s), no_map{});
+  }
+
+  template <std::size_t I, typename S, typename F>
+  using mapped_error = detail::fixup_void<decltype(detail::invoke(
+      std::declval<F>(),
+      detail::multi_get<I + 1>::get(std::declval<S>().union_)))>;
+
+  template <std::size_t I, typename S, typename F, std::size_t... Js>
+  static auto map_error_result(std::index_sequence<Js...>)
+      -> result<T, detail::conditional_t<Js == I, mapped_error<I, S, F>,
+                                         error_type<Js>>...>;
+
+  template <std::size_t I, typename S, typename F>
+  static constexpr auto map_error_impl(S &&s, F &&f) {
+    static_assert(I < size - 1, "there is no such error");
+    using ret_t = decltype(map_error_result<I, S, F>(
+        std::make_index_sequence<size - 1>{}));
+    if (s.index_ == 0)
+      return map_error_value<ret_t>(is_void{}, std::forward<S>(s));
+    return rebuild_error<ret_t, I>(std::forward<S>(s), std::forward<F>(f));
+  }
+
+  template <typename Ret, typename S>
+  static constexpr Ret map_error_value(std::false_type, S &&s) {
+    return Ret(in_place, detail::multi_get<0>::get(std::forward<S>(s).union_));
+  }
+
+  template <typename Ret, typename S>
+  static constexpr Ret map_error_value(std::true_type, S &&) {
+    return Ret(in_place);
+  }
+};
+
+/// \group multi_result_relop
+/// \brief Compares two multi-error results of the same type
+/// \details They are equal if they hold the same alternative and it
+/// compares equal.
+template <typename T, typename E1, typename E2, typename... Es>
+inline constexpr bool operator==(const result<T, E1, E2, Es...> &lhs,
+                                 const result<T, E1, E2, Es...> &rhs) {
+  return lhs.index() == rhs.index() &&
+         detail::multi_switch<3 + sizeof...(Es)>::template call<bool>(
+             lhs.index(),
+             detail::multi_equal<result<T, E1, E2, Es...>>{lhs, rhs});
+}
+/// \group multi_result_relop
+template <typename T, typename E1, typename E2, typename... Es>
+inline constexpr bool operator!=(const result<T, E1, E2, Es...> &lhs,
+                                 const result<T, E1, E2, Es...> &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename T, typename E1, typename E2, typename... Es,
+          detail::enable_if_t<
+              detail::multi_alternatives<detail::fixup_void<T>, E1, E2,
+                                         Es...>::swappable> * = nullptr>
+TAO_RESULT_CONSTEXPR20 void
+swap(result<T, E1, E2, Es...> &lhs,
+     result<T, E1, E2, Es...> &rhs) noexcept(noexcept(lhs.swap(rhs))) {
+  lhs.swap(rhs);
+}
+
+template <typename T, typename E1, typename E2, typename... Es>
+struct is_trivially_relocatable<result<T, E1, E2, Es...>>
+    : detail::conjunction<is_trivially_relocatable<detail::fixup_void<T>>,
+                          is_trivially_relocatable<E1>,
+                          is_trivially_relocatable<E2>,
+                          is_trivially_relocatable<Es>...> {};
+
+} // namespace tao
+
+#endif // TAO_RESULT_MULTI_ERROR_HPP_
@@ -0,0 +1,290 @@
+//! \file tao/result/optional_vector.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_OPTIONAL_VECTOR_HPP_
+#define TAO_RESULT_OPTIONAL_VECTOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <tao/result/result.hpp>
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+inline std::size_t popcount64(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_popcountll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  return static_cast<std::size_t>(__popcnt64(x));
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<std::size_t>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit. `x` must not be zero.
+inline std::size_t countr_zero64(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<std::size_t>(index);
+#else
+  std::size_t n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+} // namespace detail
+
+/// A structure-of-arrays container of optional values.
+///
+/// Values live in one dense `T` array and presence is tracked in a packed
+/// validity bitmap, one bit per element (Arrow-style), instead of one
+/// `has_value_` flag plus padding per element. Empty lanes still hold a
+/// value-initialized `T`, so `T` must be default constructible.
+///
+/// Element access yields `optional<T&>`, a zero-copy view into the dense
+/// array.
+///
+/// *Examples*:
+/// ```
+/// tao::optional_vector<int> v {1, tao::nullopt, 3};
+/// v.count_engaged(); // 2
+/// auto doubled = v.map([](int x) { return x * 2; }); // {2, nullopt, 6}
+/// ```
+template <typename T> class optional_vector {
+  static_assert(!std::is_reference<T>::value, "T must not be a reference");
+  static_assert(!std::is_same<detail::remove_const_t<T>, bool>::value,
+                "optional_vector<bool> is not supported, std::vector<bool> "
+                "cannot hand out references");
+  static_assert(std::is_default_constructible<T>::value,
+                "T must be default constructible");
+
+  using word_type = std::uint64_t;
+  static constexpr std::size_t word_bits = 64;
+
+public:
+  using value_type = optional<T>;
+  using size_type = std::size_t;
+  using reference = optional<T &>;
+  using const_reference = optional<const T &>;
+
+  /// Constructs an empty container.
+  optional_vector() = default;
+
+  /// Constructs `n` empty lanes.
+  explicit optional_vector(size_type n)
+      : values_(n), validity_(words_for(n), 0), size_(n) {}
+
+  /// Constructs the container from a list of optionals.
+  optional_vector(std::initializer_list<optional<T>> il) {
+    reserve(il.size());
+    for (auto const &o : il) {
+      push_back(o);
+    }
+  }
+
+  /// \returns the number of lanes, engaged or not
+  size_type size() const noexcept { return size_; }
+
+  /// \returns whether the container has no lanes
+  bool empty() const noexcept { return size_ == 0; }
+
+  /// Reserves storage for `n` lanes.
+  void reserve(size_type n) {
+    values_.reserve(n);
+    validity_.reserve(words_for(n));
+  }
+
+  /// Removes all lanes.
+  void clear() noexcept {
+    values_.clear();
+    validity_.clear();
+    size_ = 0;
+  }
+
+  /// Appends a lane holding a copy of the value of `o`, or an empty lane.
+  /// \group push_back
+  void push_back(const optional<T> &o) {
+    if (o.has_value()) {
+      values_.push_back(*o);
+    } else {
+      values_.emplace_back();
+    }
+    push_bit(o.has_value());
+  }
+
+  /// \group push_back
+  void push_back(optional<T> &&o) {
+    if (o.has_value()) {
+      values_.push_back(std::move(*o));
+    } else {
+      values_.emplace_back();
+    }
+    push_bit(o.has_value());
+  }
+
+  /// \group push_back
+  void push_back(nullopt_t) {
+    values_.emplace_back();
+    push_bit(false);
+  }
+
+  /// Appends an engaged lane whose value is constructed from `args`.
+  template <typename... Args> T &emplace_back(Args &&... args) {
+    values_.emplace_back(std::forward<Args>(args)...);
+    push_bit(true);
+    return values_.back();
+  }
+
+  /// \returns whether lane `i` is engaged
+  bool has_value(size_type i) const noexcept {
+    return (validity_[i / word_bits] >> (i % word_bits)) & 1;
+  }
+
+  /// \returns a reference to the value of lane `i` if it is engaged,
+  /// otherwise an empty optional
+  /// \group subscript
+  reference operator[](size_type i) noexcept {
+    return has_value(i) ? reference(values_[i]) : reference(nullopt);
+  }
+
+  /// \group subscript
+  const_reference operator[](size_type i) const noexcept {
+    return has_value(i) ? const_reference(values_[i]) : const_reference(nullopt);
+  }
+
+  /// Engages lane `i` with `u`, replacing the previous value if there was one.
+  template <typename U> void set(size_type i, U &&u) {
+    values_[i] = std::forward<U>(u);
+    validity_[i / word_bits] |= word_type(1) << (i % word_bits);
+  }
+
+  /// Makes lane `i` empty. The slot keeps its value until it is overwritten.
+  void reset(size_type i) noexcept {
+    validity_[i / word_bits] &= ~(word_type(1) << (i % word_bits));
+  }
+
+  /// \returns the number of engaged lanes, one popcount per 64 lanes
+  size_type count_engaged() const noexcept {
+    size_type n = 0;
+    for (word_type w : validity_) {
+      n += detail::popcount64(w);
+    }
+    return n;
+  }
+
+  /// Calls `f(i, value)` for every engaged lane, in order. Empty lanes are
+  /// skipped a whole word at a time.
+  /// \group for_each_engaged
+  template <typename F> void for_each_engaged(F &&f) {
+    for_each_index([&](size_type i) { f(i, values_[i]); });
+  }
+
+  /// \group for_each_engaged
+  template <typename F> void for_each_engaged(F &&f) const {
+    for_each_index([&](size_type i) { f(i, values_[i]); });
+  }
+
+  /// \returns a container with the same validity bitmap where every engaged
+  /// lane holds `f(value)`. `f` is never called for empty lanes.
+  template <typename F,
+            typename U = detail::decay_t<detail::invoke_result_t<F, const T &>>>
+  optional_vector<U> map(F &&f) const {
+    optional_vector<U> ret;
+    ret.values_.resize(size_);
+    ret.validity_ = validity_;
+    ret.size_ = size_;
+    for_each_index([&](size_type i) {
+      ret.values_[i] = detail::invoke(f, values_[i]);
+    });
+    return ret;
+  }
+
+  /// \returns a copy of the container where engaged lanes for which `pred`
+  /// returns false become empty. Lane positions are preserved.
+  template <typename P> optional_vector filter(P &&pred) const {
+    optional_vector ret(*this);
+    for_each_index([&](size_type i) {
+      if (!detail::invoke(pred, values_[i])) {
+        ret.reset(i);
+      }
+    });
+    return ret;
+  }
+
+  /// \returns a pointer to the dense value array, `size()` elements long.
+  /// Slots of empty lanes hold unspecified values.
+  /// \group data
+  T *values_data() noexcept { return values_.data(); }
+
+  /// \group data
+  const T *values_data() const noexcept { return values_.data(); }
+
+  /// \returns a pointer to the validity bitmap, `(size() + 63) / 64` words
+  /// long. Bit `i % 64` of word `i / 64` is set when lane `i` is engaged;
+  /// bits past `size()` are zero.
+  const std::uint64_t *validity_data() const noexcept {
+    return validity_.data();
+  }
+
+private:
+  template <typename U> friend class optional_vector;
+
+  static size_type words_for(size_type n) noexcept {
+    return (n + word_bits - 1) / word_bits;
+  }
+
+  void push_bit(bool engaged) {
+    if (size_ % word_bits == 0) {
+      validity_.push_back(0);
+    }
+    if (engaged) {
+      validity_.back() |= word_type(1) << (size_ % word_bits);
+    }
+    ++size_;
+  }
+
+  template <typename F> void for_each_index(F &&f) const {
+    for (size_type w = 0; w < validity_.size(); ++w) {
+      word_type bits = validity_[w];
+      while (bits != 0) {
+        f(w * word_bits + detail::countr_zero64(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  std::vector<T> values_;
+  std::vector<word_type> validity_;
+  size_type size_ = 0;
+};
+
+} // namespace tao
+
+#endif // TAO_RESULT_OPTIONAL_VECTOR_HPP_
@@ -0,0 +1,344 @@
+//! \file tao/result/pipe.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_PIPE_HPP_
+#define TAO_RESULT_PIPE_HPP_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// Lazy, fused chains over an optional:
+//
+//   tao::optional<page> p = req | tao::map(parse)       // request -> query
+//                               | tao::and_then(lookup) // query -> optional<row>
+//                               | tao::map(render)      // row -> page
+//                               | tao::or_else(not_found);
+//
+// `|` only records the stages; nothing runs until the pipeline is converted
+// to its result optional (or `run()` is called). The stages are then applied
+// in one pass: each one tests engagement once and hands the value on by
+// reference, so no intermediate optional is ever built. The last stage
+// constructs its value directly in the returned optional, which C++17 copy
+// elision places in the destination. The members map, and_then and or_else
+// remain the eager equivalent, one optional per call.
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+// The stages, as built by tao::map, tao::and_then and tao::or_else. For an
+// input value of type V (a reference), next_value is what the stage hands to
+// the next one and result_for is the optional it produces when it comes last;
+// Prev is the optional produced by the stages before it.
+template <typename F> struct pipe_map {
+  template <typename V>
+  using next_value = fixup_void<invoke_result_t<F, V>> &&;
+  template <typename Prev, typename V>
+  using result_for = optional<fixup_void<invoke_result_t<F, V>>>;
+
+  F f;
+};
+
+template <typename F> struct pipe_and_then {
+  template <typename V>
+  using next_value = decltype(*std::declval<invoke_result_t<F, V>>());
+  template <typename Prev, typename V>
+  using result_for = decay_t<invoke_result_t<F, V>>;
+
+  F f;
+};
+
+template <typename F> struct pipe_or_else {
+  template <typename V> using next_value = V;
+  template <typename Prev, typename V> using result_for = Prev;
+
+  F f;
+};
+
+template <typename S> struct is_pipe_stage : std::false_type {};
+template <typename F> struct is_pipe_stage<pipe_map<F>> : std::true_type {};
+template <typename F> struct is_pipe_stage<pipe_and_then<F>> : std::true_type {};
+template <typename F> struct is_pipe_stage<pipe_or_else<F>> : std::true_type {};
+
+// The optional produced by running the stages S... on a value of type V
+template <typename Prev, typename V, typename... S> struct pipe_result;
+template <typename Prev, typename V, typename S>
+struct pipe_result<Prev, V, S> {
+  using type = typename S::template result_for<Prev, V>;
+};
+template <typename Prev, typename V, typename S, typename S2, typename... Ss>
+struct pipe_result<Prev, V, S, S2, Ss...>
+    : pipe_result<typename S::template result_for<Prev, V>,
+                  typename S::template next_value<V>, S2, Ss...> {};
+
+// The end of a chain builds the result. value() receives a finished value,
+// invoke_value() a function whose result becomes the value, so that it can be
+// constructed in place, and invoke_optional() a function returning an
+// optional, which is returned as is.
+template <typename Result> struct pipe_sink {
+  using result_type = Result;
+
+  template <typename V> constexpr Result value(V &&v) {
+    return make(std::is_reference<typename Result::value_type>{},
+                std::forward<V>(v));
+  }
+
+  template <typename F, typename... A>
+  constexpr Result invoke_value(F &&f, A &&... a) {
+    return invoke_make(std::is_reference<typename Result::value_type>{},
+                       std::forward<F>(f), std::forward<A>(a)...);
+  }
+
+  template <typename F, typename... A>
+  constexpr Result invoke_optional(F &&f, A &&... a) {
+    return detail::invoke(std::forward<F>(f), std::forward<A>(a)...);
+  }
+
+  constexpr Result none() { return Result(nullopt); }
+
+private:
+  template <typename V> constexpr Result make(std::false_type, V &&v) {
+    return Result(in_place, std::forward<V>(v));
+  }
+
+  // optional<T&> binds to the reference
+  template <typename V> constexpr Result make(std::true_type, V &&v) {
+    return Result(std::forward<V>(v));
+  }
+
+  template <typename F, typename... A>
+  constexpr Result invoke_make(std::false_type, F &&f, A &&... a) {
+    return Result(in_place_invoke_t{}, std::forward<F>(f),
+                  std::forward<A>(a)...);
+  }
+
+  template <typename F, typename... A>
+  constexpr Result invoke_make(std::true_type, F &&f, A &&... a) {
+    return Result(detail::invoke(std::forward<F>(f), std::forward<A>(a)...));
+  }
+};
+
+// A stage followed by the rest of the chain. The stage's function is only
+// referenced; it lives in the pipeline.
+template <typename S, typename Next> struct pipe_node;
+
+// What a node does with values produced by the stage before it, when that
+// stage hands over a function rather than a value
+template <typename Node, typename Result> struct pipe_node_base {
+  template <typename F, typename... A>
+  constexpr Result invoke_value(F &&f, A &&... a) {
+    return static_cast<Node &>(*this).value(
+        detail::invoke(std::forward<F>(f), std::forward<A>(a)...));
+  }
+
+  template <typename F, typename... A>
+  constexpr Result invoke_optional(F &&f, A &&... a) {
+    auto &&o = detail::invoke(std::forward<F>(f), std::forward<A>(a)...);
+    if (o.has_value())
+      return static_cast<Node &>(*this).value(
+          *std::forward<decltype(o)>(o));
+    return static_cast<Node &>(*this).none();
+  }
+};
+
+template <typename F, typename Next>
+struct pipe_node<pipe_map<F>, Next>
+    : pipe_node_base<pipe_node<pipe_map<F>, Next>,
+                     typename Next::result_type> {
+  using result_type = typename Next::result_type;
+
+  F &f;
+  Next next;
+
+  constexpr pipe_node(F &fn, Next &&rest) : f(fn), next(std::move(rest)) {}
+
+  template <typename V> constexpr result_type value(V &&v) {
+    return map_value(returns_void<F, V>{}, std::forward<V>(v));
+  }
+
+  constexpr result_type none() { return next.none(); }
+
+private:
+  template <typename V>
+  constexpr result_type map_value(std::false_type, V &&v) {
+    return next.invoke_value(std::move(f), std::forward<V>(v));
+  }
+
+  template <typename V>
+  constexpr result_type map_value(std::true_type, V &&v) {
+    detail::invoke(std::move(f), std::forward<V>(v));
+    return next.value(monostate{});
+  }
+};
+
+template <typename F, typename Next>
+struct pipe_node<pipe_and_then<F>, Next>
+    : pipe_node_base<pipe_node<pipe_and_then<F>, Next>,
+                     typename Next::result_type> {
+  using result_type = typename Next::result_type;
+
+  F &f;
+  Next next;
+
+  constexpr pipe_node(F &fn, Next &&rest) : f(fn), next(std::move(rest)) {}
+
+  template <typename V> constexpr result_type value(V &&v) {
+    static_assert(is_optional<invoke_result_t<F, V>>::value,
+                  "F must return an optional");
+    return next.invoke_optional(std::move(f), std::forward<V>(v));
+  }
+
+  constexpr result_type none() { return next.none(); }
+};
+
+template <typename F, typename Next>
+struct pipe_node<pipe_or_else<F>, Next>
+    : pipe_node_base<pipe_node<pipe_or_else<F>, Next>,
+                     typename Next::result_type> {
+  using result_type = typename Next::result_type;
+
+  F &f;
+  Next next;
+
+  constexpr pipe_node(F &fn, Next &&rest) : f(fn), next(std::move(rest)) {}
+
+  template <typename V> constexpr result_type value(V &&v) {
+    return next.value(std::forward<V>(v));
+  }
+
+  constexpr result_type none() { return or_else_none(returns_void<F>{}); }
+
+private:
+  constexpr result_type or_else_none(std::false_type) {
+    static_assert(is_optional<invoke_result_t<F>>::value,
+                  "F must return an optional or void");
+    return next.invoke_optional(std::move(f));
+  }
+
+  constexpr result_type or_else_none(std::true_type) {
+    detail::invoke(std::move(f));
+    return next.none();
+  }
+};
+
+// Builds the chain of nodes for the stages I... of the tuple
+template <typename Result, typename Tuple>
+constexpr pipe_sink<Result> make_pipe_chain(Tuple &, std::index_sequence<>) {
+  return {};
+}
+
+template <typename Result, typename Tuple, std::size_t I, std::size_t... Is>
+constexpr auto make_pipe_chain(Tuple &t, std::index_sequence<I, Is...>)
+    -> pipe_node<typename std::tuple_element<I, Tuple>::type,
+                 decltype(make_pipe_chain<Result>(t, std::index_sequence<Is...>{}))> {
+  return {std::get<I>(t).f, make_pipe_chain<Result>(t, std::index_sequence<Is...>{})};
+}
+
+} // namespace detail
+
+/// \brief A chain of stages over an optional, built with `|` and run when it
+/// is converted to its result.
+///
+/// \details `Source` is an lvalue reference to the source optional, or the
+/// optional itself when the pipeline was built from an rvalue, which is
+/// moved in. The pipeline is single use: each stage's function is invoked at
+/// most once, as an rvalue.
+template <typename Source, typename... Stages> class pipeline {
+  using source_type = detail::decay_t<Source>;
+  using source_value = decltype(*std::declval<Source &&>());
+
+public:
+  /// The optional the chain produces, the type the eager calls would return
+  using result_type =
+      typename detail::pipe_result<source_type, source_value,
+                                   Stages...>::type;
+
+  /// \exclude
+  template <typename S, typename... Ss>
+  constexpr pipeline(S &&source, Ss &&... stages)
+      : source_(std::forward<S>(source)),
+        stages_(std::forward<Ss>(stages)...) {}
+
+  /// Runs the stages and returns the final optional.
+  constexpr result_type run() && {
+    auto chain = detail::make_pipe_chain<result_type>(
+        stages_, std::index_sequence_for<Stages...>{});
+    if (source_.has_value())
+      return chain.value(*std::forward<Source>(source_));
+    return chain.none();
+  }
+
+  /// \group run
+  constexpr operator result_type() && { return std::move(*this).run(); }
+
+  /// Appends a stage.
+  template <typename S,
+            detail::enable_if_t<detail::is_pipe_stage<detail::decay_t<S>>::value>
+                * = nullptr>
+  friend constexpr pipeline<Source, Stages..., detail::decay_t<S>>
+  operator|(pipeline &&p, S &&s) {
+    return p.append(std::forward<S>(s),
+                    std::index_sequence_for<Stages...>{});
+  }
+
+private:
+  template <typename S, std::size_t... I>
+  constexpr pipeline<Source, Stages..., detail::decay_t<S>>
+  append(S &&s, std::index_sequence<I...>) {
+    return {std::forward<Source>(source_), std::move(std::get<I>(stages_))...,
+            std::forward<S>(s)};
+  }
+
+  Source source_;
+  std::tuple<Stages...> stages_;
+};
+
+/// \brief Starts a pipeline on an optional.
+/// \details An lvalue optional is referenced by the pipeline, an rvalue one
+/// is moved into it.
+template <typename Opt, typename S,
+          detail::enable_if_t<detail::is_optional<Opt>::value &&
+                              detail::is_pipe_stage<detail::decay_t<S>>::value>
+              * = nullptr>
+constexpr pipeline<
+    detail::conditional_t<std::is_lvalue_reference<Opt>::value, Opt,
+                          detail::decay_t<Opt>>,
+    detail::decay_t<S>>
+operator|(Opt &&o, S &&s) {
+  return {std::forward<Opt>(o), std::forward<S>(s)};
+}
+
+/// \brief A pipeline stage applying `f` to the value, as `optional::map`.
+template <typename F> constexpr detail::pipe_map<detail::decay_t<F>> map(F &&f) {
+  return {std::forward<F>(f)};
+}
+
+/// \brief A pipeline stage continuing with the optional returned by `f`, as
+/// `optional::and_then`.
+template <typename F>
+constexpr detail::pipe_and_then<detail::decay_t<F>> and_then(F &&f) {
+  return {std::forward<F>(f)};
+}
+
+/// \brief A pipeline stage calling `f` when there is no value, as
+/// `optional::or_else`: `f` returns the optional to continue with, or
+/// `void` to stay empty.
+template <typename F>
+constexpr detail::pipe_or_else<detail::decay_t<F>> or_else(F &&f) {
+  return {std::forward<F>(f)};
+}
+
+} // namespace tao
+
+#endif // TAO_RESULT_PIPE_HPP_
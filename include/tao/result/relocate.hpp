@@ -0,0 +1,196 @@
+//! \file tao/result/relocate.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_RELOCATE_HPP_
+#define TAO_RESULT_RELOCATE_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// Relocation moves an object to new storage and ends the lifetime of the
+// source in one step, the way a container moves its elements when it grows:
+//
+//   T *grow(T *first, T *last, std::size_t cap) {
+//     T *buf = static_cast<T *>(::operator new(cap * sizeof(T)));
+//     tao::uninitialized_relocate(first, last, buf);
+//     ::operator delete(first);
+//     return buf;
+//   }
+//
+// For a trivially relocatable T (see is_trivially_relocatable in result.hpp)
+// a contiguous range is relocated with a single memmove, so for instance a
+// buffer of optional<std::unique_ptr<U>> or result<handle, std::errc> moves
+// without running a move constructor and a destructor per element. Other
+// types are move constructed and destroyed one by one.
+
+namespace tao {
+
+/// \exclude
+namespace detail {
+
+template <typename T> void *relocate_voidify(T *p) noexcept {
+  return const_cast<void *>(static_cast<const volatile void *>(p));
+}
+
+template <typename T> void relocate_destroy(T *p) noexcept { p->~T(); }
+
+template <typename T>
+T *relocate_at_impl(T *source, T *dest, std::true_type) noexcept {
+  std::memmove(relocate_voidify(dest), relocate_voidify(source), sizeof(T));
+  return dest;
+}
+
+template <typename T>
+T *relocate_at_impl(T *source, T *dest, std::false_type) noexcept(
+    std::is_nothrow_move_constructible<T>::value) {
+  ::new (relocate_voidify(dest)) T(std::move(*source));
+  source->~T();
+  return dest;
+}
+
+// A contiguous range of the same trivially relocatable type on both sides
+template <typename It, typename Fwd,
+          typename T = typename std::iterator_traits<Fwd>::value_type>
+using relocate_by_memmove = std::integral_constant<
+    bool, std::is_pointer<It>::value && std::is_pointer<Fwd>::value &&
+              std::is_same<remove_const_t<typename std::iterator_traits<
+                               It>::value_type>,
+                           T>::value &&
+              is_trivially_relocatable<T>::value>;
+
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate_bytes(It first, It last, Fwd d_first) noexcept {
+  const auto n = static_cast<std::size_t>(last - first);
+  if (n != 0) {
+    std::memmove(relocate_voidify(d_first), relocate_voidify(first),
+                 n * sizeof(*d_first));
+  }
+  return d_first + n;
+}
+
+// Each element is moved and its source destroyed right away
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate_each(It first, It last, Fwd d_first,
+                                std::true_type) noexcept {
+  using T = typename std::iterator_traits<Fwd>::value_type;
+  for (; first != last; ++first, ++d_first) {
+    ::new (relocate_voidify(std::addressof(*d_first))) T(std::move(*first));
+    detail::relocate_destroy(std::addressof(*first));
+  }
+  return d_first;
+}
+
+// The move constructor may throw: everything is moved before any source is
+// destroyed, so that on an exception the moved-to objects are destroyed and
+// the source range is still alive
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate_each(It first, It last, Fwd d_first,
+                                std::false_type) {
+  using T = typename std::iterator_traits<Fwd>::value_type;
+  Fwd cur = d_first;
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+  try {
+#endif
+    for (It it = first; it != last; ++it, ++cur) {
+      ::new (relocate_voidify(std::addressof(*cur))) T(std::move(*it));
+    }
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+  } catch (...) {
+    for (; d_first != cur; ++d_first) {
+      detail::relocate_destroy(std::addressof(*d_first));
+    }
+    throw;
+  }
+#endif
+  for (; first != last; ++first) {
+    detail::relocate_destroy(std::addressof(*first));
+  }
+  return cur;
+}
+
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate_impl(It first, It last, Fwd d_first,
+                                std::true_type) noexcept {
+  return uninitialized_relocate_bytes(first, last, d_first);
+}
+
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate_impl(It first, It last, Fwd d_first,
+                                std::false_type) {
+  using T = typename std::iterator_traits<Fwd>::value_type;
+  return uninitialized_relocate_each(
+      first, last, d_first,
+      std::integral_constant<bool,
+                             std::is_nothrow_move_constructible<T>::value>{});
+}
+
+} // namespace detail
+
+/// \brief Relocates `*source` into the uninitialized storage at `dest`.
+/// \details Copies the bytes when `T` is trivially relocatable, otherwise
+/// move constructs `*dest` and destroys `*source`. Either way `*source` is
+/// no longer alive afterwards and must not be destroyed again.
+/// \returns `dest`
+template <typename T>
+T *relocate_at(T *source, T *dest) noexcept(
+    is_trivially_relocatable<T>::value ||
+    std::is_nothrow_move_constructible<T>::value) {
+  static_assert(std::is_move_constructible<T>::value ||
+                    is_trivially_relocatable<T>::value,
+                "T must be move constructible or trivially relocatable");
+  return detail::relocate_at_impl(
+      source, dest,
+      std::integral_constant<bool, is_trivially_relocatable<T>::value>{});
+}
+
+/// \brief Moves `*source` out into the return value and destroys it.
+/// \details `*source` is no longer alive afterwards and must not be
+/// destroyed again.
+template <typename T>
+T relocate(T *source) noexcept(std::is_nothrow_move_constructible<T>::value) {
+  static_assert(std::is_move_constructible<T>::value,
+                "T must be move constructible");
+  T value(std::move(*source));
+  source->~T();
+  return value;
+}
+
+/// \brief Relocates `[first, last)` into the uninitialized storage starting
+/// at `d_first`.
+/// \details Pointers to a trivially relocatable type are relocated with one
+/// `memmove`. Otherwise each element is move constructed and destroyed; if
+/// the move constructor can throw, every element is moved before the first
+/// source is destroyed, and an exception leaves `[first, last)` intact with
+/// nothing constructed at `d_first`. The ranges must not overlap.
+/// \returns the end of the relocated range
+template <typename It, typename Fwd>
+Fwd uninitialized_relocate(It first, It last, Fwd d_first) {
+  return detail::uninitialized_relocate_impl(
+      first, last, d_first, detail::relocate_by_memmove<It, Fwd>{});
+}
+
+/// \brief Relocates the `n` elements starting at `first` into the
+/// uninitialized storage starting at `d_first`, as `uninitialized_relocate`.
+/// \returns the pair of the ends of the source and of the relocated range
+template <typename It, typename Size, typename Fwd>
+std::pair<It, Fwd> uninitialized_relocate_n(It first, Size n, Fwd d_first) {
+  It last = std::next(first, static_cast<std::ptrdiff_t>(n));
+  return {last, uninitialized_relocate(first, last, d_first)};
+}
+
+} // namespace tao
+
+#endif // TAO_RESULT_RELOCATE_HPP_
@@ -10,18 +10,424 @@
 #ifndef TAO_RESULT_RESULT_HPP_
 #define TAO_RESULT_RESULT_HPP_
 
-#define TAO_OPTIONAL_VERSION_MAJOR 0
-#define TAO_OPTIONAL_VERSION_MINOR 2
-
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <new>
 #include <type_traits>
 #include <utility>
 
+#define TAO_OPTIONAL_VERSION_MAJOR 0
+#define TAO_OPTIONAL_VERSION_MINOR 2
+
+#if (defined(_MSC_VER) && _MSC_VER == 1900)
+#define TAO_OPTIONAL_MSVC2015
+#endif
+
+#if (defined(__GNUC__) && __GNUC__ == 4 && __GNUC_MINOR__ <= 9 &&              \
+     !defined(__clang__))
+#define TAO_OPTIONAL_GCC49
+#endif
+
+#if (defined(__GNUC__) && __GNUC__ == 5 && __GNUC_MINOR__ <= 4 &&              \
+     !defined(__clang__))
+#define TAO_OPTIONAL_GCC54
+#endif
+
+#if (defined(__GNUC__) && __GNUC__ == 5 && __GNUC_MINOR__ <= 5 &&              \
+     !defined(__clang__))
+#define TAO_OPTIONAL_GCC55
+#endif
+
+#if (defined(__GNUC__) && __GNUC__ == 4 && __GNUC_MINOR__ <= 9 &&              \
+     !defined(__clang__))
+// GCC < 5 doesn't support overloading on const&& for member functions
+#define TAO_OPTIONAL_NO_CONSTRR
+
+// GCC < 5 doesn't support some standard C++11 type traits
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T)                                     \
+  std::has_trivial_copy_constructor<T>::value
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(T) std::has_trivial_copy_assign<T>::value
+
+// This one will be different for GCC 5.7 if it's ever supported
+#define TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(T) std::is_trivially_destructible<T>::value
+
+// GCC 5 < v < 8 has a bug in is_trivially_copy_constructible which breaks std::vector
+// for non-copyable types
+#elif (defined(__GNUC__) && __GNUC__ < 8 && !defined(__clang__))
+namespace tao { namespace detail {
+
+template <typename T>
+struct is_trivially_copy_constructible : std::is_trivially_copy_constructible<T> {};
+
+#ifdef _GLIBCXX_VECTOR
+template <typename T, typename A>
+struct is_trivially_copy_constructible<std::vector<T, A>> : std::is_trivially_copy_constructible<T> {};
+#endif
+}} //namespace tao::detail
+
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) tao::detail::is_trivially_copy_constructible<T>::value
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(T) std::is_trivially_copy_assignable<T>::value
+#define TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(T) std::is_trivially_destructible<T>::value
+#else
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) std::is_trivially_copy_constructible<T>::value
+#define TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(T) std::is_trivially_copy_assignable<T>::value
+#define TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(T) std::is_trivially_destructible<T>::value
+#endif
+
+#if __cplusplus > 201103L
+#define TAO_OPTIONAL_CXX14
+#endif
+
+// C++20 path: the converting constructors and assignments of optional are
+// constrained with concepts instead of enable_if towers, and the implicit and
+// explicit overloads collapse into one explicit(bool) declaration. Define
+// TAO_RESULT_NO_CONCEPTS to force the C++14 path.
+#if !defined(TAO_RESULT_NO_CONCEPTS) && defined(__cpp_concepts) &&             \
+    __cpp_concepts >= 201907L && defined(__cpp_conditional_explicit) &&        \
+    __cpp_conditional_explicit >= 201806L
+#define TAO_RESULT_CONCEPTS
+#endif
+
+// Conversions from and to std::optional (C++17) and std::expected (C++23),
+// see also tao/result/std_view.hpp. Define TAO_RESULT_NO_STD_INTEROP to keep
+// <optional> and <expected> out of this header.
+#if !defined(TAO_RESULT_NO_STD_INTEROP) && __cplusplus >= 201703L
+#if __has_include(<optional>)
+#include <optional>
+#define TAO_RESULT_HAS_STD_OPTIONAL
+#endif
+#if __cplusplus > 202002L && __has_include(<expected>)
+#include <expected>
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202202L
+#define TAO_RESULT_HAS_STD_EXPECTED
+#endif
+#endif
+#endif
+
+// Namespace-scope constants are inline variables where the language has them,
+// so every translation unit (and the tao.result module) shares one entity
+#if defined(__cpp_inline_variables) && __cpp_inline_variables >= 201606L
+#define TAO_RESULT_INLINE_VAR inline
+#else
+#define TAO_RESULT_INLINE_VAR static
+#endif
+
+// Members that construct or destroy the stored object in place are constexpr
+// where the language allows it (std::construct_at and constexpr destructors,
+// C++20), so optionals and results of non-trivial types can be built, changed
+// and destroyed during constant evaluation.
+#if __cplusplus > 201703L
+#include <memory>
+#endif
+#if defined(__cpp_constexpr_dynamic_alloc) &&                                  \
+    __cpp_constexpr_dynamic_alloc >= 201907L &&                                \
+    defined(__cpp_lib_constexpr_dynamic_alloc) &&                              \
+    __cpp_lib_constexpr_dynamic_alloc >= 201907L
+#define TAO_RESULT_CONSTEXPR20 constexpr
+#define TAO_RESULT_HAS_CONSTEXPR20
+#else
+#define TAO_RESULT_CONSTEXPR20
+#endif
+
+// Exception-free builds. Defined automatically under -fno-exceptions (or /EHs-
+// on MSVC); can also be defined by the user to keep value() from throwing in a
+// build that otherwise uses exceptions.
+#if !defined(TAO_RESULT_NO_EXCEPTIONS) &&                                     \
+    !(defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND))
+#define TAO_RESULT_NO_EXCEPTIONS
+#endif
+
+// Keeps failure paths (throwing, calling the failure handler) out of line and
+// in the cold text section so the happy path stays small.
+#if defined(__GNUC__) || defined(__clang__)
+#define TAO_RESULT_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define TAO_RESULT_COLD __declspec(noinline)
+#else
+#define TAO_RESULT_COLD
+#endif
+
+// Branch hints for the state tests, see tao::value_bias
+#if defined(__GNUC__) || defined(__clang__)
+#define TAO_RESULT_LIKELY(x) __builtin_expect(!!(x), 1)
+#define TAO_RESULT_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define TAO_RESULT_LIKELY(x) (!!(x))
+#define TAO_RESULT_UNLIKELY(x) (!!(x))
+#endif
+
+// Opt-in call-site instrumentation (define TAO_RESULT_INSTRUMENT, C++20).
+// Members that can produce or consume a failure take a trailing defaulted
+// std::source_location parameter, filled in at the caller, and bump a counter
+// for that site. When the macro is not defined the parameter and the
+// counting do not exist.
+#ifdef TAO_RESULT_INSTRUMENT
+#if defined(__has_include)
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+#endif
+#ifndef __cpp_lib_source_location
+#error "TAO_RESULT_INSTRUMENT requires std::source_location (C++20)"
+#endif
+#define TAO_RESULT_SITE_PARAM                                                  \
+  , ::std::source_location tao_site_ = ::std::source_location::current()
+#define TAO_RESULT_SITE_ONLY_PARAM                                             \
+  ::std::source_location tao_site_ = ::std::source_location::current()
+#define TAO_RESULT_RECORD(cond, ev)                                            \
+  do {                                                                         \
+    if (!::std::is_constant_evaluated() && (cond))                             \
+      ::tao::detail::instrument_record(tao_site_, ::tao::instrument::event::ev); \
+  } while (false)
+// The unexpect_t constructors are variadic, so the site travels in their tag
+// parameter instead, an unexpect_site converted from unexpect_t at the caller
+#define TAO_RESULT_UNEXPECT_PARAM ::tao::detail::unexpect_site tao_unexpect_
+#define TAO_RESULT_RECORD_UNEXPECT()                                           \
+  do {                                                                         \
+    const ::std::source_location tao_site_ = tao_unexpect_.site;               \
+    TAO_RESULT_RECORD(true, error_construct);                                  \
+  } while (false)
+#else
+#define TAO_RESULT_SITE_PARAM
+#define TAO_RESULT_SITE_ONLY_PARAM
+#define TAO_RESULT_RECORD(cond, ev) ((void)0)
+#define TAO_RESULT_UNEXPECT_PARAM unexpect_t
+#define TAO_RESULT_RECORD_UNEXPECT() ((void)0)
+#endif
+
+namespace tao {
+/// \exclude
+namespace detail {
+// C++14-style aliases for brevity
+template <typename T> 
+using remove_const_t = typename std::remove_const<T>::type;
+
+template <typename T>
+using remove_reference_t = typename std::remove_reference<T>::type;
+
+template <typename T> 
+using decay_t = typename std::decay<T>::type;
+
+template <bool E, typename T = void>
+using enable_if_t = typename std::enable_if<E, T>::type;
+
+template <bool B, typename T, typename F>
+using conditional_t = typename std::conditional<B, T, F>::type;
+
+// Placement new, through std::construct_at where it is usable in constant
+// expressions
+template <typename T, typename... Args>
+TAO_RESULT_CONSTEXPR20 T *construct_at(T *p, Args &&... args) {
+#ifdef TAO_RESULT_HAS_CONSTEXPR20
+  return std::construct_at(p, std::forward<Args>(args)...);
+#else
+  return ::new (const_cast<void *>(static_cast<const volatile void *>(p)))
+      T(std::forward<Args>(args)...);
+#endif
+}
+
+// Whether the call is part of a constant evaluation, where objects cannot be
+// copied as bytes; always false before C++20
+constexpr bool is_constant_evaluated() noexcept {
+#ifdef TAO_RESULT_HAS_CONSTEXPR20
+  return std::is_constant_evaluated();
+#else
+  return false;
+#endif
+}
+
+// Exchanges the object representations of a and b, which relocates each
+// object into the other's storage when T is trivially relocatable
+template <typename T> void swap_bytes(T &a, T &b) noexcept {
+  void *pa = const_cast<void *>(static_cast<const volatile void *>(&a));
+  void *pb = const_cast<void *>(static_cast<const volatile void *>(&b));
+  alignas(T) unsigned char tmp[sizeof(T)];
+  std::memcpy(tmp, pa, sizeof(T));
+  std::memcpy(pa, pb, sizeof(T));
+  std::memcpy(pb, tmp, sizeof(T));
+}
+
+// std::conjunction from C++17
+template <typename...> struct conjunction : std::true_type {};
+template <typename B> struct conjunction<B> : B {};
+template <typename B, typename... Bs>
+struct conjunction<B, Bs...>
+    : std::conditional<bool(B::value), conjunction<Bs...>, B>::type {};
+
+// Trait for checking if a type is a std::reference_wrapper
+template <typename T> struct is_reference_wrapper : std::false_type {};
+template <typename U>
+struct is_reference_wrapper<std::reference_wrapper<U>> : std::true_type {};
+
+// std::invoke from C++17
+// Member pointers are applied directly instead of going through std::mem_fn,
+// so a call through a pointer to member inlines exactly like a lambda would.
+// The overloads follow the INVOKE rules of [func.require]: object (or derived
+// object), std::reference_wrapper, and anything else is dereferenced.
+template <typename Base, typename T, typename Derived, typename... Args,
+          typename = enable_if_t<std::is_function<T>::value &&
+                                 std::is_base_of<Base, decay_t<Derived>>::value>>
+constexpr auto invoke(T Base::*pmf, Derived &&ref, Args &&... args) noexcept(
+    noexcept((std::forward<Derived>(ref).*pmf)(std::forward<Args>(args)...)))
+    -> decltype((std::forward<Derived>(ref).*pmf)(std::forward<Args>(args)...)) {
+  return (std::forward<Derived>(ref).*pmf)(std::forward<Args>(args)...);
+}
+
+template <typename Base, typename T, typename RefWrap, typename... Args,
+          typename = enable_if_t<std::is_function<T>::value &&
+                                 is_reference_wrapper<decay_t<RefWrap>>::value>>
+constexpr auto invoke(T Base::*pmf, RefWrap &&ref, Args &&... args) noexcept(
+    noexcept((ref.get().*pmf)(std::forward<Args>(args)...)))
+    -> decltype((ref.get().*pmf)(std::forward<Args>(args)...)) {
+  return (ref.get().*pmf)(std::forward<Args>(args)...);
+}
+
+template <typename Base, typename T, typename Pointer, typename... Args,
+          typename = enable_if_t<std::is_function<T>::value &&
+                                 !is_reference_wrapper<decay_t<Pointer>>::value &&
+                                 !std::is_base_of<Base, decay_t<Pointer>>::value>>
+constexpr auto invoke(T Base::*pmf, Pointer &&ptr, Args &&... args) noexcept(
+    noexcept(((*std::forward<Pointer>(ptr)).*pmf)(std::forward<Args>(args)...)))
+    -> decltype(((*std::forward<Pointer>(ptr)).*pmf)(std::forward<Args>(args)...)) {
+  return ((*std::forward<Pointer>(ptr)).*pmf)(std::forward<Args>(args)...);
+}
+
+template <typename Base, typename T, typename Derived,
+          typename = enable_if_t<!std::is_function<T>::value &&
+                                 std::is_base_of<Base, decay_t<Derived>>::value>>
+constexpr auto invoke(T Base::*pmd, Derived &&ref) noexcept
+    -> decltype(std::forward<Derived>(ref).*pmd) {
+  return std::forward<Derived>(ref).*pmd;
+}
+
+template <typename Base, typename T, typename RefWrap,
+          typename = enable_if_t<!std::is_function<T>::value &&
+                                 is_reference_wrapper<decay_t<RefWrap>>::value>>
+constexpr auto invoke(T Base::*pmd, RefWrap &&ref) noexcept
+    -> decltype(ref.get().*pmd) {
+  return ref.get().*pmd;
+}
+
+template <typename Base, typename T, typename Pointer,
+          typename = enable_if_t<!std::is_function<T>::value &&
+                                 !is_reference_wrapper<decay_t<Pointer>>::value &&
+                                 !std::is_base_of<Base, decay_t<Pointer>>::value>>
+constexpr auto invoke(T Base::*pmd, Pointer &&ptr) noexcept(
+    noexcept(*std::forward<Pointer>(ptr)))
+    -> decltype((*std::forward<Pointer>(ptr)).*pmd) {
+  return (*std::forward<Pointer>(ptr)).*pmd;
+}
+
+template <typename Fn, typename... Args,
+          typename = enable_if_t<!std::is_member_pointer<decay_t<Fn>>::value>>
+constexpr auto invoke(Fn &&f, Args &&... args) noexcept(
+    noexcept(std::forward<Fn>(f)(std::forward<Args>(args)...)))
+    -> decltype(std::forward<Fn>(f)(std::forward<Args>(args)...)) {
+  return std::forward<Fn>(f)(std::forward<Args>(args)...);
+}
+
+// std::invoke_result from C++17
+template <typename F, typename, typename... Us> struct invoke_result_impl;
+
+template <typename F, typename... Us>
+struct invoke_result_impl<
+    F, decltype(detail::invoke(std::declval<F>(), std::declval<Us>()...), void()),
+    Us...> {
+  using type = decltype(detail::invoke(std::declval<F>(), std::declval<Us>()...));
+};
+
+template <typename F, typename... Us>
+using invoke_result = invoke_result_impl<F, void, Us...>;
+
+template <typename F, typename... Us>
+using invoke_result_t = typename invoke_result<F, Us...>::type;
+
+// std::void_t from C++17
+template <typename...> struct voider { using type = void; };
+template <typename... Ts> using void_t = typename voider<Ts...>::type;
+
+#ifdef _MSC_VER
+// TODO make a version which works with MSVC
+template <typename T, typename U = T> struct is_swappable : std::true_type {};
+
+template <typename T, typename U = T> struct is_nothrow_swappable : std::true_type {};
+#else
+// https://stackoverflow.com/questions/26744589/what-is-a-proper-way-to-implement-is-swappable-to-test-for-the-swappable-concept
+namespace swap_adl_tests {
+// if swap ADL finds this then it would call std::swap otherwise (same
+// signature)
+struct tag {};
+
+template <typename T> tag swap(T &, T &);
+template <typename T, std::size_t N> tag swap(T (&a)[N], T (&b)[N]);
+
+// helper functions to test if an unqualified swap is possible, and if it
+// becomes std::swap
+template <typename, typename> std::false_type can_swap(...) noexcept(false);
+template <typename T, typename U,
+          typename = decltype(swap(std::declval<T &>(), std::declval<U &>()))>
+std::true_type can_swap(int) noexcept(noexcept(swap(std::declval<T &>(),
+                                                    std::declval<U &>())));
+
+template <typename, typename> std::false_type uses_std(...);
+template <typename T, typename U>
+std::is_same<decltype(swap(std::declval<T &>(), std::declval<U &>())), tag>
+uses_std(int);
+
+template <typename T>
+struct is_std_swap_noexcept
+    : std::integral_constant<bool,
+                             std::is_nothrow_move_constructible<T>::value &&
+                                 std::is_nothrow_move_assignable<T>::value> {};
+
+template <typename T, std::size_t N>
+struct is_std_swap_noexcept<T[N]> : is_std_swap_noexcept<T> {};
+
+template <typename T, typename U>
+struct is_adl_swap_noexcept
+    : std::integral_constant<bool, noexcept(can_swap<T, U>(0))> {};
+} // namespace swap_adl_tests
+
+template <typename T, typename U = T>
+struct is_swappable
+    : std::integral_constant<
+          bool,
+          decltype(detail::swap_adl_tests::can_swap<T, U>(0))::value &&
+              (!decltype(detail::swap_adl_tests::uses_std<T, U>(0))::value ||
+               (std::is_move_assignable<T>::value &&
+                std::is_move_constructible<T>::value))> {};
+
+template <typename T, std::size_t N>
+struct is_swappable<T[N], T[N]>
+    : std::integral_constant<
+          bool,
+          decltype(detail::swap_adl_tests::can_swap<T[N], T[N]>(0))::value &&
+              (!decltype(
+                   detail::swap_adl_tests::uses_std<T[N], T[N]>(0))::value ||
+               is_swappable<T, T>::value)> {};
+
+template <typename T, typename U = T>
+struct is_nothrow_swappable
+    : std::integral_constant<
+          bool,
+          is_swappable<T, U>::value &&
+              ((decltype(detail::swap_adl_tests::uses_std<T, U>(0))::value
+                    &&detail::swap_adl_tests::is_std_swap_noexcept<T>::value) ||
+               (!decltype(detail::swap_adl_tests::uses_std<T, U>(0))::value &&
+                    detail::swap_adl_tests::is_adl_swap_noexcept<T,
+                                                                 U>::value))> {
+};
+#endif
+
+} // namespace detail
+} // namespace tao
+
 namespace tao {
-#ifndef TAO_MONOSTATE_INPLACE_MUTEX
-#define TAO_MONOSTATE_INPLACE_MUTEX
 /// \brief Used to represent an optional with no data; essentially a bool
 class monostate {};
 
@@ -30,19 +436,256 @@ struct in_place_t {
     explicit in_place_t() = default;
 };
 /// \brief A tag to tell optional to construct its value in-place
-static constexpr in_place_t in_place {};
-#endif
+TAO_RESULT_INLINE_VAR constexpr in_place_t in_place {};
 
 template <typename T> class optional;
+// result<T, E> and result<void, E> are defined below; result<T, E1, E2, ...>,
+// with more than one error alternative, in tao/result/multi_error.hpp
+template <typename T, typename E, typename... Es> class result;
+template <typename E> class contextual;
+template <typename T> struct is_trivially_relocatable;
+
+/// \exclude
+namespace detail {
+template <typename E> struct is_contextual : std::false_type {};
+template <typename E> struct is_contextual<contextual<E>> : std::true_type {};
+
+// Trait for checking if a type is a tao::result
+template <typename T> struct is_result_impl : std::false_type {};
+template <typename T, typename E> struct is_result_impl<result<T, E>> : std::true_type {};
+template <typename T> using is_result = is_result_impl<decay_t<T>>;
+
+// Returns the error of the failed result r as an R, which is another result
+// type; defined next to unexpect_t
+template <typename R, typename Res> constexpr R forward_error(Res &&r);
+
+// with_context wraps a plain error in contextual<E> once; later calls keep
+// the type and only push frames
+template <typename T, typename E>
+using with_context_result =
+    result<T, conditional_t<is_contextual<E>::value, E, contextual<E>>>;
+} // namespace detail
+
+/// \brief Customization point that lets `optional<T>` encode the empty state
+/// inside `T` itself instead of keeping a separate `bool`.
+///
+/// \details The primary template provides no niche. A specialization must
+/// provide `static T empty_value()`, returning the sentinel that represents
+/// an empty optional, and `static bool is_empty(const T&)`. When both exist,
+/// `sizeof(optional<T>) == sizeof(T)`, and an optional holding a value for
+/// which `is_empty` is true is indistinguishable from an empty one.
+/// `T` must be nothrow move constructible and nothrow destructible.
+///
+/// The niche policies below can be used to opt a type in:
+///
+/// ```
+/// enum class color { red, green, blue, invalid };
+///
+/// namespace tao {
+/// template <> struct optional_traits<color>
+///     : sentinel_niche<color, color::invalid> {};
+/// template <> struct optional_traits<widget*> : null_niche<widget*> {};
+/// template <> struct optional_traits<double> : nan_niche<double> {};
+/// }
+/// ```
+///
+/// The built-in policies are not enabled by default because they take away
+/// a legal value: `nullptr` for pointers and smart pointers, NaN for floating
+/// point types.
+template <typename T, typename = void> struct optional_traits {};
+
+/// \brief Niche policy for pointer-like types: the null pointer is the empty
+/// state. Works for raw pointers, `std::unique_ptr` and `std::shared_ptr`.
+template <typename T> struct null_niche {
+  static constexpr T empty_value() noexcept { return T(nullptr); }
+  static constexpr bool is_empty(const T &v) noexcept { return v == nullptr; }
+};
+
+/// \brief Niche policy for floating point types: any NaN is the empty state.
+template <typename T> struct nan_niche {
+  static_assert(std::numeric_limits<T>::has_quiet_NaN,
+                "nan_niche requires a type with a quiet NaN");
+
+  static constexpr T empty_value() noexcept {
+    return std::numeric_limits<T>::quiet_NaN();
+  }
+  static constexpr bool is_empty(const T &v) noexcept { return v != v; }
+};
+
+/// \brief Niche policy for enumerations and integers that have a spare value.
+template <typename T, T Sentinel> struct sentinel_niche {
+  static constexpr T empty_value() noexcept { return Sentinel; }
+  static constexpr bool is_empty(const T &v) noexcept { return v == Sentinel; }
+};
+
+/// \brief The state an optional or a result is expected to be in, see
+/// `value_bias`.
+enum class branch_bias {
+  /// Nearly always holds a value
+  value,
+  /// No expectation
+  none,
+  /// Nearly always empty, or holding an error
+  empty
+};
+
+/// \brief Customization point telling which state an `optional<U>` or a
+/// `result<U, E>` of type `T` is usually in.
+///
+/// \details The members that branch on the state (`value()`, `map`,
+/// `and_then`, `or_else`, `value_or`, ...) pass it to the compiler as a
+/// branch hint. When a value is expected, they also build the empty or error
+/// result they return in a cold, out-of-line helper, so the success path is
+/// laid out as straight-line code. The default expects a value; a lookup that
+/// usually misses can say so:
+///
+/// ```
+/// namespace tao {
+/// template <> struct value_bias<optional<cache_entry>>
+///     : std::integral_constant<branch_bias, branch_bias::empty> {};
+/// }
+/// ```
+template <typename T>
+struct value_bias
+    : std::integral_constant<branch_bias, branch_bias::value> {};
 
 /// \exclude
 namespace detail {
 
+// The state test of x, hinted with value_bias
+template <typename X> constexpr bool engaged(const X &x) noexcept {
+  return value_bias<X>::value == branch_bias::value
+             ? TAO_RESULT_LIKELY(x.has_value())
+             : value_bias<X>::value == branch_bias::empty
+                   ? TAO_RESULT_UNLIKELY(x.has_value())
+                   : x.has_value();
+}
+
+// Builds the empty or error result returned by a member of Self. Off the
+// expected path it is constructed out of line, which also tells the compiler
+// that the branch leading there is unlikely.
+template <typename Ret, typename... Args>
+TAO_RESULT_COLD constexpr Ret make_cold(Args &&... args) {
+  return Ret(std::forward<Args>(args)...);
+}
+
+template <typename Ret, typename... Args>
+constexpr Ret make_off_path_impl(std::true_type, Args &&... args) {
+  return detail::make_cold<Ret>(std::forward<Args>(args)...);
+}
+
+template <typename Ret, typename... Args>
+constexpr Ret make_off_path_impl(std::false_type, Args &&... args) {
+  return Ret(std::forward<Args>(args)...);
+}
+
+template <typename Self, typename Ret, typename... Args>
+constexpr Ret make_off_path(Args &&... args) {
+  return make_off_path_impl<Ret>(
+      std::integral_constant<bool, value_bias<decay_t<Self>>::value ==
+                                       branch_bias::value>{},
+      std::forward<Args>(args)...);
+}
+
+// Trait for checking if optional_traits<T> provides a niche
+template <typename T, typename = void> struct has_niche : std::false_type {};
+template <typename T>
+struct has_niche<
+    T, void_t<decltype(optional_traits<T>::empty_value()),
+              decltype(optional_traits<T>::is_empty(std::declval<const T &>()))>>
+    : std::true_type {};
+
 // Trait for checking if a type is a tao::optional
 template <typename T> struct is_optional_impl : std::false_type {};
 template <typename T> struct is_optional_impl<optional<T>> : std::true_type {};
 template <typename T> using is_optional = is_optional_impl<decay_t<T>>;
 
+// Traits for checking if a type is a std::optional or a std::expected
+template <typename T> struct is_std_optional : std::false_type {};
+template <typename T> struct is_std_expected : std::false_type {};
+#ifdef TAO_RESULT_HAS_STD_OPTIONAL
+template <typename T>
+struct is_std_optional<std::optional<T>> : std::true_type {};
+#endif
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+template <typename T, typename E>
+struct is_std_expected<std::expected<T, E>> : std::true_type {};
+#endif
+
+// An allocator-aware T has a stateful allocator_type that it takes through
+// uses-allocator construction and reports through get_allocator(), as the
+// std::pmr containers do. optional and result keep that allocator while they
+// hold no T, so that a later assignment or emplace constructs the new T with
+// it instead of a default one.
+template <typename T, typename = void>
+struct is_allocator_aware : std::false_type {};
+template <typename T>
+struct is_allocator_aware<
+    T, void_t<typename T::allocator_type,
+              decltype(std::declval<const T &>().get_allocator())>>
+    : std::integral_constant<
+          bool, std::uses_allocator<T, typename T::allocator_type>::value &&
+                    !std::is_empty<typename T::allocator_type>::value> {};
+
+// Uses-allocator construction ([allocator.uses.construction]): T takes the
+// allocator after std::allocator_arg, as its last argument, or not at all if
+// it does not use Alloc
+struct uses_allocator_none {};
+struct uses_allocator_leading {};
+struct uses_allocator_trailing {};
+
+template <typename T, typename Alloc, typename... Args>
+using uses_allocator_tag = conditional_t<
+    !std::uses_allocator<T, Alloc>::value, uses_allocator_none,
+    conditional_t<std::is_constructible<T, std::allocator_arg_t,
+                                        const Alloc &, Args...>::value,
+                  uses_allocator_leading, uses_allocator_trailing>>;
+
+template <typename T, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20 T *construct_using_allocator(uses_allocator_none, T *p,
+                                                    const Alloc &,
+                                                    Args &&... args) {
+  return detail::construct_at(p, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20 T *construct_using_allocator(uses_allocator_leading,
+                                                    T *p, const Alloc &a,
+                                                    Args &&... args) {
+  return detail::construct_at(p, std::allocator_arg, a,
+                              std::forward<Args>(args)...);
+}
+
+template <typename T, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20 T *construct_using_allocator(uses_allocator_trailing,
+                                                    T *p, const Alloc &a,
+                                                    Args &&... args) {
+  return detail::construct_at(p, std::forward<Args>(args)..., a);
+}
+
+template <typename T, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20 T *construct_using_allocator(T *p, const Alloc &a,
+                                                    Args &&... args) {
+  return detail::construct_using_allocator(
+      uses_allocator_tag<T, Alloc, Args &&...>{}, p, a,
+      std::forward<Args>(args)...);
+}
+
+// Allocators need not be assignable (polymorphic_allocator is not), so a
+// kept allocator is replaced by constructing the new one in its place
+template <typename Alloc>
+void replace_allocator(Alloc &dst, const Alloc &src) noexcept {
+  const Alloc tmp(src);
+  dst.~Alloc();
+  detail::construct_at(std::addressof(dst), tmp);
+}
+
+// A tag to construct the stored value from the result of invoking a function,
+// so that a prvalue result initializes the storage directly
+struct in_place_invoke_t {
+    explicit in_place_invoke_t() = default;
+};
+
 // Change void to tao::monostate
 template <typename U>
 using fixup_void = conditional_t<std::is_void<U>::value, monostate, U>;
@@ -68,7 +711,8 @@ template <typename T, typename U>
 using enable_forward_value =
     detail::enable_if_t<std::is_constructible<T, U&& >::value &&
                         !std::is_same<detail::decay_t<U>, in_place_t>::value &&
-                        !std::is_same<optional<T>, detail::decay_t<U>>::value>;
+                        !std::is_same<optional<T>, detail::decay_t<U>>::value &&
+                        !is_std_optional<detail::decay_t<U>>::value>;
 
 template <typename T, typename U, typename Other>
 using enable_from_other = detail::enable_if_t<
@@ -82,6 +726,24 @@ using enable_from_other = detail::enable_if_t<
     !std::is_convertible<const optional<U>&, T>::value &&
     !std::is_convertible<const optional<U>&&, T>::value>;
 
+#ifdef TAO_RESULT_HAS_STD_OPTIONAL
+// As enable_from_other for a std::optional<U>. A bool is always taken from
+// the contained value, as std::optional<bool> does, never from the
+// explicit operator bool of the source.
+template <typename T, typename U, typename Other>
+using enable_from_std_optional = detail::enable_if_t<
+    std::is_constructible<T, Other>::value &&
+    (std::is_same<typename std::remove_cv<T>::type, bool>::value ||
+     (!std::is_constructible<T, std::optional<U>&>::value &&
+      !std::is_constructible<T, std::optional<U>&&>::value &&
+      !std::is_constructible<T, const std::optional<U>&>::value &&
+      !std::is_constructible<T, const std::optional<U>&&>::value &&
+      !std::is_convertible<std::optional<U>&, T>::value &&
+      !std::is_convertible<std::optional<U>&&, T>::value &&
+      !std::is_convertible<const std::optional<U>&, T>::value &&
+      !std::is_convertible<const std::optional<U>&&, T>::value))>;
+#endif
+
 template <typename T, typename U>
 using enable_assign_forward = detail::enable_if_t<
     !std::is_same<optional<T>, detail::decay_t<U>>::value &&
@@ -106,6 +768,54 @@ using enable_assign_from_other = detail::enable_if_t<
     !std::is_assignable<T &, const optional<U>&>::value &&
     !std::is_assignable<T &, const optional<U>&&>::value>;
 
+#ifdef TAO_RESULT_CONCEPTS
+// Concept forms of the enable_* constraints above. The
+// disjunctions stop at the first trait that holds, and the satisfaction of
+// each concept-id is cached by the compiler, so the checks against the four
+// cv/ref forms of optional<U> are shared by all the overloads that use them.
+template <typename T, typename W>
+concept constructible_or_convertible_from_cvref =
+    std::is_constructible<T, W &>::value ||
+    std::is_constructible<T, W &&>::value ||
+    std::is_constructible<T, const W &>::value ||
+    std::is_constructible<T, const W &&>::value ||
+    std::is_convertible<W &, T>::value || std::is_convertible<W &&, T>::value ||
+    std::is_convertible<const W &, T>::value ||
+    std::is_convertible<const W &&, T>::value;
+
+template <typename T, typename W>
+concept assignable_from_cvref = std::is_assignable<T &, W &>::value ||
+                                std::is_assignable<T &, W &&>::value ||
+                                std::is_assignable<T &, const W &>::value ||
+                                std::is_assignable<T &, const W &&>::value;
+
+// The cheap is_same checks come first, so an optional<T> argument never
+// gets as far as the is_constructible check
+template <typename T, typename U>
+concept constructible_forward_value =
+    !std::is_same<detail::decay_t<U>, in_place_t>::value &&
+    !std::is_same<optional<T>, detail::decay_t<U>>::value &&
+    !is_std_optional<detail::decay_t<U>>::value &&
+    std::is_constructible<T, U &&>::value;
+
+template <typename T, typename U>
+concept assignable_forward =
+    !std::is_same<optional<T>, detail::decay_t<U>>::value &&
+    !(std::is_scalar<T>::value && std::is_same<T, detail::decay_t<U>>::value) &&
+    std::is_constructible<T, U>::value && std::is_assignable<T &, U>::value;
+
+template <typename T, typename U, typename Other>
+concept constructible_from_other =
+    std::is_constructible<T, Other>::value &&
+    !constructible_or_convertible_from_cvref<T, optional<U>>;
+
+template <typename T, typename U, typename Other>
+concept assignable_from_other =
+    constructible_from_other<T, U, Other> &&
+    std::is_assignable<T &, Other>::value &&
+    !assignable_from_cvref<T, optional<U>>;
+#endif
+
 
 // The storage base manages the actual storage, and correctly propagates
 // trivial destruction from T. This case is for when T is not trivially
@@ -117,12 +827,26 @@ struct optional_storage_base {
         : dummy_(), has_value_(false)
     {}
 
+    template <typename Alloc>
+    constexpr
+    optional_storage_base(std::allocator_arg_t, const Alloc&) noexcept
+        : dummy_(), has_value_(false)
+    {}
+
     template <typename... U>
     constexpr 
     optional_storage_base(in_place_t, U&&... u)
         : value_(std::forward<U>(u)...), has_value_(true)
     {}
 
+    template <typename F, typename... U>
+    constexpr
+    optional_storage_base(in_place_invoke_t, F&& f, U&&... u)
+        : value_(detail::invoke(std::forward<F>(f), std::forward<U>(u)...)),
+          has_value_(true)
+    {}
+
+    TAO_RESULT_CONSTEXPR20
     ~optional_storage_base() {
         if (has_value_) {
             value_.~T();
@@ -148,12 +872,25 @@ struct optional_storage_base<T, true> {
         : dummy_(), has_value_(false) 
     {}
 
+    template <typename Alloc>
+    constexpr
+    optional_storage_base(std::allocator_arg_t, const Alloc&) noexcept
+        : dummy_(), has_value_(false)
+    {}
+
     template <typename... U>
     constexpr 
     optional_storage_base(in_place_t, U&&... u)
         : value_(std::forward<U>(u)...), has_value_(true)
     {}
 
+    template <typename F, typename... U>
+    constexpr
+    optional_storage_base(in_place_invoke_t, F&& f, U&&... u)
+        : value_(detail::invoke(std::forward<F>(f), std::forward<U>(u)...)),
+          has_value_(true)
+    {}
+
     // No destructor, so this class is trivially destructible
 
     struct dummy {};
@@ -168,39 +905,71 @@ struct optional_storage_base<T, true> {
 
 // This base class provides some handy member functions which can be used in
 // further derived classes
-template <typename T> 
+template <typename T, bool = has_niche<T>::value,
+          bool = is_allocator_aware<T>::value>
 struct optional_operations_base : optional_storage_base<T> {
     using optional_storage_base<T>::optional_storage_base;
 
+    TAO_RESULT_CONSTEXPR20
     void hard_reset() noexcept {
         get().~T();
         this->has_value_ = false;
     }
 
+    // The flag is only set once T's constructor has returned, so a throwing
+    // constructor leaves the optional empty
     template <typename... Args> 
-    void construct(Args &&... args) noexcept {
-        //TODO(fernando): std::launder() ?
-        new (std::addressof(this->value_)) T(std::forward<Args>(args)...);
+    TAO_RESULT_CONSTEXPR20
+    void construct(Args &&... args) noexcept(
+        std::is_nothrow_constructible<T, Args &&...>::value) {
+        detail::construct_at(std::addressof(this->value_),
+                             std::forward<Args>(args)...);
+        this->has_value_ = true;
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_with_allocator(const Alloc &a, Args &&... args) {
+        detail::construct_using_allocator(std::addressof(this->value_), a,
+                                          std::forward<Args>(args)...);
         this->has_value_ = true;
     }
 
+    // Destroys the current value, if any, and constructs a new one
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void replace(Args &&... args) noexcept(
+        std::is_nothrow_constructible<T, Args &&...>::value) {
+        if (this->has_value_) {
+            hard_reset();
+        }
+        construct(std::forward<Args>(args)...);
+    }
+
+    // One branch per state transition: engaged/engaged assigns, the mixed
+    // cases construct or destroy, empty/empty does nothing
     template <typename Opt> 
+    TAO_RESULT_CONSTEXPR20
     void assign(Opt &&rhs) {
         if (this->has_value()) {
             if (rhs.has_value()) {
                 this->value_ = std::forward<Opt>(rhs).get();
             } else {
-                this->value_.~T();
-                this->has_value_ = false;
+                hard_reset();
             }
-        }
-
-        if (rhs.has_value()) {
+        } else if (rhs.has_value()) {
             construct(std::forward<Opt>(rhs).get());
         }
     }
 
-    bool has_value() const { return this->has_value_; }
+    // Swaps the bytes of the storage and the flags, whatever the states;
+    // only valid when T is trivially relocatable
+    void swap_storage(optional_operations_base &rhs) noexcept {
+        detail::swap_bytes(this->value_, rhs.value_);
+        std::swap(this->has_value_, rhs.has_value_);
+    }
+
+    constexpr bool has_value() const noexcept { return this->has_value_; }
 
     constexpr 
     T &get() & { return this->value_; }
@@ -216,57 +985,410 @@ struct optional_operations_base : optional_storage_base<T> {
 #endif
 };
 
-// This typename manages conditionally having a trivial copy constructor
-// This specialization is for when T is trivially copy constructible
-template <typename T, bool = TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T)>
-struct optional_copy_base : optional_operations_base<T> {
-  using optional_operations_base<T>::optional_operations_base;
-};
-
-// This specialization is for when T is not trivially copy constructible
+// The niche storage base keeps a live T at all times: either the engaged value
+// or the sentinel given by optional_traits<T>, so no separate flag is needed.
+// Trivial copy, move and destruction are inherited from T directly.
 template <typename T>
-struct optional_copy_base<T, false> : optional_operations_base<T> {
-  using optional_operations_base<T>::optional_operations_base;
+struct optional_niche_storage_base {
+    using traits = optional_traits<T>;
 
-  optional_copy_base() = default;
-  optional_copy_base(const optional_copy_base &rhs) {
-    if (rhs.has_value()) {
-      this->construct(rhs.get());
-    } else {
-      this->has_value_ = false;
-    }
-  }
+    static_assert(std::is_nothrow_move_constructible<T>::value &&
+                      std::is_nothrow_destructible<T>::value,
+                  "a niche optional requires T to be nothrow move constructible "
+                  "and nothrow destructible");
 
-  optional_copy_base(optional_copy_base &&rhs) = default;
-  optional_copy_base &operator=(const optional_copy_base &rhs) = default;
-  optional_copy_base &operator=(optional_copy_base &&rhs) = default;
-};
+    constexpr
+    optional_niche_storage_base() noexcept
+        : value_(traits::empty_value())
+    {}
 
-// This class manages conditionally having a trivial move constructor
-// Unfortunately there's no way to achieve this in GCC < 5 AFAIK, since it
-// doesn't implement an analogue to std::is_trivially_move_constructible. We
-// have to make do with a non-trivial move constructor even if T is trivially
-// move constructible
-#ifndef TAO_OPTIONAL_GCC49
-template <typename T, bool = std::is_trivially_move_constructible<T>::value>
-struct optional_move_base : optional_copy_base<T> {
-  using optional_copy_base<T>::optional_copy_base;
+    template <typename Alloc>
+    constexpr
+    optional_niche_storage_base(std::allocator_arg_t, const Alloc&) noexcept
+        : value_(traits::empty_value())
+    {}
+
+    template <typename... U>
+    constexpr
+    optional_niche_storage_base(in_place_t, U&&... u)
+        : value_(std::forward<U>(u)...)
+    {}
+
+    template <typename F, typename... U>
+    constexpr
+    optional_niche_storage_base(in_place_invoke_t, F&& f, U&&... u)
+        : value_(detail::invoke(std::forward<F>(f), std::forward<U>(u)...))
+    {}
+
+    T value_;
 };
-#else
-template <typename T, bool = false> struct optional_move_base;
-#endif
-template <typename T> struct optional_move_base<T, false> : optional_copy_base<T> {
-  using optional_copy_base<T>::optional_copy_base;
 
-  optional_move_base() = default;
-  optional_move_base(const optional_move_base &rhs) = default;
+template <typename T, bool AllocatorAware>
+struct optional_operations_base<T, true, AllocatorAware>
+    : optional_niche_storage_base<T> {
+    using optional_niche_storage_base<T>::optional_niche_storage_base;
+    using traits = optional_traits<T>;
 
-  optional_move_base(optional_move_base &&rhs) noexcept(
-      std::is_nothrow_move_constructible<T>::value) {
-    if (rhs.has_value()) {
-      this->construct(std::move(rhs.get()));
-    } else {
-      this->has_value_ = false;
+    TAO_RESULT_CONSTEXPR20
+    void hard_reset() noexcept {
+        this->value_ = traits::empty_value();
+    }
+
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct(Args &&... args) {
+        construct_impl(std::is_nothrow_constructible<T, Args &&...>{},
+                       std::forward<Args>(args)...);
+    }
+
+    // The sentinel does not keep an allocator, so only this value uses `a`
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_with_allocator(const Alloc &a, Args &&... args) {
+        construct_tagged(uses_allocator_tag<T, Alloc, Args &&...>{}, a,
+                         std::forward<Args>(args)...);
+    }
+
+    // construct already replaces whatever T is alive, value or sentinel
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void replace(Args &&... args) noexcept(
+        std::is_nothrow_constructible<T, Args &&...>::value) {
+        construct(std::forward<Args>(args)...);
+    }
+
+    // The sentinel is a regular T, so every state transition is a plain
+    // assignment
+    template <typename Opt>
+    TAO_RESULT_CONSTEXPR20
+    void assign(Opt &&rhs) {
+        this->value_ = std::forward<Opt>(rhs).get();
+    }
+
+    // The empty state is a T too, so swapping the values swaps the states
+    void swap_storage(optional_operations_base &rhs) noexcept {
+        detail::swap_bytes(this->value_, rhs.value_);
+    }
+
+    constexpr bool has_value() const noexcept {
+        return !traits::is_empty(this->value_);
+    }
+
+    constexpr
+    T &get() & { return this->value_; }
+
+    constexpr
+    const T &get() const & { return this->value_; }
+
+    constexpr
+    T &&get() && { return std::move(this->value_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+    constexpr const T &&get() const && { return std::move(this->value_); }
+#endif
+
+private:
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_impl(std::true_type, Args &&... args) noexcept {
+        this->value_.~T();
+        detail::construct_at(std::addressof(this->value_),
+                             std::forward<Args>(args)...);
+    }
+
+    // Build the new value first so the sentinel is still alive if T's
+    // constructor throws
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_impl(std::false_type, Args &&... args) {
+        T tmp(std::forward<Args>(args)...);
+        this->value_.~T();
+        detail::construct_at(std::addressof(this->value_), std::move(tmp));
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_tagged(uses_allocator_none, const Alloc &,
+                          Args &&... args) {
+        construct(std::forward<Args>(args)...);
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_tagged(uses_allocator_leading, const Alloc &a,
+                          Args &&... args) {
+        construct(std::allocator_arg, a, std::forward<Args>(args)...);
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void construct_tagged(uses_allocator_trailing, const Alloc &a,
+                          Args &&... args) {
+        construct(std::forward<Args>(args)..., a);
+    }
+};
+
+// The storage for an allocator-aware T (see is_allocator_aware). While the
+// optional is empty, the union holds T's allocator where the value would
+// be, so the memory resource survives reset and reassignment at no cost in
+// size; while it is engaged, the value carries the allocator itself.
+template <typename T>
+struct optional_allocator_storage_base {
+    using allocator_type = typename T::allocator_type;
+
+    optional_allocator_storage_base() noexcept
+        : alloc_(), has_value_(false)
+    {}
+
+    template <typename Alloc,
+              enable_if_t<std::is_convertible<const Alloc &,
+                                              allocator_type>::value> * = nullptr>
+    optional_allocator_storage_base(std::allocator_arg_t, const Alloc &a) noexcept
+        : alloc_(a), has_value_(false)
+    {}
+
+    template <typename Alloc,
+              enable_if_t<!std::is_convertible<const Alloc &,
+                                               allocator_type>::value> * = nullptr>
+    optional_allocator_storage_base(std::allocator_arg_t, const Alloc &) noexcept
+        : alloc_(), has_value_(false)
+    {}
+
+    template <typename... U>
+    optional_allocator_storage_base(in_place_t, U&&... u)
+        : value_(std::forward<U>(u)...), has_value_(true)
+    {}
+
+    template <typename F, typename... U>
+    optional_allocator_storage_base(in_place_invoke_t, F&& f, U&&... u)
+        : value_(detail::invoke(std::forward<F>(f), std::forward<U>(u)...)),
+          has_value_(true)
+    {}
+
+    TAO_RESULT_CONSTEXPR20
+    ~optional_allocator_storage_base() {
+        if (has_value_) {
+            value_.~T();
+        } else {
+            alloc_.~allocator_type();
+        }
+    }
+
+    union {
+        allocator_type alloc_;
+        T value_;
+    };
+
+    bool has_value_;
+};
+
+// Every T is constructed with the kept allocator. A copy starts from the
+// allocator that select_on_container_copy_construction picks, a move from
+// the source's, and assignment keeps the target's unless the allocator
+// propagates on copy or move assignment, as for a standard container.
+template <typename T>
+struct optional_operations_base<T, false, true>
+    : optional_allocator_storage_base<T> {
+    using optional_allocator_storage_base<T>::optional_allocator_storage_base;
+    using allocator_type = typename T::allocator_type;
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+    optional_operations_base() = default;
+
+    optional_operations_base(const optional_operations_base &rhs)
+        : optional_allocator_storage_base<T>(
+              std::allocator_arg,
+              alloc_traits::select_on_container_copy_construction(
+                  rhs.get_allocator())) {
+        if (rhs.has_value_) {
+            construct(rhs.value_);
+        }
+    }
+
+    // The moved value brings its allocator, so T's move constructor is used
+    // as it is rather than the allocator-extended one
+    optional_operations_base(optional_operations_base &&rhs) noexcept(
+        std::is_nothrow_move_constructible<T>::value)
+        : optional_allocator_storage_base<T>(std::allocator_arg,
+                                             rhs.get_allocator()) {
+        if (rhs.has_value_) {
+            const allocator_type keep(this->alloc_);
+            construct_impl(keep, uses_allocator_none{}, keep,
+                           std::move(rhs.value_));
+        }
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return this->has_value_ ? allocator_type(this->value_.get_allocator())
+                                : this->alloc_;
+    }
+
+    void hard_reset() noexcept {
+        const allocator_type a(this->value_.get_allocator());
+        this->value_.~T();
+        detail::construct_at(std::addressof(this->alloc_), a);
+        this->has_value_ = false;
+    }
+
+    template <typename... Args>
+    void construct(Args &&... args) {
+        const allocator_type a(this->alloc_);
+        construct_impl(a, uses_allocator_tag<T, allocator_type, Args &&...>{},
+                       a, std::forward<Args>(args)...);
+    }
+
+    // An allocator that converts to allocator_type replaces the kept one,
+    // any other is only offered to T
+    template <typename Alloc, typename... Args>
+    void construct_with_allocator(const Alloc &a, Args &&... args) {
+        const allocator_type keep(next_allocator(
+            a, std::is_convertible<const Alloc &, allocator_type>{}));
+        construct_impl(keep, uses_allocator_tag<T, Alloc, Args &&...>{}, a,
+                       std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void replace(Args &&... args) {
+        if (this->has_value_) {
+            hard_reset();
+        }
+        construct(std::forward<Args>(args)...);
+    }
+
+    template <typename Opt>
+    void assign(Opt &&rhs) {
+        if (this->has_value_ && rhs.has_value()) {
+            this->value_ = std::forward<Opt>(rhs).get();
+            return;
+        }
+        if (this->has_value_) {
+            hard_reset();
+        }
+        // Converting assignment from an optional<U> keeps the target's
+        using propagates = std::integral_constant<
+            bool,
+            std::is_base_of<optional_operations_base, decay_t<Opt>>::value &&
+                (std::is_lvalue_reference<Opt>::value
+                     ? alloc_traits::propagate_on_container_copy_assignment::value
+                     : alloc_traits::propagate_on_container_move_assignment::
+                           value)>;
+        propagate_allocator(rhs, propagates{});
+        if (rhs.has_value()) {
+            construct(std::forward<Opt>(rhs).get());
+        }
+    }
+
+    void swap_storage(optional_operations_base &rhs) noexcept {
+        detail::swap_bytes(this->value_, rhs.value_);
+        std::swap(this->has_value_, rhs.has_value_);
+    }
+
+    constexpr bool has_value() const noexcept { return this->has_value_; }
+
+    constexpr
+    T &get() & { return this->value_; }
+
+    constexpr
+    const T &get() const & { return this->value_; }
+
+    constexpr
+    T &&get() && { return std::move(this->value_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+    constexpr const T &&get() const && { return std::move(this->value_); }
+#endif
+
+private:
+    template <typename Alloc>
+    allocator_type next_allocator(const Alloc &a, std::true_type) const noexcept {
+        return allocator_type(a);
+    }
+
+    template <typename Alloc>
+    allocator_type next_allocator(const Alloc &, std::false_type) const noexcept {
+        return this->alloc_;
+    }
+
+    template <typename Opt>
+    void propagate_allocator(const Opt &rhs, std::true_type) noexcept {
+        detail::replace_allocator(this->alloc_, rhs.get_allocator());
+    }
+
+    template <typename Opt>
+    void propagate_allocator(const Opt &, std::false_type) noexcept {}
+
+    // Ends the lifetime of the kept allocator and constructs the value in
+    // its place, or puts `keep` back if T's constructor throws
+    template <typename Tag, typename Alloc, typename... Args>
+    void construct_impl(const allocator_type &keep, Tag tag, const Alloc &a,
+                        Args &&... args) {
+        this->alloc_.~allocator_type();
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+        detail::construct_using_allocator(tag, std::addressof(this->value_), a,
+                                          std::forward<Args>(args)...);
+#else
+        try {
+            detail::construct_using_allocator(tag, std::addressof(this->value_),
+                                              a, std::forward<Args>(args)...);
+        } catch (...) {
+            detail::construct_at(std::addressof(this->alloc_), keep);
+            throw;
+        }
+#endif
+        this->has_value_ = true;
+    }
+};
+
+// This typename manages conditionally having a trivial copy constructor
+// This specialization is for when T is trivially copy constructible, or
+// allocator-aware, which optional_operations_base copies itself
+template <typename T, bool = TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) ||
+                             is_allocator_aware<T>::value>
+struct optional_copy_base : optional_operations_base<T> {
+  using optional_operations_base<T>::optional_operations_base;
+};
+
+// This specialization is for when T is not trivially copy constructible
+template <typename T>
+struct optional_copy_base<T, false> : optional_operations_base<T> {
+  using optional_operations_base<T>::optional_operations_base;
+
+  optional_copy_base() = default;
+  TAO_RESULT_CONSTEXPR20 optional_copy_base(const optional_copy_base &rhs) {
+    if (rhs.has_value()) {
+      this->construct(rhs.get());
+    }
+  }
+
+  optional_copy_base(optional_copy_base &&rhs) = default;
+  optional_copy_base &operator=(const optional_copy_base &rhs) = default;
+  optional_copy_base &operator=(optional_copy_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial move constructor
+// Unfortunately there's no way to achieve this in GCC < 5 AFAIK, since it
+// doesn't implement an analogue to std::is_trivially_move_constructible. We
+// have to make do with a non-trivial move constructor even if T is trivially
+// move constructible
+#ifndef TAO_OPTIONAL_GCC49
+template <typename T, bool = std::is_trivially_move_constructible<T>::value ||
+                             is_allocator_aware<T>::value>
+struct optional_move_base : optional_copy_base<T> {
+  using optional_copy_base<T>::optional_copy_base;
+};
+#else
+template <typename T, bool = false> struct optional_move_base;
+#endif
+template <typename T> struct optional_move_base<T, false> : optional_copy_base<T> {
+  using optional_copy_base<T>::optional_copy_base;
+
+  optional_move_base() = default;
+  optional_move_base(const optional_move_base &rhs) = default;
+
+  TAO_RESULT_CONSTEXPR20 optional_move_base(optional_move_base &&rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    if (rhs.has_value()) {
+      this->construct(std::move(rhs.get()));
     }
   }
   optional_move_base &operator=(const optional_move_base &rhs) = default;
@@ -289,7 +1411,8 @@ struct optional_copy_assign_base<T, false> : optional_move_base<T> {
   optional_copy_assign_base(const optional_copy_assign_base &rhs) = default;
 
   optional_copy_assign_base(optional_copy_assign_base &&rhs) = default;
-  optional_copy_assign_base &operator=(const optional_copy_assign_base &rhs) {
+  TAO_RESULT_CONSTEXPR20 optional_copy_assign_base &
+  operator=(const optional_copy_assign_base &rhs) {
     this->assign(rhs);
     return *this;
   }
@@ -325,7 +1448,7 @@ struct optional_move_assign_base<T, false> : optional_copy_assign_base<T> {
   optional_move_assign_base &
   operator=(const optional_move_assign_base &rhs) = default;
 
-  optional_move_assign_base &
+  TAO_RESULT_CONSTEXPR20 optional_move_assign_base &
   operator=(optional_move_assign_base &&rhs) noexcept(
       std::is_nothrow_move_constructible<T>::value
           &&std::is_nothrow_move_assignable<T>::value) {
@@ -437,7 +1560,7 @@ struct nullopt_t {
   constexpr explicit nullopt_t(do_not_use, do_not_use) noexcept {}
 };
 /// \brief Represents an empty optional
-/// \synopsis static constexpr nullopt_t nullopt;
+/// \synopsis inline constexpr nullopt_t nullopt;
 ///
 /// *Examples*:
 /// ```
@@ -445,7 +1568,7 @@ struct nullopt_t {
 /// void foo (tao::optional<int>);
 /// foo(tao::nullopt); //pass an empty optional
 /// ```
-static constexpr nullopt_t nullopt{nullopt_t::do_not_use{},
+TAO_RESULT_INLINE_VAR constexpr nullopt_t nullopt{nullopt_t::do_not_use{},
                                    nullopt_t::do_not_use{}};
 
 class bad_optional_access : public std::exception {
@@ -454,6 +1577,212 @@ public:
   const char *what() const noexcept { return "Optional has no value"; }
 };
 
+/// \brief Handler called instead of throwing when `value()` fails in an
+/// exception-free build (see `TAO_RESULT_NO_EXCEPTIONS`). It receives the
+/// message the exception would have carried and must not return; if it does,
+/// `std::abort()` is called.
+using failure_handler = void (*)(const char *what);
+
+/// \exclude
+namespace detail {
+inline std::atomic<failure_handler> &failure_handler_slot() noexcept {
+  static std::atomic<failure_handler> handler{nullptr};
+  return handler;
+}
+} // namespace detail
+
+/// \brief Installs `h` as the failure handler, e.g. to log and trap.
+/// Passing `nullptr` restores the default behaviour, `std::abort()`.
+/// \returns the previously installed handler.
+inline failure_handler set_failure_handler(failure_handler h) noexcept {
+  return detail::failure_handler_slot().exchange(h);
+}
+
+/// \returns the currently installed failure handler, or `nullptr`.
+inline failure_handler get_failure_handler() noexcept {
+  return detail::failure_handler_slot().load(std::memory_order_relaxed);
+}
+
+/// \exclude
+namespace detail {
+[[noreturn]] TAO_RESULT_COLD inline void report_failure(const char *what) noexcept {
+  if (failure_handler h = get_failure_handler()) {
+    h(what);
+  }
+  std::abort();
+}
+
+[[noreturn]] TAO_RESULT_COLD inline void throw_bad_optional_access() {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+  report_failure(bad_optional_access().what());
+#else
+  throw bad_optional_access();
+#endif
+}
+} // namespace detail
+
+#ifdef TAO_RESULT_INSTRUMENT
+
+// Number of distinct call sites that can be told apart; later ones are
+// folded into a single overflow entry. Must be a power of two.
+#ifndef TAO_RESULT_INSTRUMENT_SITES
+#define TAO_RESULT_INSTRUMENT_SITES 1024
+#endif
+
+// Number of counter shards per site. Threads are spread over the shards so
+// that hot sites hit by many threads do not bounce one cache line.
+#ifndef TAO_RESULT_INSTRUMENT_SHARDS
+#define TAO_RESULT_INSTRUMENT_SHARDS 8
+#endif
+
+namespace instrument {
+/// \brief The events counted per call site under `TAO_RESULT_INSTRUMENT`.
+enum class event : unsigned {
+  empty_construct,  ///< an optional constructed empty
+  error_construct,  ///< a result constructed with an error, from an
+                    ///< `unexpected` or with `unexpect`
+  bad_access,       ///< `value()` called on an empty optional or an error
+  or_else_fallback, ///< `or_else` ran its function
+};
+
+TAO_RESULT_INLINE_VAR constexpr std::size_t event_count = 4;
+} // namespace instrument
+
+/// \exclude
+namespace detail {
+
+struct alignas(64) instrument_shard {
+  std::atomic<unsigned long long> counts[instrument::event_count];
+};
+
+// A slot is claimed once, by the first thread recording for its site:
+// state goes 0 (free) -> 1 (being written) -> 2 (published)
+struct instrument_slot {
+  std::atomic<unsigned> state;
+  const char *file;
+  const char *function;
+  unsigned line;
+  instrument_shard shards[TAO_RESULT_INSTRUMENT_SHARDS];
+};
+
+struct instrument_table {
+  instrument_slot slots[TAO_RESULT_INSTRUMENT_SITES];
+  instrument_slot overflow;
+  std::atomic<unsigned> next_shard;
+};
+
+// Zero-initialized storage, so no guard is needed on the hot path
+inline instrument_table &instrument_registry() noexcept {
+  static instrument_table table;
+  return table;
+}
+
+inline unsigned instrument_shard_index() noexcept {
+  static thread_local unsigned index =
+      instrument_registry().next_shard.fetch_add(1, std::memory_order_relaxed) %
+      TAO_RESULT_INSTRUMENT_SHARDS;
+  return index;
+}
+
+// Open addressing keyed on the file name pointer and the line. Identical
+// file name literals are merged by the linker, so a site maps to one slot.
+inline instrument_slot &
+instrument_lookup(const std::source_location &site) noexcept {
+  instrument_table &t = instrument_registry();
+  const std::size_t mask = TAO_RESULT_INSTRUMENT_SITES - 1;
+  const auto file = reinterpret_cast<std::size_t>(site.file_name());
+  std::size_t h = (file >> 3) * 31 + site.line() * 0x9e3779b9u;
+  for (std::size_t probe = 0; probe <= mask; ++probe, ++h) {
+    instrument_slot &slot = t.slots[h & mask];
+    unsigned state = slot.state.load(std::memory_order_acquire);
+    if (state == 0 && slot.state.compare_exchange_strong(
+                          state, 1, std::memory_order_acquire)) {
+      slot.file = site.file_name();
+      slot.function = site.function_name();
+      slot.line = site.line();
+      slot.state.store(2, std::memory_order_release);
+      return slot;
+    }
+    while (state == 1) {
+      state = slot.state.load(std::memory_order_acquire);
+    }
+    if (slot.file == site.file_name() && slot.line == site.line()) {
+      return slot;
+    }
+  }
+  return t.overflow;
+}
+
+inline void instrument_record(const std::source_location &site,
+                              instrument::event ev) noexcept {
+  instrument_lookup(site)
+      .shards[instrument_shard_index()]
+      .counts[static_cast<unsigned>(ev)]
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+namespace instrument {
+
+/// \brief Counters of one call site, summed over all threads.
+struct site_counts {
+  const char *file;
+  const char *function;
+  unsigned line;
+  unsigned long long counts[event_count];
+
+  unsigned long long operator[](event ev) const noexcept {
+    return counts[static_cast<unsigned>(ev)];
+  }
+};
+
+/// \brief Calls `f(const site_counts &)` for every call site that recorded
+/// an event. Safe to call while other threads are recording; the counts are
+/// a relaxed snapshot. The overflow entry, if used, has a null `file`.
+template <typename F> void for_each_site(F &&f) {
+  detail::instrument_table &t = detail::instrument_registry();
+  auto visit = [&f](const detail::instrument_slot &slot, const char *file) {
+    site_counts c{file, slot.function, slot.line, {}};
+    bool any = false;
+    for (const auto &shard : slot.shards) {
+      for (std::size_t e = 0; e < event_count; ++e) {
+        c.counts[e] += shard.counts[e].load(std::memory_order_relaxed);
+        any = any || c.counts[e] != 0;
+      }
+    }
+    if (any) {
+      f(static_cast<const site_counts &>(c));
+    }
+  };
+  for (const auto &slot : t.slots) {
+    if (slot.state.load(std::memory_order_acquire) == 2) {
+      visit(slot, slot.file);
+    }
+  }
+  visit(t.overflow, nullptr);
+}
+
+/// \brief Sets every counter back to zero. Sites stay registered.
+inline void reset() noexcept {
+  detail::instrument_table &t = detail::instrument_registry();
+  auto clear = [](detail::instrument_slot &slot) {
+    for (auto &shard : slot.shards) {
+      for (auto &c : shard.counts) {
+        c.store(0, std::memory_order_relaxed);
+      }
+    }
+  };
+  for (auto &slot : t.slots) {
+    clear(slot);
+  }
+  clear(t.overflow);
+}
+
+} // namespace instrument
+
+#endif // TAO_RESULT_INSTRUMENT
+
 /// An optional object is an object that contains the storage for another
 /// object and manages the lifetime of this contained object, if any. The
 /// contained object may be initialized after the optional object has been
@@ -493,8 +1822,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -504,8 +1834,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -515,8 +1846,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -527,8 +1859,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<optional, result>(nullopt);
   }
 #endif
 #else
@@ -548,8 +1881,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -560,8 +1894,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -572,8 +1907,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -585,8 +1921,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<optional, result>(nullopt);
   }
 #endif
 #endif
@@ -680,8 +2017,9 @@ public:
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) &;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) & {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return *this;
 
     std::forward<F>(f)();
@@ -690,15 +2028,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) & {
-    return has_value() ? *this : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return std::forward<F>(f)();
   }
 
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) &&;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) && {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return std::move(*this);
 
     std::forward<F>(f)();
@@ -707,15 +2049,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) && {
-    return has_value() ? std::move(*this) : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::forward<F>(f)();
   }
 
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) const &;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const & {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return *this;
 
     std::forward<F>(f)();
@@ -724,15 +2070,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) const & {
-    return has_value() ? *this : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return std::forward<F>(f)();
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \exclude
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const && {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return std::move(*this);
 
     std::forward<F>(f)();
@@ -741,8 +2091,11 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const && {
-    return has_value() ? std::move(*this) : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::forward<F>(f)();
   }
 #endif
 
@@ -753,28 +2106,32 @@ public:
   /// and the value is returned. Otherwise `u` is returned.
   ///
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) & {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u);
   }
 
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) && {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u);
   }
 
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) const & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) const & {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) const && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) const && {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u);
   }
 #endif
 
@@ -789,8 +2146,9 @@ public:
   /// \synopsis template <typename F, typename U>\nauto map_or_else(F &&f, U&& u) &;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u)();
   }
 
   /// \group map_or_else
@@ -798,8 +2156,9 @@ public:
   /// &&;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u)();
   }
 
   /// \group map_or_else
@@ -807,8 +2166,9 @@ public:
   /// const &;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) const & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u)();
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -817,8 +2177,9 @@ public:
   /// const &&;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) const && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u)();
   }
 #endif
 
@@ -826,71 +2187,89 @@ public:
   template <typename U>
   constexpr optional<typename std::decay<U>::type> conjunction(U&& u) const {
     using result = optional<detail::decay_t<U>>;
-    return has_value() ? result{u} : result{nullopt};
+    if (detail::engaged(*this))
+      return result{u};
+    return result{nullopt};
   }
 
   /// \returns `rhs` if `*this` is empty, otherwise the current value.
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) & {
-    return has_value() ? *this : rhs;
+    if (detail::engaged(*this))
+      return *this;
+    return rhs;
   }
 
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) const & {
-    return has_value() ? *this : rhs;
+    if (detail::engaged(*this))
+      return *this;
+    return rhs;
   }
 
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) && {
-    return has_value() ? std::move(*this) : rhs;
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return rhs;
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) const && {
-    return has_value() ? std::move(*this) : rhs;
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return rhs;
   }
 #endif
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) & {
-    return has_value() ? *this : std::move(rhs);
+    if (detail::engaged(*this))
+      return *this;
+    return std::move(rhs);
   }
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) const & {
-    return has_value() ? *this : std::move(rhs);
+    if (detail::engaged(*this))
+      return *this;
+    return std::move(rhs);
   }
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) && {
-    return has_value() ? std::move(*this) : std::move(rhs);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::move(rhs);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) const && {
-    return has_value() ? std::move(*this) : std::move(rhs);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::move(rhs);
   }
 #endif
 
   /// Takes the value out of the optional, leaving it empty
   /// \group take
-  optional take() & {
+  TAO_RESULT_CONSTEXPR20 optional take() & {
     optional ret = *this;
     reset();
     return ret;
   }
 
   /// \group take
-  optional take() const & {
+  TAO_RESULT_CONSTEXPR20 optional take() const & {
     optional ret = *this;
     reset();
     return ret;
   }
 
   /// \group take
-  optional take() && {
+  TAO_RESULT_CONSTEXPR20 optional take() && {
     optional ret = std::move(*this);
     reset();
     return ret;
@@ -898,7 +2277,7 @@ public:
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group take
-  optional take() const && {
+  TAO_RESULT_CONSTEXPR20 optional take() const && {
     optional ret = std::move(*this);
     reset();
     return ret;
@@ -909,10 +2288,18 @@ public:
 
   /// Constructs an optional that does not contain a value.
   /// \group ctor_empty
+#ifdef TAO_RESULT_INSTRUMENT
+  constexpr optional(TAO_RESULT_SITE_ONLY_PARAM) noexcept {
+    TAO_RESULT_RECORD(true, empty_construct);
+  }
+#else
   constexpr optional() noexcept = default;
+#endif
 
   /// \group ctor_empty
-  constexpr optional(nullopt_t) noexcept {}
+  constexpr optional(nullopt_t TAO_RESULT_SITE_PARAM) noexcept {
+    TAO_RESULT_RECORD(true, empty_construct);
+  }
 
   /// Copy constructor
   ///
@@ -946,36 +2333,136 @@ public:
     this->construct(il, std::forward<Args>(args)...);
   }
 
-  /// Constructs the stored value with `u`.
-  /// \synopsis template <typename U=T> constexpr optional(U&& u);
-  template <
-      typename U = T,
-      detail::enable_if_t<std::is_convertible<U&&, T>::value> * = nullptr,
-      detail::enable_forward_value<T, U> * = nullptr>
-  constexpr optional(U&& u) : base(in_place, std::forward<U>(u)) {}
-
   /// \exclude
-  template <
+  template <typename F, typename... Args>
+  constexpr optional(detail::in_place_invoke_t tag, F &&f, Args &&... args)
+      : base(tag, std::forward<F>(f), std::forward<Args>(args)...) {}
+
+  /// Uses-allocator construction: the value, if any, is constructed with
+  /// `a` after `std::allocator_arg`, with `a` as the last argument, or
+  /// without it, depending on how `T` takes an allocator. When `T` is
+  /// allocator-aware, as the `std::pmr` containers are, an empty optional
+  /// keeps `a` (converted to `T::allocator_type`) for the value it is later
+  /// assigned or emplaced, so a whole graph of optionals can live in one
+  /// arena.
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 optional(std::allocator_arg_t,
+                                  const Alloc &a) noexcept
+      : base(std::allocator_arg, a) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 optional(std::allocator_arg_t, const Alloc &a,
+                                  nullopt_t) noexcept
+      : base(std::allocator_arg, a) {}
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename... Args>\noptional(std::allocator_arg_t, const Alloc &a, in_place_t, Args&&... args);
+  template <typename Alloc, typename... Args>
+  TAO_RESULT_CONSTEXPR20 optional(
+      std::allocator_arg_t, const Alloc &a,
+      detail::enable_if_t<std::is_constructible<T, Args...>::value, in_place_t>,
+      Args &&... args)
+      : base(std::allocator_arg, a) {
+    this->construct_with_allocator(a, std::forward<Args>(args)...);
+  }
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename U=T>\noptional(std::allocator_arg_t, const Alloc &a, U&& u);
+  template <typename Alloc, typename U = T,
+            detail::enable_forward_value<T, U> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 optional(std::allocator_arg_t, const Alloc &a, U &&u)
+      : base(std::allocator_arg, a) {
+    this->construct_with_allocator(a, std::forward<U>(u));
+  }
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 optional(std::allocator_arg_t, const Alloc &a,
+                                  const optional &rhs)
+      : base(std::allocator_arg, a) {
+    if (rhs.has_value()) {
+      this->construct_with_allocator(a, *rhs);
+    }
+  }
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 optional(std::allocator_arg_t, const Alloc &a,
+                                  optional &&rhs)
+      : base(std::allocator_arg, a) {
+    if (rhs.has_value()) {
+      this->construct_with_allocator(a, std::move(*rhs));
+    }
+  }
+
+#ifdef TAO_RESULT_CONCEPTS
+  /// Constructs the stored value with `u`.
+  /// \synopsis template <typename U=T> constexpr optional(U&& u);
+  template <typename U = T>
+    requires detail::constructible_forward_value<T, U>
+  constexpr explicit(!std::is_convertible<U&&, T>::value)
+      optional(U&& u) : base(in_place, std::forward<U>(u)) {}
+#else
+  /// Constructs the stored value with `u`.
+  /// \synopsis template <typename U=T> constexpr optional(U&& u);
+  template <
+      typename U = T,
+      detail::enable_if_t<std::is_convertible<U&&, T>::value> * = nullptr,
+      detail::enable_forward_value<T, U> * = nullptr>
+  constexpr optional(U&& u) : base(in_place, std::forward<U>(u)) {}
+
+  /// \exclude
+  template <
       typename U = T,
       detail::enable_if_t<!std::is_convertible<U&&, T>::value> * = nullptr,
       detail::enable_forward_value<T, U> * = nullptr>
   constexpr explicit optional(U&& u) : base(in_place, std::forward<U>(u)) {}
+#endif
+
+#ifdef TAO_RESULT_CONCEPTS
+  /// Converting copy constructor.
+  /// \synopsis template <typename U> optional(const optional<U>& rhs);
+  template <typename U>
+    requires detail::constructible_from_other<T, U, const U &>
+  TAO_RESULT_CONSTEXPR20 explicit(!std::is_convertible<const U &, T>::value)
+      optional(const optional<U>& rhs) {
+    if (rhs.has_value()) {
+      this->construct(*rhs);
+    }
+  }
 
+  /// Converting move constructor.
+  /// \synopsis template <typename U> optional(optional<U>&& rhs);
+  template <typename U>
+    requires detail::constructible_from_other<T, U, U &&>
+  TAO_RESULT_CONSTEXPR20 explicit(!std::is_convertible<U &&, T>::value)
+      optional(optional<U>&& rhs) {
+    if (rhs.has_value()) {
+      this->construct(std::move(*rhs));
+    }
+  }
+#else
   /// Converting copy constructor.
   /// \synopsis template <typename U> optional(const optional<U>& rhs);
   template <
       typename U, detail::enable_from_other<T, U, const U &> * = nullptr,
       detail::enable_if_t<std::is_convertible<const U &, T>::value> * = nullptr>
-  optional(const optional<U>& rhs) {
-    this->construct(*rhs);
+  TAO_RESULT_CONSTEXPR20 optional(const optional<U>& rhs) {
+    if (rhs.has_value()) {
+      this->construct(*rhs);
+    }
   }
 
   /// \exclude
   template <typename U, detail::enable_from_other<T, U, const U &> * = nullptr,
             detail::enable_if_t<!std::is_convertible<const U &, T>::value> * =
                 nullptr>
-  explicit optional(const optional<U>& rhs) {
-    this->construct(*rhs);
+  TAO_RESULT_CONSTEXPR20 explicit optional(const optional<U>& rhs) {
+    if (rhs.has_value()) {
+      this->construct(*rhs);
+    }
   }
 
   /// Converting move constructor.
@@ -983,28 +2470,79 @@ public:
   template <
       typename U, detail::enable_from_other<T, U, U&&> * = nullptr,
       detail::enable_if_t<std::is_convertible<U&& , T>::value> * = nullptr>
-  optional(optional<U>&& rhs) {
-    this->construct(std::move(*rhs));
+  TAO_RESULT_CONSTEXPR20 optional(optional<U>&& rhs) {
+    if (rhs.has_value()) {
+      this->construct(std::move(*rhs));
+    }
   }
 
   /// \exclude
   template <
       typename U, detail::enable_from_other<T, U, U&&> * = nullptr,
       detail::enable_if_t<!std::is_convertible<U&& , T>::value> * = nullptr>
-  explicit optional(optional<U>&& rhs) {
-    this->construct(std::move(*rhs));
+  TAO_RESULT_CONSTEXPR20 explicit optional(optional<U>&& rhs) {
+    if (rhs.has_value()) {
+      this->construct(std::move(*rhs));
+    }
+  }
+#endif
+
+#ifdef TAO_RESULT_HAS_STD_OPTIONAL
+  /// Constructs from a `std::optional`, copying its value if there is one.
+  /// \group ctor_std
+  /// \synopsis template <typename U> optional(const std::optional<U>& rhs);
+  template <typename U,
+            detail::enable_from_std_optional<T, U, const U &> * = nullptr,
+            detail::enable_if_t<std::is_convertible<const U &, T>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 optional(const std::optional<U> &rhs) {
+    if (rhs.has_value()) {
+      this->construct(*rhs);
+    }
   }
 
+  /// \exclude
+  template <typename U,
+            detail::enable_from_std_optional<T, U, const U &> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<const U &, T>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit optional(const std::optional<U> &rhs) {
+    if (rhs.has_value()) {
+      this->construct(*rhs);
+    }
+  }
+
+  /// Constructs from a `std::optional`, moving its value if there is one.
+  /// The source keeps its (moved-from) value, as with `optional(optional<U>&&)`.
+  /// \group ctor_std
+  /// \synopsis template <typename U> optional(std::optional<U>&& rhs);
+  template <typename U, detail::enable_from_std_optional<T, U, U &&> * = nullptr,
+            detail::enable_if_t<std::is_convertible<U &&, T>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 optional(std::optional<U> &&rhs) {
+    if (rhs.has_value()) {
+      this->construct(std::move(*rhs));
+    }
+  }
+
+  /// \exclude
+  template <typename U, detail::enable_from_std_optional<T, U, U &&> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<U &&, T>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit optional(std::optional<U> &&rhs) {
+    if (rhs.has_value()) {
+      this->construct(std::move(*rhs));
+    }
+  }
+#endif
+
   /// Destroys the stored value if there is one.
   ~optional() = default;
 
   /// Assignment to empty.
   ///
   /// Destroys the current value if there is one.
-  optional &operator=(nullopt_t) noexcept {
-    if (has_value()) {
-      this->value_.~T();
-      this->has_value_ = false;
+  TAO_RESULT_CONSTEXPR20 optional &operator=(nullopt_t) noexcept {
+    if (detail::engaged(*this)) {
+      this->hard_reset();
     }
 
     return *this;
@@ -1025,9 +2563,14 @@ public:
   /// Assigns the stored value from `u`, destroying the old value if there was
   /// one.
   /// \synopsis optional &operator=(U&& u);
+#ifdef TAO_RESULT_CONCEPTS
+  template <typename U = T>
+    requires detail::assignable_forward<T, U>
+#else
   template <typename U = T, detail::enable_assign_forward<T, U> * = nullptr>
-  optional &operator=(U&& u) {
-    if (has_value()) {
+#endif
+  TAO_RESULT_CONSTEXPR20 optional &operator=(U&& u) {
+    if (detail::engaged(*this)) {
       this->value_ = std::forward<U>(u);
     } else {
       this->construct(std::forward<U>(u));
@@ -1041,18 +2584,21 @@ public:
   /// Copies the value from `rhs` if there is one. Otherwise resets the stored
   /// value in `*this`.
   /// \synopsis optional &operator=(const optional<U>&  rhs);
+#ifdef TAO_RESULT_CONCEPTS
+  template <typename U>
+    requires detail::assignable_from_other<T, U, const U &>
+#else
   template <typename U,
             detail::enable_assign_from_other<T, U, const U &> * = nullptr>
-  optional &operator=(const optional<U>& rhs) {
-    if (has_value()) {
+#endif
+  TAO_RESULT_CONSTEXPR20 optional &operator=(const optional<U>& rhs) {
+    if (detail::engaged(*this)) {
       if (rhs.has_value()) {
         this->value_ = *rhs;
       } else {
         this->hard_reset();
       }
-    }
-
-    if (rhs.has_value()) {
+    } else if (rhs.has_value()) {
       this->construct(*rhs);
     }
 
@@ -1065,17 +2611,20 @@ public:
   /// Moves the value from `rhs` if there is one. Otherwise resets the stored
   /// value in `*this`.
   /// \synopsis optional &operator=(optional<U>&&  rhs);
+#ifdef TAO_RESULT_CONCEPTS
+  template <typename U>
+    requires detail::assignable_from_other<T, U, U>
+#else
   template <typename U, detail::enable_assign_from_other<T, U, U> * = nullptr>
-  optional &operator=(optional<U>&& rhs) {
-    if (has_value()) {
+#endif
+  TAO_RESULT_CONSTEXPR20 optional &operator=(optional<U>&& rhs) {
+    if (detail::engaged(*this)) {
       if (rhs.has_value()) {
         this->value_ = std::move(*rhs);
       } else {
         this->hard_reset();
       }
-    }
-
-    if (rhs.has_value()) {
+    } else if (rhs.has_value()) {
       this->construct(std::move(*rhs));
     }
 
@@ -1084,26 +2633,86 @@ public:
 
   /// Constructs the value in-place, destroying the current one if there is
   /// one.
+  ///
+  /// If the constructor throws, the optional is left empty.
   /// \group emplace
-  template <typename... Args> T &emplace(Args &&... args) {
+  template <typename... Args>
+  TAO_RESULT_CONSTEXPR20 T &
+  emplace(Args &&... args) noexcept(
+      std::is_nothrow_constructible<T, Args &&...>::value) {
     static_assert(std::is_constructible<T, Args &&...>::value,
                   "T must be constructible with Args");
 
-    *this = nullopt;
-    this->construct(std::forward<Args>(args)...);
-    return value();
+    this->replace(std::forward<Args>(args)...);
+    return this->get();
   }
 
   /// \group emplace
   /// \synopsis template <typename U, typename... Args>\nT& emplace(std::initializer_list<U> il, Args &&... args);
   template <typename U, typename... Args>
-  detail::enable_if_t<
+  TAO_RESULT_CONSTEXPR20 detail::enable_if_t<
       std::is_constructible<T, std::initializer_list<U>&, Args &&...>::value,
       T &>
-  emplace(std::initializer_list<U> il, Args &&... args) {
-    *this = nullopt;
-    this->construct(il, std::forward<Args>(args)...);
-    return value();    
+  emplace(std::initializer_list<U> il, Args &&... args) noexcept(
+      std::is_nothrow_constructible<T, std::initializer_list<U> &,
+                                    Args &&...>::value) {
+    this->replace(il, std::forward<Args>(args)...);
+    return this->get();
+  }
+
+  /// \group emplace
+  /// Uses-allocator construction of the new value with `a`, see
+  /// `optional(std::allocator_arg_t, const Alloc&)`.
+  /// \synopsis template <typename Alloc, typename... Args>\nT& emplace(std::allocator_arg_t, const Alloc &a, Args &&... args);
+  template <typename Alloc, typename... Args>
+  TAO_RESULT_CONSTEXPR20 T &emplace(std::allocator_arg_t, Alloc &&a,
+                                    Args &&... args) {
+    if (detail::engaged(*this)) {
+      this->hard_reset();
+    }
+    this->construct_with_allocator(a, std::forward<Args>(args)...);
+    return this->get();
+  }
+
+  /// \returns the allocator of the value, or the one an empty optional
+  /// keeps for the next value
+  /// \requires `T` is allocator-aware: it has a stateful `allocator_type`
+  /// and a `get_allocator()`, as the `std::pmr` containers do
+  /// \synopsis typename T::allocator_type get_allocator() const noexcept;
+  template <typename U = T,
+            detail::enable_if_t<detail::is_allocator_aware<U>::value> * =
+                nullptr>
+  typename U::allocator_type get_allocator() const noexcept {
+    return base::get_allocator();
+  }
+
+  /// Constructs the value from a factory that reports failure through a
+  /// result instead of throwing, e.g. `static result<T, E> open(...)`.
+  ///
+  /// On success the current value, if any, is destroyed and the one returned
+  /// by `f` is moved in. On failure `*this` is left untouched.
+  ///
+  /// \requires `std::invoke(std::forward<F>(f), std::forward<Args>(args)...)`
+  /// returns a `result<U, E>` with `T` constructible from `U&&`.
+  /// \returns a reference to the new value, or the error returned by `f`
+  /// \synopsis template <typename F, typename... Args>\nresult<std::reference_wrapper<T>, E> try_emplace(F &&f, Args &&... args);
+  template <typename F, typename... Args,
+            typename Res = detail::invoke_result_t<F, Args &&...>,
+            typename Ret = result<std::reference_wrapper<T>,
+                                  typename detail::decay_t<Res>::error_type>>
+  TAO_RESULT_CONSTEXPR20 Ret try_emplace(F &&f, Args &&... args) {
+    static_assert(detail::is_result<Res>::value, "F must return a result");
+    static_assert(
+        std::is_constructible<T, typename std::add_rvalue_reference<
+                                     typename detail::decay_t<Res>::value_type>::
+                                     type>::value,
+        "T must be constructible from the value returned by F");
+
+    auto r = detail::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    if (!r.has_value())
+      return detail::forward_error<Ret>(std::move(r));
+    this->replace(std::move(*r));
+    return Ret(std::ref(this->get()));
   }
 
   /// Swaps this optional with the other.
@@ -1112,20 +2721,29 @@ public:
   /// If both have a value, the values are swapped.
   /// If one has a value, it is moved to the other and the movee is left
   /// valueless.
-  void
-  swap(optional &rhs) noexcept(std::is_nothrow_move_constructible<T>::value
-                                   &&detail::is_nothrow_swappable<T>::value) {
-    if (has_value()) {
+  /// When `T` is trivially relocatable (see `is_trivially_relocatable`), the
+  /// two storages are swapped byte for byte instead, without calling `T`'s
+  /// move constructor, swap or destructor.
+  TAO_RESULT_CONSTEXPR20 void
+  swap(optional &rhs) noexcept(is_trivially_relocatable<T>::value ||
+                               (std::is_nothrow_move_constructible<T>::value &&
+                                detail::is_nothrow_swappable<T>::value)) {
+    if (is_trivially_relocatable<T>::value &&
+        !detail::is_constant_evaluated()) {
+      this->swap_storage(rhs);
+      return;
+    }
+    if (detail::engaged(*this)) {
       if (rhs.has_value()) {
         using std::swap;
         swap(**this, *rhs);
       } else {
-        new (std::addressof(rhs.value_)) T(std::move(this->value_));
-        this->value_.T::~T();
+        rhs.construct(std::move(this->value_));
+        this->hard_reset();
       }
     } else if (rhs.has_value()) {
-      new (std::addressof(this->value_)) T(std::move(rhs.value_));
-      rhs.value_.T::~T();
+      this->construct(std::move(rhs.value_));
+      rhs.hard_reset();
     }
   }
 
@@ -1165,42 +2783,71 @@ public:
 
   /// \returns whether or not the optional has a value
   /// \group has_value
-  constexpr bool has_value() const noexcept { return this->has_value_; }
+  constexpr bool has_value() const noexcept { return base::has_value(); }
 
   /// \group has_value
   constexpr explicit operator bool() const noexcept {
-    return this->has_value_;
+    return base::has_value();
+  }
+
+#ifdef TAO_RESULT_HAS_STD_OPTIONAL
+  /// Converts to a `std::optional<T>` holding a copy of the value, if any.
+  /// \group to_std
+  /// \synopsis constexpr operator std::optional<T>() const &;
+  template <typename U = T,
+            detail::enable_if_t<std::is_copy_constructible<U>::value> * = nullptr>
+  constexpr operator std::optional<T>() const & {
+    if (detail::engaged(*this))
+      return std::optional<T>(std::in_place, this->get());
+    return std::nullopt;
   }
 
+  /// Converts to a `std::optional<T>`, moving the value in if there is one.
+  /// \group to_std
+  /// \synopsis constexpr operator std::optional<T>() &&;
+  template <typename U = T,
+            detail::enable_if_t<std::is_move_constructible<U>::value> * = nullptr>
+  constexpr operator std::optional<T>() && {
+    if (detail::engaged(*this))
+      return std::optional<T>(std::in_place, std::move(this->get()));
+    return std::nullopt;
+  }
+#endif
+
   /// \returns the contained value if there is one, otherwise throws
-  /// [bad_optional_access]
+  /// [bad_optional_access] (or calls the failure handler when built with
+  /// `TAO_RESULT_NO_EXCEPTIONS`)
   /// \group value
   /// \synopsis constexpr T &value();
-  constexpr T &value() & {
-    if (has_value())
+  constexpr T &value(TAO_RESULT_SITE_ONLY_PARAM) & {
+    if (detail::engaged(*this))
       return this->value_;
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
   /// \group value
   /// \synopsis constexpr const T &value() const;
-  constexpr const T &value() const & {
-    if (has_value())
+  constexpr const T &value(TAO_RESULT_SITE_ONLY_PARAM) const & {
+    if (detail::engaged(*this))
       return this->value_;
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
   /// \exclude
-  constexpr T &&value() && {
-    if (has_value())
+  constexpr T &&value(TAO_RESULT_SITE_ONLY_PARAM) && {
+    if (detail::engaged(*this))
       return std::move(this->value_);
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \exclude
-  constexpr const T &&value() const && {
-    if (has_value())
+  constexpr const T &&value(TAO_RESULT_SITE_ONLY_PARAM) const && {
+    if (detail::engaged(*this))
       return std::move(this->value_);
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
 #endif
 
@@ -1210,7 +2857,9 @@ public:
     static_assert(std::is_copy_constructible<T>::value &&
                       std::is_convertible<U&&, T>::value,
                   "T must be copy constructible and convertible from U");
-    return has_value() ? **this : static_cast<T>(std::forward<U>(u));
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(std::forward<U>(u));
   }
 
   /// \group value_or
@@ -1218,14 +2867,40 @@ public:
     static_assert(std::is_move_constructible<T>::value &&
                       std::is_convertible<U&&, T>::value,
                   "T must be move constructible and convertible from U");
-    return has_value() ? **this : static_cast<T>(std::forward<U>(u));
+    if (detail::engaged(*this))
+      return std::move(**this);
+    return static_cast<T>(std::forward<U>(u));
+  }
+
+  /// \returns the stored value if there is one, otherwise the result of
+  /// `std::forward<F>(f)()`. Unlike `value_or`, the fallback is only
+  /// materialized when `*this` is empty.
+  /// \group value_or_else
+  template <typename F> constexpr T value_or_else(F &&f) const & {
+    static_assert(std::is_copy_constructible<T>::value &&
+                      std::is_convertible<detail::invoke_result_t<F>, T>::value,
+                  "T must be copy constructible and convertible from the "
+                  "result of F");
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(detail::invoke(std::forward<F>(f)));
+  }
+
+  /// \group value_or_else
+  template <typename F> constexpr T value_or_else(F &&f) && {
+    static_assert(std::is_move_constructible<T>::value &&
+                      std::is_convertible<detail::invoke_result_t<F>, T>::value,
+                  "T must be move constructible and convertible from the "
+                  "result of F");
+    if (detail::engaged(*this))
+      return std::move(**this);
+    return static_cast<T>(detail::invoke(std::forward<F>(f)));
   }
 
   /// Destroys the stored value if one exists, making the optional empty
-  void reset() noexcept {
-    if (has_value()) {
-      this->value_.~T();
-      this->has_value_ = false;
+  TAO_RESULT_CONSTEXPR20 void reset() noexcept {
+    if (detail::engaged(*this)) {
+      this->hard_reset();
     }
   }
 }; // namespace tao
@@ -1406,6 +3081,7 @@ inline constexpr bool operator>=(const U &lhs, const optional<T>& rhs) {
 template <typename T,
           detail::enable_if_t<std::is_move_constructible<T>::value> * = nullptr,
           detail::enable_if_t<detail::is_swappable<T>::value> * = nullptr>
+TAO_RESULT_CONSTEXPR20
 void swap(optional<T>& lhs,
           optional<T>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
   return lhs.swap(rhs);
@@ -1445,9 +3121,10 @@ template <typename Opt, typename F,
                                               *std::declval<Opt>())),
           detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
 constexpr auto optional_map_impl(Opt &&opt, F &&f) {
-  return opt.has_value()
-             ? detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt))
-             : optional<Ret>(nullopt);
+  if (detail::engaged(opt))
+    return optional<Ret>(
+        detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt)));
+  return detail::make_off_path<Opt, optional<Ret>>(nullopt);
 }
 
 template <typename Opt, typename F,
@@ -1455,12 +3132,12 @@ template <typename Opt, typename F,
                                               *std::declval<Opt>())),
           detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
 auto optional_map_impl(Opt &&opt, F &&f) {
-  if (opt.has_value()) {
+  if (detail::engaged(opt)) {
     detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt));
     return make_optional(monostate{});
   }
 
-  return optional<monostate>(nullopt);
+  return detail::make_off_path<Opt, optional<monostate>>(nullopt);
 }
 #else
 template <typename Opt, typename F,
@@ -1469,9 +3146,9 @@ template <typename Opt, typename F,
           detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
 
 constexpr auto optional_map_impl(Opt &&opt, F &&f) -> optional<Ret> {
-  return opt.has_value()
-             ? detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt))
-             : optional<Ret>(nullopt);
+  if (detail::engaged(opt))
+    return detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt));
+  return detail::make_off_path<Opt, optional<Ret>>(nullopt);
 }
 
 template <typename Opt, typename F,
@@ -1480,7 +3157,7 @@ template <typename Opt, typename F,
           detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
 
 auto optional_map_impl(Opt &&opt, F &&f) -> optional<monostate> {
-  if (opt.has_value()) {
+  if (detail::engaged(opt)) {
     detail::invoke(std::forward<F>(f), *std::forward<Opt>(opt));
     return monostate{};
   }
@@ -1535,8 +3212,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -1546,8 +3224,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -1557,8 +3236,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -1569,8 +3249,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 #endif
 #else
@@ -1590,8 +3271,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -1602,8 +3284,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
   /// \group and_then
@@ -1614,8 +3297,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -1627,8 +3311,9 @@ public:
     static_assert(detail::is_optional<result>::value,
                   "F must return an optional");
 
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : result(nullopt);
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<optional, result>(nullopt);
   }
 #endif
 #endif
@@ -1721,8 +3406,9 @@ public:
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) &;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) & {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return *this;
 
     std::forward<F>(f)();
@@ -1731,15 +3417,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) & {
-    return has_value() ? *this : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return std::forward<F>(f)();
   }
 
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) &&;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) && {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return std::move(*this);
 
     std::forward<F>(f)();
@@ -1748,15 +3438,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) && {
-    return has_value() ? std::move(*this) : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::forward<F>(f)();
   }
 
   /// \group or_else
   /// \synopsis template <typename F> optional<T> or_else (F &&f) const &;
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const & {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return *this;
 
     std::forward<F>(f)();
@@ -1765,15 +3459,19 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> constexpr or_else(F &&f) const & {
-    return has_value() ? *this : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return std::forward<F>(f)();
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \exclude
   template <typename F, detail::enable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const && {
-    if (has_value())
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
       return std::move(*this);
 
     std::forward<F>(f)();
@@ -1782,8 +3480,11 @@ public:
 
   /// \exclude
   template <typename F, detail::disable_if_ret_void<F> * = nullptr>
-  optional<T> or_else(F &&f) const && {
-    return has_value() ? std::move(*this) : std::forward<F>(f)();
+  optional<T> constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::forward<F>(f)();
   }
 #endif
 
@@ -1794,28 +3495,32 @@ public:
   /// and the value is returned. Otherwise `u` is returned.
   ///
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) & {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u);
   }
 
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) && {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u);
   }
 
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) const & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) const & {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group map_or
-  template <typename F, typename U> U map_or(F &&f, U&& u) const && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u);
+  template <typename F, typename U> constexpr U map_or(F &&f, U&& u) const && {
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u);
   }
 #endif
 
@@ -1830,8 +3535,9 @@ public:
   /// \synopsis template <typename F, typename U>\nauto map_or_else(F &&f, U&& u) &;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u)();
   }
 
   /// \group map_or_else
@@ -1839,8 +3545,9 @@ public:
   /// &&;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u)();
   }
 
   /// \group map_or_else
@@ -1848,8 +3555,9 @@ public:
   /// const &;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) const & {
-    return has_value() ? detail::invoke(std::forward<F>(f), **this)
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return std::forward<U>(u)();
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
@@ -1858,8 +3566,9 @@ public:
   /// const &&;
   template <typename F, typename U>
   detail::invoke_result_t<U> map_or_else(F &&f, U&& u) const && {
-    return has_value() ? detail::invoke(std::forward<F>(f), std::move(**this))
-                       : std::forward<U>(u)();
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return std::forward<U>(u)();
   }
 #endif
 
@@ -1867,71 +3576,89 @@ public:
   template <typename U>
   constexpr optional<typename std::decay<U>::type> conjunction(U&& u) const {
     using result = optional<detail::decay_t<U>>;
-    return has_value() ? result{u} : result{nullopt};
+    if (detail::engaged(*this))
+      return result{u};
+    return result{nullopt};
   }
 
   /// \returns `rhs` if `*this` is empty, otherwise the current value.
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) & {
-    return has_value() ? *this : rhs;
+    if (detail::engaged(*this))
+      return *this;
+    return rhs;
   }
 
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) const & {
-    return has_value() ? *this : rhs;
+    if (detail::engaged(*this))
+      return *this;
+    return rhs;
   }
 
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) && {
-    return has_value() ? std::move(*this) : rhs;
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return rhs;
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group disjunction
   constexpr optional disjunction(const optional &rhs) const && {
-    return has_value() ? std::move(*this) : rhs;
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return rhs;
   }
 #endif
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) & {
-    return has_value() ? *this : std::move(rhs);
+    if (detail::engaged(*this))
+      return *this;
+    return std::move(rhs);
   }
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) const & {
-    return has_value() ? *this : std::move(rhs);
+    if (detail::engaged(*this))
+      return *this;
+    return std::move(rhs);
   }
 
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) && {
-    return has_value() ? std::move(*this) : std::move(rhs);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::move(rhs);
   }
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group disjunction
   constexpr optional disjunction(optional &&rhs) const && {
-    return has_value() ? std::move(*this) : std::move(rhs);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return std::move(rhs);
   }
 #endif
 
   /// Takes the value out of the optional, leaving it empty
   /// \group take
-  optional take() & {
+  constexpr optional take() & {
     optional ret = *this;
     reset();
     return ret;
   }
 
   /// \group take
-  optional take() const & {
+  constexpr optional take() const & {
     optional ret = *this;
     reset();
     return ret;
   }
 
   /// \group take
-  optional take() && {
+  constexpr optional take() && {
     optional ret = std::move(*this);
     reset();
     return ret;
@@ -1939,7 +3666,7 @@ public:
 
 #ifndef TAO_OPTIONAL_NO_CONSTRR
   /// \group take
-  optional take() const && {
+  constexpr optional take() const && {
     optional ret = std::move(*this);
     reset();
     return ret;
@@ -1950,10 +3677,15 @@ public:
 
   /// Constructs an optional that does not contain a value.
   /// \group ctor_empty
-  constexpr optional() noexcept : value_(nullptr) {}
+  constexpr optional(TAO_RESULT_SITE_ONLY_PARAM) noexcept : value_(nullptr) {
+    TAO_RESULT_RECORD(true, empty_construct);
+  }
 
   /// \group ctor_empty
-  constexpr optional(nullopt_t) noexcept : value_(nullptr) {}
+  constexpr optional(nullopt_t TAO_RESULT_SITE_PARAM) noexcept
+      : value_(nullptr) {
+    TAO_RESULT_RECORD(true, empty_construct);
+  }
 
   /// Copy constructor
   ///
@@ -1986,7 +3718,7 @@ public:
   /// Assignment to empty.
   ///
   /// Destroys the current value if there is one.
-  optional &operator=(nullopt_t) noexcept {
+  constexpr optional &operator=(nullopt_t) noexcept {
     value_ = nullptr;
     return *this;
   }
@@ -2004,7 +3736,7 @@ public:
   template <typename U = T,
             detail::enable_if_t<!detail::is_optional<detail::decay_t<U>>::value>
                 * = nullptr>
-  optional &operator=(U&& u) {
+  constexpr optional &operator=(U&& u) {
     static_assert(std::is_lvalue_reference<U>::value, "U must be an lvalue");
     value_ = std::addressof(u);
     return *this;
@@ -2014,21 +3746,20 @@ public:
   ///
   /// Rebinds this optional to the referee of `rhs` if there is one. Otherwise
   /// resets the stored value in `*this`.
-  template <typename U> optional &operator=(const optional<U>& rhs) {
+  template <typename U> constexpr optional &operator=(const optional<U>& rhs) {
     value_ = std::addressof(rhs.value());
     return *this;
   }
 
-  /// Constructs the value in-place, destroying the current one if there is
-  /// one.
+  /// Rebinds this optional to `u`, as assigning it does.
   ///
-  /// \group emplace
-  template <typename... Args> T &emplace(Args &&... args) noexcept {
-    static_assert(std::is_constructible<T, Args &&...>::value,
-                  "T must be constructible with Args");
-
-    *this = nullopt;
-    this->construct(std::forward<Args>(args)...);
+  /// \requires `U` must be an lvalue reference.
+  /// \returns the new referee
+  /// \synopsis template <typename U>\nT &emplace(U&& u);
+  template <typename U> constexpr T &emplace(U &&u) noexcept {
+    static_assert(std::is_lvalue_reference<U>::value, "U must be an lvalue");
+    value_ = std::addressof(u);
+    return *value_;
   }
 
   /// Swaps this optional with the other.
@@ -2037,7 +3768,9 @@ public:
   /// If both have a value, the values are swapped.
   /// If one has a value, it is moved to the other and the movee is left
   /// valueless.
-  void swap(optional &rhs) noexcept { std::swap(value_, rhs.value_); }
+  TAO_RESULT_CONSTEXPR20 void swap(optional &rhs) noexcept {
+    std::swap(value_, rhs.value_);
+  }
 
   /// \returns a pointer to the stored value
   /// \requires a value is stored
@@ -2069,20 +3802,23 @@ public:
   }
 
   /// \returns the contained value if there is one, otherwise throws
-  /// [bad_optional_access]
+  /// [bad_optional_access] (or calls the failure handler when built with
+  /// `TAO_RESULT_NO_EXCEPTIONS`)
   /// \group value
   /// synopsis constexpr T &value();
-  constexpr T &value() {
-    if (has_value())
+  constexpr T &value(TAO_RESULT_SITE_ONLY_PARAM) {
+    if (detail::engaged(*this))
       return *value_;
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
   /// \group value
   /// \synopsis constexpr const T &value() const;
-  constexpr const T &value() const {
-    if (has_value())
+  constexpr const T &value(TAO_RESULT_SITE_ONLY_PARAM) const {
+    if (detail::engaged(*this))
       return *value_;
-    throw bad_optional_access();
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_optional_access();
   }
 
   /// \returns the stored value if there is one, otherwise returns `u`
@@ -2091,7 +3827,9 @@ public:
     static_assert(std::is_copy_constructible<T>::value &&
                       std::is_convertible<U&& , T>::value,
                   "T must be copy constructible and convertible from U");
-    return has_value() ? **this : static_cast<T>(std::forward<U>(u));
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(std::forward<U>(u));
   }
 
   /// \group value_or
@@ -2099,30 +3837,3087 @@ public:
     static_assert(std::is_move_constructible<T>::value &&
                       std::is_convertible<U&& , T>::value,
                   "T must be move constructible and convertible from U");
-    return has_value() ? **this : static_cast<T>(std::forward<U>(u));
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(std::forward<U>(u));
+  }
+
+  /// \returns the stored value if there is one, otherwise the result of
+  /// `std::forward<F>(f)()`. The referee is copied, never moved, since it is
+  /// not owned by the optional.
+  /// \group value_or_else
+  template <typename F> constexpr T value_or_else(F &&f) const {
+    static_assert(std::is_copy_constructible<T>::value &&
+                      std::is_convertible<detail::invoke_result_t<F>, T>::value,
+                  "T must be copy constructible and convertible from the "
+                  "result of F");
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(detail::invoke(std::forward<F>(f)));
   }
 
   /// Destroys the stored value if one exists, making the optional empty
-  void reset() noexcept { value_ = nullptr; }
+  constexpr void reset() noexcept { value_ = nullptr; }
 
 private:
   T *value_;
 }; // namespace tao
 
+/// \brief A tag type to tell result to construct its error in-place
+struct unexpect_t {
+    explicit unexpect_t() = default;
+};
+/// \brief A tag to tell result to construct its error in-place
+TAO_RESULT_INLINE_VAR constexpr unexpect_t unexpect {};
 
+#ifdef TAO_RESULT_INSTRUMENT
+/// \exclude
+namespace detail {
+// unexpect_t with the call site of the constructor it is passed to
+struct unexpect_site {
+  constexpr unexpect_site(
+      unexpect_t,
+      std::source_location s = std::source_location::current()) noexcept
+      : site(s) {}
+
+  std::source_location site;
+};
+} // namespace detail
+#endif
 
-} // namespace tao
+/// \exclude
+namespace detail {
+template <typename R, typename Res> constexpr R forward_error(Res &&r) {
+  return R(unexpect, std::forward<Res>(r).error());
+}
+} // namespace detail
 
-namespace std {
-// TODO SFINAE
-template <typename T> struct hash<tao::optional<T>> {
-  ::std::size_t operator()(const tao::optional<T>& o) const {
-    if (!o.has_value())
-      return 0;
+/// \brief Wraps an error so it can be used to construct or assign a
+/// `tao::result` in the error state.
+///
+/// *Examples*:
+/// ```
+/// tao::result<int, std::errc> r = tao::make_unexpected(std::errc::invalid_argument);
+/// ```
+template <typename E> class unexpected {
+public:
+  static_assert(!std::is_same<E, void>::value, "E must not be void");
 
-    return std::hash<tao::detail::remove_const_t<T>>()(*o);
-  }
+  unexpected() = delete;
+
+  constexpr explicit unexpected(const E &e) : value_(e) {}
+
+  constexpr explicit unexpected(E &&e) : value_(std::move(e)) {}
+
+  /// \returns the contained error
+  /// \group unexpected_value
+  constexpr const E &value() const & { return value_; }
+  /// \group unexpected_value
+  constexpr E &value() & { return value_; }
+  /// \group unexpected_value
+  constexpr E &&value() && { return std::move(value_); }
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group unexpected_value
+  constexpr const E &&value() const && { return std::move(value_); }
+#endif
+
+private:
+  E value_;
+};
+
+/// \group unexpected_relop
+template <typename E>
+inline constexpr bool operator==(const unexpected<E> &lhs, const unexpected<E> &rhs) {
+  return lhs.value() == rhs.value();
+}
+/// \group unexpected_relop
+template <typename E>
+inline constexpr bool operator!=(const unexpected<E> &lhs, const unexpected<E> &rhs) {
+  return lhs.value() != rhs.value();
+}
+
+/// \returns an `unexpected` holding a decayed copy of `e`
+template <typename E>
+inline constexpr unexpected<detail::decay_t<E>> make_unexpected(E &&e) {
+  return unexpected<detail::decay_t<E>>(std::forward<E>(e));
+}
+
+/// \brief Thrown by `result::value()` when the result holds an error.
+/// A copy of the error is available through `error()`.
+template <typename E> class bad_result_access : public std::exception {
+public:
+  explicit bad_result_access(E e) : error_(std::move(e)) {}
+
+  const char *what() const noexcept { return "Result has no value"; }
+
+  const E &error() const & { return error_; }
+  E &error() & { return error_; }
+  E &&error() && { return std::move(error_); }
+
+private:
+  E error_;
 };
+
+/// \exclude
+namespace detail {
+template <typename E>
+[[noreturn]] TAO_RESULT_COLD void throw_bad_result_access(E &&e) {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+  (void)e;
+  report_failure("Result has no value");
+#else
+  throw bad_result_access<decay_t<E>>(std::forward<E>(e));
+#endif
+}
+
+// Trait for checking if a type is a tao::unexpected
+template <typename T> struct is_unexpected_impl : std::false_type {};
+template <typename E> struct is_unexpected_impl<unexpected<E>> : std::true_type {};
+template <typename T> using is_unexpected = is_unexpected_impl<decay_t<T>>;
+
+// Tag used by the copy/move bases to construct the storage straight from
+// another result, so a throwing constructor never leaves a half-built object
+struct from_storage_t {};
+struct from_result_t {};
+
+// Tag used to construct the default constructor base when the default
+// constructor itself may be deleted
+struct default_ctor_tag {};
+
+template <typename T, typename E, typename U>
+using enable_result_forward_value =
+    detail::enable_if_t<std::is_constructible<T, U&&>::value &&
+                        !std::is_same<detail::decay_t<U>, in_place_t>::value &&
+                        !std::is_same<detail::decay_t<U>, unexpect_t>::value &&
+                        !std::is_same<result<T, E>, detail::decay_t<U>>::value &&
+                        !is_std_expected<detail::decay_t<U>>::value &&
+                        !is_unexpected<U>::value>;
+
+template <typename T, typename E, typename U, typename G, typename UR, typename GR>
+using enable_result_from_other = detail::enable_if_t<
+    std::is_constructible<T, UR>::value &&
+    std::is_constructible<E, GR>::value &&
+    !std::is_constructible<T, result<U, G>&>::value &&
+    !std::is_constructible<T, result<U, G>&&>::value &&
+    !std::is_constructible<T, const result<U, G>&>::value &&
+    !std::is_constructible<T, const result<U, G>&&>::value &&
+    !std::is_convertible<result<U, G>&, T>::value &&
+    !std::is_convertible<result<U, G>&&, T>::value &&
+    !std::is_convertible<const result<U, G>&, T>::value &&
+    !std::is_convertible<const result<U, G>&&, T>::value>;
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+// As enable_result_from_other for a std::expected<U, G>, with the same
+// exception for bool as enable_from_std_optional
+template <typename T, typename E, typename U, typename G, typename UR, typename GR>
+using enable_result_from_std = detail::enable_if_t<
+    std::is_constructible<T, UR>::value &&
+    std::is_constructible<E, GR>::value &&
+    (std::is_same<typename std::remove_cv<T>::type, bool>::value ||
+     (!std::is_constructible<T, std::expected<U, G>&>::value &&
+      !std::is_constructible<T, std::expected<U, G>&&>::value &&
+      !std::is_constructible<T, const std::expected<U, G>&>::value &&
+      !std::is_constructible<T, const std::expected<U, G>&&>::value &&
+      !std::is_convertible<std::expected<U, G>&, T>::value &&
+      !std::is_convertible<std::expected<U, G>&&, T>::value &&
+      !std::is_convertible<const std::expected<U, G>&, T>::value &&
+      !std::is_convertible<const std::expected<U, G>&&, T>::value))>;
+#endif
+
+template <typename T, typename E, typename U>
+using enable_result_assign_forward = detail::enable_if_t<
+    !std::is_same<result<T, E>, detail::decay_t<U>>::value &&
+    !is_unexpected<U>::value &&
+    std::is_constructible<T, U>::value && std::is_assignable<T &, U>::value &&
+    (std::is_nothrow_constructible<T, U>::value ||
+     std::is_nothrow_move_constructible<T>::value ||
+     std::is_nothrow_move_constructible<E>::value)>;
+
+template <typename T, typename E, typename GR>
+using enable_result_assign_error = detail::enable_if_t<
+    std::is_constructible<E, GR>::value && std::is_assignable<E &, GR>::value &&
+    (std::is_nothrow_constructible<E, GR>::value ||
+     std::is_nothrow_move_constructible<T>::value ||
+     std::is_nothrow_move_constructible<E>::value)>;
+
+template <typename F, typename U, typename E>
+using get_result_map_return = result<invoke_result_t<F, U>, E>;
+
+template <typename F, typename T, typename G>
+using get_result_map_error_return = result<T, fixup_void<invoke_result_t<F, G>>>;
+
+// Switches the active union member from `old_val` to `new_val`.
+// Mirrors the reinit-expected algorithm of [expected.object.assign]: if
+// constructing the new member can throw, the old one is kept alive (or
+// restored) so the result is never left without an active member.
+template <typename New, typename Old, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit(std::integral_constant<int, 0>, New &new_val, Old &old_val,
+                   Args &&... args) {
+  old_val.~Old();
+  detail::construct_at(std::addressof(new_val), std::forward<Args>(args)...);
+}
+
+template <typename New, typename Old, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit(std::integral_constant<int, 1>, New &new_val, Old &old_val,
+                   Args &&... args) {
+  New tmp(std::forward<Args>(args)...);
+  old_val.~Old();
+  detail::construct_at(std::addressof(new_val), std::move(tmp));
+}
+
+template <typename New, typename Old, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit(std::integral_constant<int, 2>, New &new_val, Old &old_val,
+                   Args &&... args) {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+  result_reinit(std::integral_constant<int, 0>{}, new_val, old_val,
+                std::forward<Args>(args)...);
+#else
+  Old tmp(std::move(old_val));
+  old_val.~Old();
+  try {
+    detail::construct_at(std::addressof(new_val), std::forward<Args>(args)...);
+  } catch (...) {
+    detail::construct_at(std::addressof(old_val), std::move(tmp));
+    throw;
+  }
+#endif
+}
+
+template <typename New, typename Old, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit(New &new_val, Old &old_val, Args &&... args) {
+  using strategy = std::integral_constant<
+      int, std::is_nothrow_constructible<New, Args &&...>::value
+               ? 0
+               : std::is_nothrow_move_constructible<New>::value ? 1 : 2>;
+  result_reinit(strategy{}, new_val, old_val, std::forward<Args>(args)...);
+}
+
+// result_reinit with uses-allocator construction of the new member
+template <typename New, typename Old, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit_using_allocator(uses_allocator_none, New &new_val,
+                                   Old &old_val, const Alloc &,
+                                   Args &&... args) {
+  result_reinit(new_val, old_val, std::forward<Args>(args)...);
+}
+
+template <typename New, typename Old, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit_using_allocator(uses_allocator_leading, New &new_val,
+                                   Old &old_val, const Alloc &a,
+                                   Args &&... args) {
+  result_reinit(new_val, old_val, std::allocator_arg, a,
+                std::forward<Args>(args)...);
+}
+
+template <typename New, typename Old, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit_using_allocator(uses_allocator_trailing, New &new_val,
+                                   Old &old_val, const Alloc &a,
+                                   Args &&... args) {
+  result_reinit(new_val, old_val, std::forward<Args>(args)..., a);
+}
+
+template <typename New, typename Old, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_reinit_using_allocator(New &new_val, Old &old_val, const Alloc &a,
+                                   Args &&... args) {
+  result_reinit_using_allocator(uses_allocator_tag<New, Alloc, Args &&...>{},
+                                new_val, old_val, a,
+                                std::forward<Args>(args)...);
+}
+
+// Replaces the active union member `val` with one constructed from `args`.
+// If that construction can throw, it is made into a temporary first: moved
+// in when the move cannot throw, move assigned otherwise, so that `val` is
+// alive whatever happens.
+template <typename V, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace(std::integral_constant<int, 0>, V &val, Args &&... args) {
+  val.~V();
+  detail::construct_at(std::addressof(val), std::forward<Args>(args)...);
+}
+
+template <typename V, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace(std::integral_constant<int, 1>, V &val, Args &&... args) {
+  V tmp(std::forward<Args>(args)...);
+  val.~V();
+  detail::construct_at(std::addressof(val), std::move(tmp));
+}
+
+template <typename V, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace(std::integral_constant<int, 2>, V &val, Args &&... args) {
+  static_assert(std::is_move_assignable<V>::value,
+                "emplacing a type whose construction and move construction "
+                "may both throw requires it to be move assignable");
+  V tmp(std::forward<Args>(args)...);
+  val = std::move(tmp);
+}
+
+template <typename V, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace(V &val, Args &&... args) {
+  using strategy = std::integral_constant<
+      int, std::is_nothrow_constructible<V, Args &&...>::value
+               ? 0
+               : std::is_nothrow_move_constructible<V>::value ? 1 : 2>;
+  result_replace(strategy{}, val, std::forward<Args>(args)...);
+}
+
+// result_replace with uses-allocator construction of the new member
+template <typename V, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace_using_allocator(uses_allocator_none, V &val, const Alloc &,
+                                    Args &&... args) {
+  result_replace(val, std::forward<Args>(args)...);
+}
+
+template <typename V, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace_using_allocator(uses_allocator_leading, V &val,
+                                    const Alloc &a, Args &&... args) {
+  result_replace(val, std::allocator_arg, a, std::forward<Args>(args)...);
+}
+
+template <typename V, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace_using_allocator(uses_allocator_trailing, V &val,
+                                    const Alloc &a, Args &&... args) {
+  result_replace(val, std::forward<Args>(args)..., a);
+}
+
+template <typename V, typename Alloc, typename... Args>
+TAO_RESULT_CONSTEXPR20
+void result_replace_using_allocator(V &val, const Alloc &a, Args &&... args) {
+  result_replace_using_allocator(uses_allocator_tag<V, Alloc, Args &&...>{},
+                                 val, a, std::forward<Args>(args)...);
+}
+
+// The storage base holds either a T or an E in a single union and correctly
+// propagates trivial destruction from both. This case is for when T or E is
+// not trivially destructible.
+template <typename T, typename E,
+          bool = std::is_trivially_destructible<T>::value &&
+                 std::is_trivially_destructible<E>::value>
+struct result_storage_base {
+    constexpr
+    result_storage_base()
+        : value_(), has_value_(true)
+    {}
+
+    template <typename... U>
+    constexpr
+    result_storage_base(in_place_t, U&&... u)
+        : value_(std::forward<U>(u)...), has_value_(true)
+    {}
+
+    template <typename... U>
+    constexpr
+    result_storage_base(unexpect_t, U&&... u)
+        : error_(std::forward<U>(u)...), has_value_(false)
+    {}
+
+    template <typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(from_storage_t, Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value_)
+    {
+        if (has_value_) {
+            detail::construct_at(std::addressof(value_),
+                                 std::forward<Other>(rhs).value_);
+        } else {
+            detail::construct_at(std::addressof(error_),
+                                 std::forward<Other>(rhs).error_);
+        }
+    }
+
+    template <typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(from_result_t, Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value())
+    {
+        if (has_value_) {
+            detail::construct_at(std::addressof(value_),
+                                 *std::forward<Other>(rhs));
+        } else {
+            detail::construct_at(std::addressof(error_),
+                                 std::forward<Other>(rhs).error());
+        }
+    }
+
+    // Uses-allocator construction of whichever member is constructed
+    template <typename Alloc, typename... U>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, in_place_t,
+                        U&&... u)
+        : dummy_(), has_value_(true)
+    {
+        detail::construct_using_allocator(std::addressof(value_), a,
+                                          std::forward<U>(u)...);
+    }
+
+    template <typename Alloc, typename... U>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, unexpect_t,
+                        U&&... u)
+        : dummy_(), has_value_(false)
+    {
+        detail::construct_using_allocator(std::addressof(error_), a,
+                                          std::forward<U>(u)...);
+    }
+
+    template <typename Alloc, typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, from_storage_t,
+                        Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value_)
+    {
+        if (has_value_) {
+            detail::construct_using_allocator(std::addressof(value_), a,
+                                              std::forward<Other>(rhs).value_);
+        } else {
+            detail::construct_using_allocator(std::addressof(error_), a,
+                                              std::forward<Other>(rhs).error_);
+        }
+    }
+
+    TAO_RESULT_CONSTEXPR20
+    ~result_storage_base() {
+        if (has_value_) {
+            value_.~T();
+        } else {
+            error_.~E();
+        }
+    }
+
+    struct dummy {};
+
+    union {
+        dummy dummy_;
+        T value_;
+        E error_;
+    };
+
+    bool has_value_;
+};
+
+// This case is for when both T and E are trivially destructible.
+template <typename T, typename E>
+struct result_storage_base<T, E, true> {
+    constexpr
+    result_storage_base()
+        : value_(), has_value_(true)
+    {}
+
+    template <typename... U>
+    constexpr
+    result_storage_base(in_place_t, U&&... u)
+        : value_(std::forward<U>(u)...), has_value_(true)
+    {}
+
+    template <typename... U>
+    constexpr
+    result_storage_base(unexpect_t, U&&... u)
+        : error_(std::forward<U>(u)...), has_value_(false)
+    {}
+
+    template <typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(from_storage_t, Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value_)
+    {
+        if (has_value_) {
+            detail::construct_at(std::addressof(value_),
+                                 std::forward<Other>(rhs).value_);
+        } else {
+            detail::construct_at(std::addressof(error_),
+                                 std::forward<Other>(rhs).error_);
+        }
+    }
+
+    template <typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(from_result_t, Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value())
+    {
+        if (has_value_) {
+            detail::construct_at(std::addressof(value_),
+                                 *std::forward<Other>(rhs));
+        } else {
+            detail::construct_at(std::addressof(error_),
+                                 std::forward<Other>(rhs).error());
+        }
+    }
+
+    // Uses-allocator construction of whichever member is constructed
+    template <typename Alloc, typename... U>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, in_place_t,
+                        U&&... u)
+        : dummy_(), has_value_(true)
+    {
+        detail::construct_using_allocator(std::addressof(value_), a,
+                                          std::forward<U>(u)...);
+    }
+
+    template <typename Alloc, typename... U>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, unexpect_t,
+                        U&&... u)
+        : dummy_(), has_value_(false)
+    {
+        detail::construct_using_allocator(std::addressof(error_), a,
+                                          std::forward<U>(u)...);
+    }
+
+    template <typename Alloc, typename Other>
+    TAO_RESULT_CONSTEXPR20
+    result_storage_base(std::allocator_arg_t, const Alloc& a, from_storage_t,
+                        Other&& rhs)
+        : dummy_(), has_value_(rhs.has_value_)
+    {
+        if (has_value_) {
+            detail::construct_using_allocator(std::addressof(value_), a,
+                                              std::forward<Other>(rhs).value_);
+        } else {
+            detail::construct_using_allocator(std::addressof(error_), a,
+                                              std::forward<Other>(rhs).error_);
+        }
+    }
+
+    // No destructor, so this class is trivially destructible
+
+    struct dummy {};
+
+    union {
+        dummy dummy_;
+        T value_;
+        E error_;
+    };
+
+    bool has_value_;
+};
+
+// This base class provides some handy member functions which can be used in
+// further derived classes
+template <typename T, typename E,
+          bool = is_allocator_aware<T>::value || is_allocator_aware<E>::value>
+struct result_operations_base : result_storage_base<T, E> {
+    using result_storage_base<T, E>::result_storage_base;
+
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void emplace_value(Args&&... args) {
+        if (this->has_value_) {
+            result_replace(this->value_, std::forward<Args>(args)...);
+        } else {
+            result_reinit(this->value_, this->error_, std::forward<Args>(args)...);
+            this->has_value_ = true;
+        }
+    }
+
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void emplace_error(Args&&... args) {
+        if (!this->has_value_) {
+            result_replace(this->error_, std::forward<Args>(args)...);
+        } else {
+            result_reinit(this->error_, this->value_, std::forward<Args>(args)...);
+            this->has_value_ = false;
+        }
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void emplace_value_with_allocator(const Alloc &a, Args&&... args) {
+        if (this->has_value_) {
+            result_replace_using_allocator(this->value_, a,
+                                           std::forward<Args>(args)...);
+        } else {
+            result_reinit_using_allocator(this->value_, this->error_, a,
+                                          std::forward<Args>(args)...);
+            this->has_value_ = true;
+        }
+    }
+
+    template <typename Alloc, typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void emplace_error_with_allocator(const Alloc &a, Args&&... args) {
+        if (!this->has_value_) {
+            result_replace_using_allocator(this->error_, a,
+                                           std::forward<Args>(args)...);
+        } else {
+            result_reinit_using_allocator(this->error_, this->value_, a,
+                                          std::forward<Args>(args)...);
+            this->has_value_ = false;
+        }
+    }
+
+    template <typename U>
+    TAO_RESULT_CONSTEXPR20
+    void assign_value(U&& u) {
+        if (this->has_value_) {
+            this->value_ = std::forward<U>(u);
+        } else {
+            result_reinit(this->value_, this->error_, std::forward<U>(u));
+            this->has_value_ = true;
+        }
+    }
+
+    template <typename G>
+    TAO_RESULT_CONSTEXPR20
+    void assign_error(G&& g) {
+        if (!this->has_value_) {
+            this->error_ = std::forward<G>(g);
+        } else {
+            result_reinit(this->error_, this->value_, std::forward<G>(g));
+            this->has_value_ = false;
+        }
+    }
+
+    template <typename Rhs>
+    TAO_RESULT_CONSTEXPR20
+    void assign(Rhs&& rhs) {
+        if (rhs.has_value_) {
+            assign_value(std::forward<Rhs>(rhs).value_);
+        } else {
+            assign_error(std::forward<Rhs>(rhs).error_);
+        }
+    }
+
+    constexpr bool has_value() const noexcept { return this->has_value_; }
+
+    constexpr
+    T &get() & { return this->value_; }
+
+    constexpr
+    const T &get() const & { return this->value_; }
+
+    constexpr
+    T &&get() && { return std::move(this->value_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+    constexpr const T &&get() const && { return std::move(this->value_); }
+#endif
+
+    constexpr
+    E &geterr() & { return this->error_; }
+
+    constexpr
+    const E &geterr() const & { return this->error_; }
+
+    constexpr
+    E &&geterr() && { return std::move(this->error_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+    constexpr const E &&geterr() const && { return std::move(this->error_); }
+#endif
+};
+
+// The allocator kept by a result whose T or E is allocator-aware: T's if it
+// is, otherwise E's
+template <typename T, typename E, bool = is_allocator_aware<T>::value>
+struct result_allocator {
+    using type = typename E::allocator_type;
+};
+template <typename T, typename E> struct result_allocator<T, E, true> {
+    using type = typename T::allocator_type;
+};
+
+// Whether U carries an allocator that converts to Alloc
+template <typename U, typename Alloc, typename = void>
+struct carries_allocator : std::false_type {};
+template <typename U, typename Alloc>
+struct carries_allocator<U, Alloc, enable_if_t<is_allocator_aware<U>::value>>
+    : std::is_convertible<typename U::allocator_type, Alloc> {};
+
+// A result always holds a T or an E, so unlike optional it keeps its
+// allocator next to the union. The member that is alive is the authority
+// when it carries an allocator, alloc_ otherwise; alloc_ is refreshed every
+// time a member is constructed, so whichever member comes next is built with
+// the allocator of the one it replaces. Copies, moves and assignments follow
+// the rules of a standard container, as for optional.
+template <typename T, typename E>
+struct result_operations_base<T, E, true> : result_operations_base<T, E, false> {
+    using plain = result_operations_base<T, E, false>;
+    using plain::plain;
+    using allocator_type = typename result_allocator<T, E>::type;
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+    result_operations_base() = default;
+
+    // These hide the inherited constructors of the same form, which would
+    // leave alloc_ default-constructed
+    template <typename Alloc, typename... U>
+    result_operations_base(std::allocator_arg_t, const Alloc &a, in_place_t,
+                           U &&... u)
+        : plain(std::allocator_arg, a, in_place, std::forward<U>(u)...),
+          alloc_(convert_allocator(
+              a, std::is_convertible<const Alloc &, allocator_type>{})) {}
+
+    template <typename Alloc, typename... U>
+    result_operations_base(std::allocator_arg_t, const Alloc &a, unexpect_t,
+                           U &&... u)
+        : plain(std::allocator_arg, a, unexpect, std::forward<U>(u)...),
+          alloc_(convert_allocator(
+              a, std::is_convertible<const Alloc &, allocator_type>{})) {}
+
+    template <typename Alloc, typename Other>
+    result_operations_base(std::allocator_arg_t, const Alloc &a,
+                           from_storage_t, Other &&rhs)
+        : plain(std::allocator_arg, a, from_storage_t{},
+                std::forward<Other>(rhs)),
+          alloc_(convert_allocator(
+              a, std::is_convertible<const Alloc &, allocator_type>{})) {}
+
+    // Reached from the copy and move constructors of result_copy_base and
+    // result_move_base
+    template <typename Other>
+    result_operations_base(from_storage_t, Other &&rhs)
+        : result_operations_base(std::is_lvalue_reference<Other>{},
+                                 std::forward<Other>(rhs)) {}
+
+    allocator_type get_allocator() const noexcept {
+        return this->has_value_
+                   ? member_allocator(this->value_,
+                                      carries_allocator<T, allocator_type>{})
+                   : member_allocator(this->error_,
+                                      carries_allocator<E, allocator_type>{});
+    }
+
+    template <typename... Args>
+    void emplace_value(Args &&... args) {
+        detail::replace_allocator(alloc_, get_allocator());
+        plain::emplace_value_with_allocator(alloc_, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void emplace_error(Args &&... args) {
+        detail::replace_allocator(alloc_, get_allocator());
+        plain::emplace_error_with_allocator(alloc_, std::forward<Args>(args)...);
+    }
+
+    // An allocator that converts to allocator_type replaces the kept one,
+    // any other is only offered to the new member
+    template <typename Alloc, typename... Args>
+    void emplace_value_with_allocator(const Alloc &a, Args &&... args) {
+        adopt_allocator(a, std::is_convertible<const Alloc &, allocator_type>{});
+        plain::emplace_value_with_allocator(a, std::forward<Args>(args)...);
+    }
+
+    template <typename Alloc, typename... Args>
+    void emplace_error_with_allocator(const Alloc &a, Args &&... args) {
+        adopt_allocator(a, std::is_convertible<const Alloc &, allocator_type>{});
+        plain::emplace_error_with_allocator(a, std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void assign_value(U &&u) {
+        if (this->has_value_) {
+            this->value_ = std::forward<U>(u);
+        } else {
+            emplace_value(std::forward<U>(u));
+        }
+    }
+
+    template <typename G>
+    void assign_error(G &&g) {
+        if (!this->has_value_) {
+            this->error_ = std::forward<G>(g);
+        } else {
+            emplace_error(std::forward<G>(g));
+        }
+    }
+
+    template <typename Rhs>
+    void assign(Rhs &&rhs) {
+        using propagates = std::integral_constant<
+            bool,
+            std::is_lvalue_reference<Rhs>::value
+                ? alloc_traits::propagate_on_container_copy_assignment::value
+                : alloc_traits::propagate_on_container_move_assignment::value>;
+        detail::replace_allocator(alloc_,
+                                  assigned_allocator(rhs, propagates{}));
+        if (rhs.has_value_) {
+            if (this->has_value_) {
+                this->value_ = std::forward<Rhs>(rhs).value_;
+            } else {
+                plain::emplace_value_with_allocator(alloc_,
+                                                    std::forward<Rhs>(rhs).value_);
+            }
+        } else {
+            if (!this->has_value_) {
+                this->error_ = std::forward<Rhs>(rhs).error_;
+            } else {
+                plain::emplace_error_with_allocator(alloc_,
+                                                    std::forward<Rhs>(rhs).error_);
+            }
+        }
+    }
+
+    allocator_type alloc_;
+
+private:
+    template <typename Alloc>
+    static allocator_type convert_allocator(const Alloc &a, std::true_type) noexcept {
+        return allocator_type(a);
+    }
+
+    template <typename Alloc>
+    static allocator_type convert_allocator(const Alloc &, std::false_type) noexcept {
+        return allocator_type();
+    }
+
+    template <typename Alloc>
+    void adopt_allocator(const Alloc &a, std::true_type) noexcept {
+        detail::replace_allocator(alloc_, allocator_type(a));
+    }
+
+    template <typename Alloc>
+    void adopt_allocator(const Alloc &, std::false_type) noexcept {
+        detail::replace_allocator(alloc_, get_allocator());
+    }
+
+    template <typename U>
+    static allocator_type member_allocator(const U &u, std::true_type) noexcept {
+        return allocator_type(u.get_allocator());
+    }
+
+    template <typename U>
+    allocator_type member_allocator(const U &, std::false_type) const noexcept {
+        return alloc_;
+    }
+
+    template <typename Rhs>
+    static allocator_type assigned_allocator(const Rhs &rhs, std::true_type) noexcept {
+        return rhs.get_allocator();
+    }
+
+    template <typename Rhs>
+    allocator_type assigned_allocator(const Rhs &, std::false_type) const noexcept {
+        return get_allocator();
+    }
+
+    template <typename Other>
+    result_operations_base(std::true_type, const Other &rhs)
+        : result_operations_base(
+              std::allocator_arg,
+              alloc_traits::select_on_container_copy_construction(
+                  rhs.get_allocator()),
+              from_storage_t{}, rhs) {}
+
+    // The moved members bring their allocators
+    template <typename Other>
+    result_operations_base(std::false_type, Other &&rhs)
+        : plain(from_storage_t{}, std::move(rhs)),
+          alloc_(rhs.get_allocator()) {}
+};
+
+// This class manages conditionally having a trivial copy constructor
+// This specialization is for when T and E are trivially copy constructible
+template <typename T, typename E,
+          bool = TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(E)>
+struct result_copy_base : result_operations_base<T, E> {
+  using result_operations_base<T, E>::result_operations_base;
+};
+
+// This specialization is for when T or E is not trivially copy constructible
+template <typename T, typename E>
+struct result_copy_base<T, E, false> : result_operations_base<T, E> {
+  using result_operations_base<T, E>::result_operations_base;
+
+  result_copy_base() = default;
+  TAO_RESULT_CONSTEXPR20 result_copy_base(const result_copy_base &rhs)
+      : result_operations_base<T, E>(from_storage_t{}, rhs) {}
+
+  result_copy_base(result_copy_base &&rhs) = default;
+  result_copy_base &operator=(const result_copy_base &rhs) = default;
+  result_copy_base &operator=(result_copy_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial move constructor
+#ifndef TAO_OPTIONAL_GCC49
+template <typename T, typename E,
+          bool = std::is_trivially_move_constructible<T>::value &&
+                 std::is_trivially_move_constructible<E>::value>
+struct result_move_base : result_copy_base<T, E> {
+  using result_copy_base<T, E>::result_copy_base;
+};
+#else
+template <typename T, typename E, bool = false> struct result_move_base;
+#endif
+template <typename T, typename E>
+struct result_move_base<T, E, false> : result_copy_base<T, E> {
+  using result_copy_base<T, E>::result_copy_base;
+
+  result_move_base() = default;
+  result_move_base(const result_move_base &rhs) = default;
+
+  TAO_RESULT_CONSTEXPR20 result_move_base(result_move_base &&rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<E>::value)
+      : result_copy_base<T, E>(from_storage_t{}, std::move(rhs)) {}
+  result_move_base &operator=(const result_move_base &rhs) = default;
+  result_move_base &operator=(result_move_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial copy assignment operator
+template <typename T, typename E,
+          bool = TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(T) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(T) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_COPY_ASSIGNABLE(E) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(E) &&
+                 TAO_OPTIONAL_IS_TRIVIALLY_DESTRUCTIBLE(E)>
+struct result_copy_assign_base : result_move_base<T, E> {
+  using result_move_base<T, E>::result_move_base;
+};
+
+template <typename T, typename E>
+struct result_copy_assign_base<T, E, false> : result_move_base<T, E> {
+  using result_move_base<T, E>::result_move_base;
+
+  result_copy_assign_base() = default;
+  result_copy_assign_base(const result_copy_assign_base &rhs) = default;
+
+  result_copy_assign_base(result_copy_assign_base &&rhs) = default;
+  TAO_RESULT_CONSTEXPR20 result_copy_assign_base &
+  operator=(const result_copy_assign_base &rhs) {
+    this->assign(rhs);
+    return *this;
+  }
+  result_copy_assign_base &
+  operator=(result_copy_assign_base &&rhs) = default;
+};
+
+// This class manages conditionally having a trivial move assignment operator
+#ifndef TAO_OPTIONAL_GCC49
+template <typename T, typename E,
+          bool = std::is_trivially_destructible<T>::value &&
+                 std::is_trivially_move_constructible<T>::value &&
+                 std::is_trivially_move_assignable<T>::value &&
+                 std::is_trivially_destructible<E>::value &&
+                 std::is_trivially_move_constructible<E>::value &&
+                 std::is_trivially_move_assignable<E>::value>
+struct result_move_assign_base : result_copy_assign_base<T, E> {
+  using result_copy_assign_base<T, E>::result_copy_assign_base;
+};
+#else
+template <typename T, typename E, bool = false> struct result_move_assign_base;
+#endif
+
+template <typename T, typename E>
+struct result_move_assign_base<T, E, false> : result_copy_assign_base<T, E> {
+  using result_copy_assign_base<T, E>::result_copy_assign_base;
+
+  result_move_assign_base() = default;
+  result_move_assign_base(const result_move_assign_base &rhs) = default;
+
+  result_move_assign_base(result_move_assign_base &&rhs) = default;
+
+  result_move_assign_base &
+  operator=(const result_move_assign_base &rhs) = default;
+
+  TAO_RESULT_CONSTEXPR20 result_move_assign_base &
+  operator=(result_move_assign_base &&rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value &&
+      std::is_nothrow_move_constructible<E>::value &&
+      std::is_nothrow_move_assignable<E>::value) {
+    this->assign(std::move(rhs));
+    return *this;
+  }
+};
+
+// result_default_ctor_base will conditionally delete the default constructor
+// depending on whether T is default constructible
+template <typename T, bool Enable = std::is_default_constructible<T>::value>
+struct result_default_ctor_base {
+  constexpr result_default_ctor_base() noexcept = default;
+  constexpr result_default_ctor_base(const result_default_ctor_base &) noexcept = default;
+  constexpr result_default_ctor_base(result_default_ctor_base &&) noexcept = default;
+  result_default_ctor_base &
+  operator=(const result_default_ctor_base &) noexcept = default;
+  result_default_ctor_base &
+  operator=(result_default_ctor_base &&) noexcept = default;
+
+  constexpr explicit result_default_ctor_base(default_ctor_tag) {}
+};
+
+template <typename T> struct result_default_ctor_base<T, false> {
+  constexpr result_default_ctor_base() noexcept = delete;
+  constexpr result_default_ctor_base(const result_default_ctor_base &) noexcept = default;
+  constexpr result_default_ctor_base(result_default_ctor_base &&) noexcept = default;
+  result_default_ctor_base &
+  operator=(const result_default_ctor_base &) noexcept = default;
+  result_default_ctor_base &
+  operator=(result_default_ctor_base &&) noexcept = default;
+
+  constexpr explicit result_default_ctor_base(default_ctor_tag) {}
+};
+
+// Copy and move construction of a result need both T and E to be copy/move
+// constructible; assignment additionally needs one of them to be nothrow move
+// constructible so that switching between value and error can be undone
+template <typename T, typename E>
+using result_delete_ctor_base = optional_delete_ctor_base<
+    T,
+    std::is_copy_constructible<T>::value && std::is_copy_constructible<E>::value,
+    std::is_move_constructible<T>::value && std::is_move_constructible<E>::value>;
+
+template <typename T, typename E>
+using result_delete_assign_base = optional_delete_assign_base<
+    T,
+    std::is_copy_constructible<T>::value && std::is_copy_assignable<T>::value &&
+        std::is_copy_constructible<E>::value && std::is_copy_assignable<E>::value &&
+        (std::is_nothrow_move_constructible<T>::value ||
+         std::is_nothrow_move_constructible<E>::value),
+    std::is_move_constructible<T>::value && std::is_move_assignable<T>::value &&
+        std::is_move_constructible<E>::value && std::is_move_assignable<E>::value &&
+        (std::is_nothrow_move_constructible<T>::value ||
+         std::is_nothrow_move_constructible<E>::value)>;
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 *std::declval<Res>())),
+          detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
+constexpr auto result_map_impl(Res &&res, F &&f)
+    -> result<Ret, typename decay_t<Res>::error_type> {
+  using ret_t = result<Ret, typename decay_t<Res>::error_type>;
+  if (detail::engaged(res))
+    return ret_t(in_place,
+                 detail::invoke(std::forward<F>(f), *std::forward<Res>(res)));
+  return detail::make_off_path<Res, ret_t>(unexpect,
+                                          std::forward<Res>(res).error());
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 *std::declval<Res>())),
+          detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
+auto result_map_impl(Res &&res, F &&f)
+    -> result<void, typename decay_t<Res>::error_type> {
+  using ret_t = result<void, typename decay_t<Res>::error_type>;
+  if (detail::engaged(res)) {
+    detail::invoke(std::forward<F>(f), *std::forward<Res>(res));
+    return ret_t(in_place);
+  }
+
+  return detail::make_off_path<Res, ret_t>(unexpect,
+                                          std::forward<Res>(res).error());
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 std::declval<Res>().error())),
+          detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
+constexpr auto result_map_error_impl(Res &&res, F &&f)
+    -> result<typename decay_t<Res>::value_type, Ret> {
+  using ret_t = result<typename decay_t<Res>::value_type, Ret>;
+  if (detail::engaged(res))
+    return ret_t(in_place, *std::forward<Res>(res));
+  return ret_t(unexpect, detail::invoke(std::forward<F>(f),
+                                        std::forward<Res>(res).error()));
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 std::declval<Res>().error())),
+          detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
+auto result_map_error_impl(Res &&res, F &&f)
+    -> result<typename decay_t<Res>::value_type, monostate> {
+  using ret_t = result<typename decay_t<Res>::value_type, monostate>;
+  if (detail::engaged(res)) {
+    return ret_t(in_place, *std::forward<Res>(res));
+  }
+
+  detail::invoke(std::forward<F>(f), std::forward<Res>(res).error());
+  return ret_t(unexpect);
+}
+
+// Storage for result<void, E>. The value alternative is a monostate in the
+// usual union, so the layout is E plus the discriminant and every special
+// member is trivial when it is for E.
+template <typename E, bool = has_niche<E>::value>
+struct result_void_base : result_move_assign_base<monostate, E> {
+  using result_move_assign_base<monostate, E>::result_move_assign_base;
+};
+
+// When E declares a niche through optional_traits, the niche value stands for
+// "no error" and result<void, E> is exactly an E, with no discriminant.
+// Storing an error equal to the niche value makes the result hold a value.
+template <typename E> struct result_void_base<E, true> {
+    using traits = optional_traits<E>;
+
+    constexpr
+    result_void_base()
+        : error_(traits::empty_value())
+    {}
+
+    constexpr explicit
+    result_void_base(in_place_t)
+        : error_(traits::empty_value())
+    {}
+
+    template <typename... U>
+    constexpr explicit
+    result_void_base(unexpect_t, U&&... u)
+        : error_(std::forward<U>(u)...)
+    {}
+
+    // A niche error is a plain value such as an enumeration
+    template <typename Alloc>
+    constexpr
+    result_void_base(std::allocator_arg_t, const Alloc&, in_place_t)
+        : error_(traits::empty_value())
+    {
+        static_assert(!std::uses_allocator<E, Alloc>::value,
+                      "a niche E cannot take an allocator");
+    }
+
+    template <typename Alloc, typename... U>
+    constexpr
+    result_void_base(std::allocator_arg_t, const Alloc&, unexpect_t, U&&... u)
+        : error_(std::forward<U>(u)...)
+    {
+        static_assert(!std::uses_allocator<E, Alloc>::value,
+                      "a niche E cannot take an allocator");
+    }
+
+    template <typename Alloc>
+    constexpr
+    result_void_base(std::allocator_arg_t, const Alloc&, from_storage_t,
+                     const result_void_base &rhs)
+        : error_(rhs.error_)
+    {}
+
+    template <typename Alloc>
+    constexpr
+    result_void_base(std::allocator_arg_t, const Alloc&, from_storage_t,
+                     result_void_base &&rhs)
+        : error_(std::move(rhs.error_))
+    {}
+
+    constexpr bool has_value() const noexcept { return traits::is_empty(error_); }
+
+    TAO_RESULT_CONSTEXPR20
+    void emplace_value() noexcept { error_ = traits::empty_value(); }
+
+    template <typename... Args>
+    TAO_RESULT_CONSTEXPR20
+    void emplace_error(Args&&... args) {
+        error_ = E(std::forward<Args>(args)...);
+    }
+
+    template <typename G>
+    TAO_RESULT_CONSTEXPR20
+    void assign_error(G&& g) {
+        error_ = std::forward<G>(g);
+    }
+
+    constexpr
+    E &geterr() & { return error_; }
+
+    constexpr
+    const E &geterr() const & { return error_; }
+
+    constexpr
+    E &&geterr() && { return std::move(error_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+    constexpr const E &&geterr() const && { return std::move(error_); }
+#endif
+
+    E error_;
+};
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>())),
+          detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
+constexpr auto result_void_map_impl(Res &&res, F &&f)
+    -> result<Ret, typename decay_t<Res>::error_type> {
+  using ret_t = result<Ret, typename decay_t<Res>::error_type>;
+  if (detail::engaged(res))
+    return ret_t(in_place, detail::invoke(std::forward<F>(f)));
+  return detail::make_off_path<Res, ret_t>(unexpect,
+                                          std::forward<Res>(res).error());
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>())),
+          detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
+auto result_void_map_impl(Res &&res, F &&f)
+    -> result<void, typename decay_t<Res>::error_type> {
+  using ret_t = result<void, typename decay_t<Res>::error_type>;
+  if (detail::engaged(res)) {
+    detail::invoke(std::forward<F>(f));
+    return ret_t(in_place);
+  }
+
+  return detail::make_off_path<Res, ret_t>(unexpect,
+                                          std::forward<Res>(res).error());
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 std::declval<Res>().error())),
+          detail::enable_if_t<!std::is_void<Ret>::value> * = nullptr>
+constexpr auto result_void_map_error_impl(Res &&res, F &&f) -> result<void, Ret> {
+  using ret_t = result<void, Ret>;
+  if (detail::engaged(res))
+    return ret_t(in_place);
+  return ret_t(unexpect, detail::invoke(std::forward<F>(f),
+                                        std::forward<Res>(res).error()));
+}
+
+template <typename Res, typename F,
+          typename Ret = decltype(detail::invoke(std::declval<F>(),
+                                                 std::declval<Res>().error())),
+          detail::enable_if_t<std::is_void<Ret>::value> * = nullptr>
+auto result_void_map_error_impl(Res &&res, F &&f)
+    -> result<void, fixup_void<Ret>> {
+  using ret_t = result<void, fixup_void<Ret>>;
+  if (detail::engaged(res)) {
+    return ret_t(in_place);
+  }
+
+  detail::invoke(std::forward<F>(f), std::forward<Res>(res).error());
+  return ret_t(unexpect);
+}
+
+} // namespace detail
+
+/// A result object holds either a value of type `T` or an error of type `E`.
+/// Both alternatives share a single union and one discriminant, and the
+/// special member functions are trivial whenever they are trivial for both
+/// `T` and `E`, so e.g. `result<int, std::errc>` is trivially copyable and
+/// can be passed and returned in registers.
+///
+/// *Examples*:
+/// ```
+/// tao::result<int, std::errc> parse(char const* s);
+///
+/// auto r = parse(s);
+/// if (r) {
+///     use(*r);
+/// } else {
+///     report(r.error());
+/// }
+/// ```
+template <typename T, typename E>
+class result<T, E> : private detail::result_move_assign_base<T, E>,
+               private detail::result_default_ctor_base<T>,
+               private detail::result_delete_ctor_base<T, E>,
+               private detail::result_delete_assign_base<T, E> {
+  using base = detail::result_move_assign_base<T, E>;
+  using ctor_base = detail::result_default_ctor_base<T>;
+
+  static_assert(!std::is_reference<T>::value, "T must not be a reference");
+  static_assert(!std::is_void<T>::value, "T must not be void");
+  static_assert(!std::is_reference<E>::value, "E must not be a reference");
+  static_assert(!std::is_void<E>::value, "E must not be void");
+  static_assert(!std::is_same<detail::decay_t<T>, in_place_t>::value,
+                "instantiation of result with in_place_t is ill-formed");
+  static_assert(!std::is_same<detail::decay_t<T>, unexpect_t>::value,
+                "instantiation of result with unexpect_t is ill-formed");
+  static_assert(!detail::is_unexpected<T>::value,
+                "instantiation of result with unexpected<E> is ill-formed");
+
+public:
+  using value_type = T;
+  using error_type = E;
+  using unexpected_type = unexpected<E>;
+
+  /// \group and_then
+  /// Carries out some operation which returns a result on the stored
+  /// value if there is one. \requires `std::invoke(std::forward<F>(f),
+  /// value())` returns a `tao::result<U, E>` for some `U`. \returns The
+  /// error of `*this` if there is one, otherwise the return value of
+  /// `std::invoke(std::forward<F>(f), value())`.
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &;
+  template <typename F>
+  constexpr detail::invoke_result_t<F, T &> and_then(F &&f) & {
+    using ret_t = detail::invoke_result_t<F, T &>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<result, ret_t>(unexpect, error());
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &&;
+  template <typename F>
+  constexpr detail::invoke_result_t<F, T &&> and_then(F &&f) && {
+    using ret_t = detail::invoke_result_t<F, T &&>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<result, ret_t>(unexpect,
+                                                std::move(error()));
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) const &;
+  template <typename F>
+  constexpr detail::invoke_result_t<F, const T &> and_then(F &&f) const & {
+    using ret_t = detail::invoke_result_t<F, const T &>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **this);
+    return detail::make_off_path<result, ret_t>(unexpect, error());
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) const &&;
+  template <typename F>
+  constexpr detail::invoke_result_t<F, const T &&> and_then(F &&f) const && {
+    using ret_t = detail::invoke_result_t<F, const T &&>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), std::move(**this));
+    return detail::make_off_path<result, ret_t>(unexpect,
+                                                std::move(error()));
+  }
+#endif
+
+  /// \brief Carries out some operation on the stored value if there is one.
+  /// \returns Let `U` be the result of `std::invoke(std::forward<F>(f),
+  /// value())`. Returns a `tao::result<U, E>` holding either that value or
+  /// the error of `*this`.
+  ///
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &;
+  template <typename F>
+  constexpr detail::get_result_map_return<F, T &, E> map(F &&f) & {
+    return detail::result_map_impl(*this, std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &&;
+  template <typename F>
+  constexpr detail::get_result_map_return<F, T &&, E> map(F &&f) && {
+    return detail::result_map_impl(std::move(*this), std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) const &;
+  template <typename F>
+  constexpr detail::get_result_map_return<F, const T &, E> map(F &&f) const & {
+    return detail::result_map_impl(*this, std::forward<F>(f));
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) const &&;
+  template <typename F>
+  constexpr detail::get_result_map_return<F, const T &&, E> map(F &&f) const && {
+    return detail::result_map_impl(std::move(*this), std::forward<F>(f));
+  }
+#endif
+
+  /// \brief Carries out some operation on the stored error if there is one.
+  /// \returns Let `G` be the result of `std::invoke(std::forward<F>(f),
+  /// error())`. Returns a `tao::result<T, G>` holding either the value of
+  /// `*this` or the transformed error.
+  ///
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) &;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, T, E &> map_error(F &&f) & {
+    return detail::result_map_error_impl(*this, std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) &&;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, T, E &&> map_error(F &&f) && {
+    return detail::result_map_error_impl(std::move(*this), std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) const &;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, T, const E &>
+  map_error(F &&f) const & {
+    return detail::result_map_error_impl(*this, std::forward<F>(f));
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) const &&;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, T, const E &&>
+  map_error(F &&f) const && {
+    return detail::result_map_error_impl(std::move(*this), std::forward<F>(f));
+  }
+#endif
+
+  /// \brief Calls `f` with the error if the result holds one
+  /// \requires `std::invoke_result_t<F, E>` must be void or convertible to
+  /// `result<T, E>`.
+  /// \effects If `*this` has a value, returns `*this`.
+  /// Otherwise, if `f` returns `void`, calls `std::forward<F>(f)(error())` and
+  /// returns `*this`. Otherwise, returns `std::forward<F>(f)(error())`.
+  ///
+  /// \group or_else
+  /// \synopsis template <typename F> result<T, E> or_else (F &&f) &;
+  template <typename F, detail::enable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return *this;
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return detail::invoke(std::forward<F>(f), error());
+  }
+
+  /// \group or_else
+  /// \synopsis template <typename F> result<T, E> or_else (F &&f) &&;
+  template <typename F, detail::enable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return std::move(*this);
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, E &&> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return detail::invoke(std::forward<F>(f), std::move(error()));
+  }
+
+  /// \group or_else
+  /// \synopsis template <typename F> result<T, E> or_else (F &&f) const &;
+  template <typename F, detail::enable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return *this;
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return detail::invoke(std::forward<F>(f), error());
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  template <typename F, detail::enable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return std::move(*this);
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, const E &&> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return detail::invoke(std::forward<F>(f), std::move(error()));
+  }
+#endif
+
+  /// \brief Attaches a context frame to the error, if there is one.
+  /// \details The frame records `what` and a copy of `args`; nothing is
+  /// formatted until the context is written out, where each `{}` in `what`
+  /// is replaced by the next argument. Frames live in the current context
+  /// arena, so the error path does not allocate. `what` must outlive the
+  /// frame (typically a string literal). Requires `<tao/result/context.hpp>`.
+  /// \returns `*this` when `E` is already a `contextual<E0>`, otherwise the
+  /// result converted to `result<T, contextual<E>>`.
+  ///
+  /// *Examples*:
+  /// ```
+  /// return parse(bytes).with_context("while parsing header {} at offset {}",
+  ///                                  name, offset);
+  /// ```
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<T, E> with_context(const char *what,
+                                                  Args &&... args) & {
+    return tao_result_with_context(*this, what, std::forward<Args>(args)...);
+  }
+
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<T, E> with_context(const char *what,
+                                                  Args &&... args) && {
+    return tao_result_with_context(std::move(*this), what,
+                                   std::forward<Args>(args)...);
+  }
+
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<T, E> with_context(const char *what,
+                                                  Args &&... args) const & {
+    return tao_result_with_context(*this, what, std::forward<Args>(args)...);
+  }
+
+  /// Constructs a result holding a value-initialized `T`.
+  /// \group ctor_default
+  constexpr result() = default;
+
+  /// Copy constructor
+  ///
+  /// Copies either the value or the error from `rhs`.
+  constexpr result(const result &rhs) = default;
+
+  /// Move constructor
+  ///
+  /// Moves either the value or the error from `rhs`.
+  constexpr result(result &&rhs) = default;
+
+  /// Constructs the stored value in-place using the given arguments.
+  /// \group in_place
+  /// \synopsis template <typename... Args> constexpr explicit result(in_place_t, Args&&... args);
+  template <typename... Args,
+            detail::enable_if_t<std::is_constructible<T, Args &&...>::value> * =
+                nullptr>
+  constexpr explicit result(in_place_t, Args &&... args)
+      : base(in_place, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group in_place
+  /// \synopsis template <typename U, typename... Args>\nconstexpr explicit result(in_place_t, std::initializer_list<U>&, Args&&... args);
+  template <typename U, typename... Args,
+            detail::enable_if_t<std::is_constructible<
+                T, std::initializer_list<U> &, Args &&...>::value> * = nullptr>
+  constexpr explicit result(in_place_t, std::initializer_list<U> il,
+                            Args &&... args)
+      : base(in_place, il, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs the stored error in-place using the given arguments.
+  /// \group unexpect
+  /// \synopsis template <typename... Args> constexpr explicit result(unexpect_t, Args&&... args);
+  template <typename... Args,
+            detail::enable_if_t<std::is_constructible<E, Args &&...>::value> * =
+                nullptr>
+  constexpr explicit result(TAO_RESULT_UNEXPECT_PARAM, Args &&... args)
+      : base(unexpect, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// \group unexpect
+  /// \synopsis template <typename U, typename... Args>\nconstexpr explicit result(unexpect_t, std::initializer_list<U>&, Args&&... args);
+  template <typename U, typename... Args,
+            detail::enable_if_t<std::is_constructible<
+                E, std::initializer_list<U> &, Args &&...>::value> * = nullptr>
+  constexpr explicit result(TAO_RESULT_UNEXPECT_PARAM,
+                            std::initializer_list<U> il, Args &&... args)
+      : base(unexpect, il, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// Uses-allocator construction: the value or the error is constructed
+  /// with `a` after `std::allocator_arg`, with `a` as the last argument, or
+  /// without it, depending on how it takes an allocator. When `T` or `E` is
+  /// allocator-aware, as the `std::pmr` containers are, the result keeps `a`
+  /// (converted to its `allocator_type`) and constructs every later value
+  /// and error with it, so a whole graph of results can live in one arena.
+  /// \group allocator_arg
+  template <typename Alloc, typename U = T,
+            detail::enable_if_t<std::is_default_constructible<U>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a)
+      : base(std::allocator_arg, a, in_place),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename... Args>\nresult(std::allocator_arg_t, const Alloc &a, in_place_t, Args&&... args);
+  template <typename Alloc, typename... Args,
+            detail::enable_if_t<std::is_constructible<T, Args &&...>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                in_place_t, Args &&... args)
+      : base(std::allocator_arg, a, in_place, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename... Args>\nresult(std::allocator_arg_t, const Alloc &a, unexpect_t, Args&&... args);
+  template <typename Alloc, typename... Args,
+            detail::enable_if_t<std::is_constructible<E, Args &&...>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                TAO_RESULT_UNEXPECT_PARAM, Args &&... args)
+      : base(std::allocator_arg, a, unexpect, std::forward<Args>(args)...),
+        ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename U=T>\nresult(std::allocator_arg_t, const Alloc &a, U&& u);
+  template <typename Alloc, typename U = T,
+            detail::enable_result_forward_value<T, E, U> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a, U &&u)
+      : base(std::allocator_arg, a, in_place, std::forward<U>(u)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  template <typename Alloc, typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                const unexpected<G> &e)
+      : base(std::allocator_arg, a, unexpect, e.value()),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  template <typename Alloc, typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                unexpected<G> &&e)
+      : base(std::allocator_arg, a, unexpect, std::move(e.value())),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                const result &rhs)
+      : base(std::allocator_arg, a, detail::from_storage_t{},
+             static_cast<const base &>(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                result &&rhs)
+      : base(std::allocator_arg, a, detail::from_storage_t{},
+             static_cast<base &&>(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs the stored error from an `unexpected`.
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(const unexpected<G>& e);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<const G &, E>::value> * = nullptr>
+  constexpr result(const unexpected<G> &e TAO_RESULT_SITE_PARAM)
+      : base(unexpect, e.value()), ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<const G &, E>::value> * = nullptr>
+  constexpr explicit result(const unexpected<G> &e TAO_RESULT_SITE_PARAM)
+      : base(unexpect, e.value()), ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(unexpected<G>&& e);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<G &&, E>::value> * = nullptr>
+  constexpr result(unexpected<G> &&e TAO_RESULT_SITE_PARAM) noexcept(
+      std::is_nothrow_constructible<E, G &&>::value)
+      : base(unexpect, std::move(e.value())),
+        ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<G &&, E>::value> * = nullptr>
+  constexpr explicit result(unexpected<G> &&e TAO_RESULT_SITE_PARAM) noexcept(
+      std::is_nothrow_constructible<E, G &&>::value)
+      : base(unexpect, std::move(e.value())),
+        ctor_base(detail::default_ctor_tag{}) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// Constructs the stored value with `u`.
+  /// \synopsis template <typename U=T> constexpr result(U&& u);
+  template <
+      typename U = T,
+      detail::enable_if_t<std::is_convertible<U &&, T>::value> * = nullptr,
+      detail::enable_result_forward_value<T, E, U> * = nullptr>
+  constexpr result(U &&u)
+      : base(in_place, std::forward<U>(u)), ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <
+      typename U = T,
+      detail::enable_if_t<!std::is_convertible<U &&, T>::value> * = nullptr,
+      detail::enable_result_forward_value<T, E, U> * = nullptr>
+  constexpr explicit result(U &&u)
+      : base(in_place, std::forward<U>(u)), ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Converting copy constructor.
+  /// \synopsis template <typename U, typename G> result(const result<U, G>& rhs);
+  template <typename U, typename G,
+            detail::enable_result_from_other<T, E, U, G, const U &, const G &> * = nullptr,
+            detail::enable_if_t<std::is_convertible<const U &, T>::value &&
+                                std::is_convertible<const G &, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result(const result<U, G> &rhs)
+      : base(detail::from_result_t{}, rhs), ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <typename U, typename G,
+            detail::enable_result_from_other<T, E, U, G, const U &, const G &> * = nullptr,
+            detail::enable_if_t<!(std::is_convertible<const U &, T>::value &&
+                                  std::is_convertible<const G &, E>::value)> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(const result<U, G> &rhs)
+      : base(detail::from_result_t{}, rhs), ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Converting move constructor.
+  /// \synopsis template <typename U, typename G> result(result<U, G>&& rhs);
+  template <typename U, typename G,
+            detail::enable_result_from_other<T, E, U, G, U &&, G &&> * = nullptr,
+            detail::enable_if_t<std::is_convertible<U &&, T>::value &&
+                                std::is_convertible<G &&, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result(result<U, G> &&rhs)
+      : base(detail::from_result_t{}, std::move(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+  /// \exclude
+  template <typename U, typename G,
+            detail::enable_result_from_other<T, E, U, G, U &&, G &&> * = nullptr,
+            detail::enable_if_t<!(std::is_convertible<U &&, T>::value &&
+                                  std::is_convertible<G &&, E>::value)> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(result<U, G> &&rhs)
+      : base(detail::from_result_t{}, std::move(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+  /// Constructs from a `std::expected`, copying its value or its error.
+  /// \group ctor_std
+  /// \synopsis template <typename U, typename G> result(const std::expected<U, G>& rhs);
+  template <typename U, typename G,
+            detail::enable_result_from_std<T, E, U, G, const U &, const G &> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit(!(std::is_convertible<const U &, T>::value &&
+                                    std::is_convertible<const G &, E>::value))
+      result(const std::expected<U, G> &rhs)
+      : base(detail::from_result_t{}, rhs), ctor_base(detail::default_ctor_tag{}) {}
+
+  /// Constructs from a `std::expected`, moving its value or its error.
+  /// \group ctor_std
+  /// \synopsis template <typename U, typename G> result(std::expected<U, G>&& rhs);
+  template <typename U, typename G,
+            detail::enable_result_from_std<T, E, U, G, U &&, G &&> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit(!(std::is_convertible<U &&, T>::value &&
+                                    std::is_convertible<G &&, E>::value))
+      result(std::expected<U, G> &&rhs)
+      : base(detail::from_result_t{}, std::move(rhs)),
+        ctor_base(detail::default_ctor_tag{}) {}
+#endif
+
+  /// Destroys the stored value or error.
+  ~result() = default;
+
+  /// Copy assignment.
+  ///
+  /// Copies the value or the error from `rhs`, destroying whatever `*this`
+  /// held if the alternative changes.
+  result &operator=(const result &rhs) = default;
+
+  /// Move assignment.
+  ///
+  /// Moves the value or the error from `rhs`, destroying whatever `*this`
+  /// held if the alternative changes.
+  result &operator=(result &&rhs) = default;
+
+  /// Assigns the stored value from `u`, destroying the error if there was
+  /// one.
+  /// \synopsis result &operator=(U&& u);
+  template <typename U = T, detail::enable_result_assign_forward<T, E, U> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(U &&u) {
+    this->assign_value(std::forward<U>(u));
+    return *this;
+  }
+
+  /// Assigns the stored error from `e`, destroying the value if there was
+  /// one.
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(const unexpected<G>& e);
+  template <typename G, detail::enable_result_assign_error<T, E, const G &> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(const unexpected<G> &e) {
+    this->assign_error(e.value());
+    return *this;
+  }
+
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(unexpected<G>&& e);
+  template <typename G, detail::enable_result_assign_error<T, E, G &&> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(unexpected<G> &&e) {
+    this->assign_error(std::move(e.value()));
+    return *this;
+  }
+
+  /// Constructs the value in-place, destroying the current value or error.
+  /// \group emplace
+  template <typename... Args>
+  TAO_RESULT_CONSTEXPR20 T &emplace(Args &&... args) {
+    static_assert(std::is_constructible<T, Args &&...>::value,
+                  "T must be constructible with Args");
+
+    this->emplace_value(std::forward<Args>(args)...);
+    return **this;
+  }
+
+  /// \group emplace
+  /// \synopsis template <typename U, typename... Args>\nT& emplace(std::initializer_list<U> il, Args &&... args);
+  template <typename U, typename... Args>
+  TAO_RESULT_CONSTEXPR20 detail::enable_if_t<
+      std::is_constructible<T, std::initializer_list<U> &, Args &&...>::value,
+      T &>
+  emplace(std::initializer_list<U> il, Args &&... args) {
+    this->emplace_value(il, std::forward<Args>(args)...);
+    return **this;
+  }
+
+  /// \group emplace
+  /// Uses-allocator construction of the new value with `a`, see
+  /// `result(std::allocator_arg_t, const Alloc&)`.
+  /// \synopsis template <typename Alloc, typename... Args>\nT& emplace(std::allocator_arg_t, const Alloc &a, Args &&... args);
+  template <typename Alloc, typename... Args>
+  TAO_RESULT_CONSTEXPR20 T &emplace(std::allocator_arg_t, Alloc &&a,
+                                    Args &&... args) {
+    this->emplace_value_with_allocator(a, std::forward<Args>(args)...);
+    return **this;
+  }
+
+  /// \returns the allocator of the value or the error, or the one the
+  /// result keeps when that member takes none
+  /// \requires `T` or `E` is allocator-aware: it has a stateful
+  /// `allocator_type` and a `get_allocator()`, as the `std::pmr` containers
+  /// do. The allocator is `T`'s if `T` is, otherwise `E`'s.
+  /// \synopsis allocator_type get_allocator() const noexcept;
+  template <typename U = T,
+            detail::enable_if_t<detail::is_allocator_aware<U>::value ||
+                                detail::is_allocator_aware<E>::value> * =
+                nullptr>
+  typename detail::result_allocator<U, E>::type get_allocator() const noexcept {
+    return base::get_allocator();
+  }
+
+  /// Swaps this result with the other.
+  ///
+  /// If both hold values (or both hold errors) they are swapped with `swap`.
+  /// Otherwise the value and the error change places.
+  TAO_RESULT_CONSTEXPR20 void swap(result &rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      detail::is_nothrow_swappable<T>::value &&
+      std::is_nothrow_move_constructible<E>::value &&
+      detail::is_nothrow_swappable<E>::value) {
+    using std::swap;
+    if (has_value() && rhs.has_value()) {
+      swap(**this, *rhs);
+    } else if (!has_value() && !rhs.has_value()) {
+      swap(error(), rhs.error());
+    } else if (detail::engaged(*this)) {
+      rhs.swap(*this);
+    } else if (detail::is_allocator_aware<T>::value ||
+               detail::is_allocator_aware<E>::value) {
+      swap_error_with_value_using_allocator(rhs);
+    } else {
+      // *this holds the error, rhs holds the value
+      swap_error_with_value(
+          std::integral_constant<
+              bool, std::is_nothrow_move_constructible<E>::value>{},
+          rhs);
+    }
+  }
+
+private:
+  // Each side keeps its allocator: the value and the error are constructed
+  // anew with it instead of moving across as they are. Out of swap so that
+  // the rethrow is not inside its noexcept.
+  TAO_RESULT_CONSTEXPR20 void swap_error_with_value_using_allocator(
+      result &rhs) {
+    E tmp(std::move(error()));
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+    try {
+      this->emplace_value(std::move(*rhs));
+    } catch (...) {
+      // A failed emplace_value leaves the error in place, moved from
+      this->emplace_error(std::move(tmp));
+      throw;
+    }
+#else
+    this->emplace_value(std::move(*rhs));
+#endif
+    rhs.emplace_error(std::move(tmp));
+  }
+
+  // The error of *this and the value of rhs change places. Whichever move
+  // may throw is done while the member it came from can still be restored,
+  // so if it throws, both results are left as they were.
+  TAO_RESULT_CONSTEXPR20 void swap_error_with_value(std::true_type,
+                                                    result &rhs) {
+    E tmp(std::move(error()));
+    error().~E();
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+    try {
+      detail::construct_at(std::addressof(this->value_), std::move(*rhs));
+    } catch (...) {
+      detail::construct_at(std::addressof(this->error_), std::move(tmp));
+      throw;
+    }
+#else
+    detail::construct_at(std::addressof(this->value_), std::move(*rhs));
+#endif
+    this->has_value_ = true;
+    rhs.value_.~T();
+    detail::construct_at(std::addressof(rhs.error_), std::move(tmp));
+    rhs.has_value_ = false;
+  }
+
+  TAO_RESULT_CONSTEXPR20 void swap_error_with_value(std::false_type,
+                                                    result &rhs) {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "swapping a value with an error requires T or E to be "
+                  "nothrow move constructible");
+    T tmp(std::move(*rhs));
+    rhs.value_.~T();
+#ifndef TAO_RESULT_NO_EXCEPTIONS
+    try {
+      detail::construct_at(std::addressof(rhs.error_), std::move(error()));
+    } catch (...) {
+      detail::construct_at(std::addressof(rhs.value_), std::move(tmp));
+      throw;
+    }
+#else
+    detail::construct_at(std::addressof(rhs.error_), std::move(error()));
+#endif
+    rhs.has_value_ = false;
+    error().~E();
+    detail::construct_at(std::addressof(this->value_), std::move(tmp));
+    this->has_value_ = true;
+  }
+
+public:
+
+  /// \returns a pointer to the stored value
+  /// \requires a value is stored
+  /// \group pointer
+  /// \synopsis constexpr const T *operator->() const;
+  constexpr const T *operator->() const {
+    return std::addressof(this->value_);
+  }
+
+  /// \group pointer
+  /// \synopsis constexpr T *operator->();
+  constexpr T *operator->() {
+    return std::addressof(this->value_);
+  }
+
+  /// \returns the stored value
+  /// \requires a value is stored
+  /// \group deref
+  /// \synopsis constexpr T &operator*();
+  constexpr T &operator*() & { return this->value_; }
+
+  /// \group deref
+  /// \synopsis constexpr const T &operator*() const;
+  constexpr const T &operator*() const & { return this->value_; }
+
+  /// \exclude
+  constexpr T &&operator*() && { return std::move(this->value_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  constexpr const T &&operator*() const && { return std::move(this->value_); }
+#endif
+
+  /// \returns whether or not the result holds a value
+  /// \group has_value
+  constexpr bool has_value() const noexcept { return this->has_value_; }
+
+  /// \group has_value
+  constexpr explicit operator bool() const noexcept {
+    return this->has_value_;
+  }
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+  /// Converts to a `std::expected<T, E>` holding a copy of the value or of
+  /// the error.
+  /// \group to_std
+  /// \synopsis constexpr operator std::expected<T, E>() const &;
+  template <typename U = T,
+            detail::enable_if_t<std::is_copy_constructible<U>::value &&
+                                std::is_copy_constructible<E>::value> * = nullptr>
+  constexpr operator std::expected<T, E>() const & {
+    if (detail::engaged(*this))
+      return std::expected<T, E>(std::in_place, this->value_);
+    return std::expected<T, E>(std::unexpect, this->error_);
+  }
+
+  /// Converts to a `std::expected<T, E>`, moving the value or the error in.
+  /// \group to_std
+  /// \synopsis constexpr operator std::expected<T, E>() &&;
+  template <typename U = T,
+            detail::enable_if_t<std::is_move_constructible<U>::value &&
+                                std::is_move_constructible<E>::value> * = nullptr>
+  constexpr operator std::expected<T, E>() && {
+    if (detail::engaged(*this))
+      return std::expected<T, E>(std::in_place, std::move(this->value_));
+    return std::expected<T, E>(std::unexpect, std::move(this->error_));
+  }
+#endif
+
+  /// \returns the contained value if there is one, otherwise throws
+  /// [bad_result_access] carrying a copy of the error (or calls the failure
+  /// handler when built with `TAO_RESULT_NO_EXCEPTIONS`)
+  /// \group value
+  /// \synopsis constexpr T &value();
+  constexpr T &value(TAO_RESULT_SITE_ONLY_PARAM) & {
+    if (detail::engaged(*this))
+      return this->value_;
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_result_access(this->error_);
+  }
+  /// \group value
+  /// \synopsis constexpr const T &value() const;
+  constexpr const T &value(TAO_RESULT_SITE_ONLY_PARAM) const & {
+    if (detail::engaged(*this))
+      return this->value_;
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_result_access(this->error_);
+  }
+  /// \exclude
+  constexpr T &&value(TAO_RESULT_SITE_ONLY_PARAM) && {
+    if (detail::engaged(*this))
+      return std::move(this->value_);
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_result_access(std::move(this->error_));
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  constexpr const T &&value(TAO_RESULT_SITE_ONLY_PARAM) const && {
+    if (detail::engaged(*this))
+      return std::move(this->value_);
+    TAO_RESULT_RECORD(true, bad_access);
+    detail::throw_bad_result_access(this->error_);
+  }
+#endif
+
+  /// \returns the stored error
+  /// \requires an error is stored
+  /// \group error
+  /// \synopsis constexpr E &error();
+  constexpr E &error() & { return this->error_; }
+
+  /// \group error
+  /// \synopsis constexpr const E &error() const;
+  constexpr const E &error() const & { return this->error_; }
+
+  /// \exclude
+  constexpr E &&error() && { return std::move(this->error_); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  constexpr const E &&error() const && { return std::move(this->error_); }
+#endif
+
+  /// \returns the stored value if there is one, otherwise returns `u`
+  /// \group value_or
+  template <typename U> constexpr T value_or(U &&u) const & {
+    static_assert(std::is_copy_constructible<T>::value &&
+                      std::is_convertible<U &&, T>::value,
+                  "T must be copy constructible and convertible from U");
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(std::forward<U>(u));
+  }
+
+  /// \group value_or
+  template <typename U> constexpr T value_or(U &&u) && {
+    static_assert(std::is_move_constructible<T>::value &&
+                      std::is_convertible<U &&, T>::value,
+                  "T must be move constructible and convertible from U");
+    if (detail::engaged(*this))
+      return std::move(**this);
+    return static_cast<T>(std::forward<U>(u));
+  }
+
+  /// \returns the stored value if there is one, otherwise the result of
+  /// invoking `f` with the stored error. `f` is only called when `*this`
+  /// holds an error.
+  /// \group value_or_else
+  template <typename F> constexpr T value_or_else(F &&f) const & {
+    static_assert(std::is_copy_constructible<T>::value &&
+                      std::is_convertible<detail::invoke_result_t<F, const E &>, T>::value,
+                  "T must be copy constructible and convertible from the "
+                  "result of F");
+    if (detail::engaged(*this))
+      return **this;
+    return static_cast<T>(detail::invoke(std::forward<F>(f), error()));
+  }
+
+  /// \group value_or_else
+  template <typename F> constexpr T value_or_else(F &&f) && {
+    static_assert(std::is_move_constructible<T>::value &&
+                      std::is_convertible<detail::invoke_result_t<F, E &&>, T>::value,
+                  "T must be move constructible and convertible from the "
+                  "result of F");
+    if (detail::engaged(*this))
+      return std::move(**this);
+    return static_cast<T>(
+        detail::invoke(std::forward<F>(f), std::move(error())));
+  }
+};
+
+/// A `result<void, E>` either succeeded, carrying nothing, or holds an error
+/// of type `E`. It is laid out as `E` plus one discriminant byte; if `E`
+/// declares a niche through `optional_traits`, the niche value means success
+/// and `sizeof(result<void, E>) == sizeof(E)`.
+///
+/// *Examples*:
+/// ```
+/// tao::result<void, std::errc> close(int fd);
+///
+/// if (auto r = close(fd); !r) {
+///     report(r.error());
+/// }
+/// ```
+template <typename E>
+class result<void, E> : private detail::result_void_base<E>,
+                        private detail::result_delete_ctor_base<monostate, E>,
+                        private detail::result_delete_assign_base<monostate, E> {
+  using base = detail::result_void_base<E>;
+
+  static_assert(!std::is_reference<E>::value, "E must not be a reference");
+  static_assert(!std::is_void<E>::value, "E must not be void");
+
+public:
+  using value_type = void;
+  using error_type = E;
+  using unexpected_type = unexpected<E>;
+
+  /// \group and_then
+  /// Carries out some operation which returns a result if `*this` holds no
+  /// error. \requires `std::invoke(std::forward<F>(f))` returns a
+  /// `tao::result<U, E>` for some `U`. \returns The error of `*this` if there
+  /// is one, otherwise the return value of `std::invoke(std::forward<F>(f))`.
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &;
+  template <typename F>
+  constexpr detail::invoke_result_t<F> and_then(F &&f) & {
+    using ret_t = detail::invoke_result_t<F>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f));
+    return detail::make_off_path<result, ret_t>(unexpect, error());
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) &&;
+  template <typename F>
+  constexpr detail::invoke_result_t<F> and_then(F &&f) && {
+    using ret_t = detail::invoke_result_t<F>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f));
+    return detail::make_off_path<result, ret_t>(unexpect,
+                                                std::move(error()));
+  }
+
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) const &;
+  template <typename F>
+  constexpr detail::invoke_result_t<F> and_then(F &&f) const & {
+    using ret_t = detail::invoke_result_t<F>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f));
+    return detail::make_off_path<result, ret_t>(unexpect, error());
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group and_then
+  /// \synopsis template <typename F>\nconstexpr auto and_then(F &&f) const &&;
+  template <typename F>
+  constexpr detail::invoke_result_t<F> and_then(F &&f) const && {
+    using ret_t = detail::invoke_result_t<F>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f));
+    return detail::make_off_path<result, ret_t>(unexpect,
+                                                std::move(error()));
+  }
+#endif
+
+  /// \brief Calls `f` if `*this` holds no error.
+  /// \returns Let `U` be the result of `std::invoke(std::forward<F>(f))`.
+  /// Returns a `tao::result<U, E>` holding either that value or the error of
+  /// `*this`.
+  ///
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &;
+  template <typename F>
+  constexpr result<detail::invoke_result_t<F>, E> map(F &&f) & {
+    return detail::result_void_map_impl(*this, std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) &&;
+  template <typename F>
+  constexpr result<detail::invoke_result_t<F>, E> map(F &&f) && {
+    return detail::result_void_map_impl(std::move(*this), std::forward<F>(f));
+  }
+
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) const &;
+  template <typename F>
+  constexpr result<detail::invoke_result_t<F>, E> map(F &&f) const & {
+    return detail::result_void_map_impl(*this, std::forward<F>(f));
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group map
+  /// \synopsis template <typename F> constexpr auto map(F &&f) const &&;
+  template <typename F>
+  constexpr result<detail::invoke_result_t<F>, E> map(F &&f) const && {
+    return detail::result_void_map_impl(std::move(*this), std::forward<F>(f));
+  }
+#endif
+
+  /// \brief Carries out some operation on the stored error if there is one.
+  /// \returns Let `G` be the result of `std::invoke(std::forward<F>(f),
+  /// error())`. Returns a `tao::result<void, G>`.
+  ///
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) &;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, void, E &>
+  map_error(F &&f) & {
+    return detail::result_void_map_error_impl(*this, std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) &&;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, void, E &&>
+  map_error(F &&f) && {
+    return detail::result_void_map_error_impl(std::move(*this),
+                                              std::forward<F>(f));
+  }
+
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) const &;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, void, const E &>
+  map_error(F &&f) const & {
+    return detail::result_void_map_error_impl(*this, std::forward<F>(f));
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \group map_error
+  /// \synopsis template <typename F> constexpr auto map_error(F &&f) const &&;
+  template <typename F>
+  constexpr detail::get_result_map_error_return<F, void, const E &&>
+  map_error(F &&f) const && {
+    return detail::result_void_map_error_impl(std::move(*this),
+                                              std::forward<F>(f));
+  }
+#endif
+
+  /// \brief Calls `f` with the error if the result holds one
+  /// \requires `std::invoke_result_t<F, E>` must be void or convertible to
+  /// `result<void, E>`.
+  /// \effects If `*this` has no error, returns `*this`.
+  /// Otherwise, if `f` returns `void`, calls `std::forward<F>(f)(error())` and
+  /// returns `*this`. Otherwise, returns `std::forward<F>(f)(error())`.
+  ///
+  /// \group or_else
+  /// \synopsis template <typename F> result<void, E> or_else (F &&f) &;
+  template <typename F, detail::enable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return *this;
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return detail::invoke(std::forward<F>(f), error());
+  }
+
+  /// \group or_else
+  /// \synopsis template <typename F> result<void, E> or_else (F &&f) &&;
+  template <typename F, detail::enable_if_ret_void<F, E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return std::move(*this);
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, E &&> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return detail::invoke(std::forward<F>(f), std::move(error()));
+  }
+
+  /// \group or_else
+  /// \synopsis template <typename F> result<void, E> or_else (F &&f) const &;
+  template <typename F, detail::enable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return *this;
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const & {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return *this;
+    return detail::invoke(std::forward<F>(f), error());
+  }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  template <typename F, detail::enable_if_ret_void<F, const E &> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (!detail::engaged(*this))
+      detail::invoke(std::forward<F>(f), error());
+
+    return std::move(*this);
+  }
+
+  /// \exclude
+  template <typename F, detail::disable_if_ret_void<F, const E &&> * = nullptr>
+  result constexpr or_else(F &&f TAO_RESULT_SITE_PARAM) const && {
+    TAO_RESULT_RECORD(!has_value(), or_else_fallback);
+    if (detail::engaged(*this))
+      return std::move(*this);
+    return detail::invoke(std::forward<F>(f), std::move(error()));
+  }
+#endif
+
+  /// \brief Attaches a context frame to the error, if there is one.
+  /// \details The frame records `what` and a copy of `args`; nothing is
+  /// formatted until the context is written out, where each `{}` in `what`
+  /// is replaced by the next argument. Frames live in the current context
+  /// arena, so the error path does not allocate. `what` must outlive the
+  /// frame (typically a string literal). Requires `<tao/result/context.hpp>`.
+  /// \returns `*this` when `E` is already a `contextual<E0>`, otherwise the
+  /// result converted to `result<void, contextual<E>>`.
+  ///
+  /// *Examples*:
+  /// ```
+  /// return parse(bytes).with_context("while parsing header {} at offset {}",
+  ///                                  name, offset);
+  /// ```
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<void, E> with_context(const char *what,
+                                                     Args &&... args) & {
+    return tao_result_with_context(*this, what, std::forward<Args>(args)...);
+  }
+
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<void, E> with_context(const char *what,
+                                                     Args &&... args) && {
+    return tao_result_with_context(std::move(*this), what,
+                                   std::forward<Args>(args)...);
+  }
+
+  /// \group with_context
+  template <typename... Args>
+  detail::with_context_result<void, E> with_context(const char *what,
+                                                     Args &&... args) const & {
+    return tao_result_with_context(*this, what, std::forward<Args>(args)...);
+  }
+
+  /// Constructs a result that holds no error.
+  /// \group ctor_default
+  constexpr result() = default;
+
+  /// Copy constructor
+  constexpr result(const result &rhs) = default;
+
+  /// Move constructor
+  constexpr result(result &&rhs) = default;
+
+  /// Constructs a result that holds no error.
+  constexpr explicit result(in_place_t) : base(in_place) {}
+
+  /// Constructs the stored error in-place using the given arguments.
+  /// \group unexpect
+  /// \synopsis template <typename... Args> constexpr explicit result(unexpect_t, Args&&... args);
+  template <typename... Args,
+            detail::enable_if_t<std::is_constructible<E, Args &&...>::value> * =
+                nullptr>
+  constexpr explicit result(TAO_RESULT_UNEXPECT_PARAM, Args &&... args)
+      : base(unexpect, std::forward<Args>(args)...) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// Uses-allocator construction of the error, as for `result<T, E>`.
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a)
+      : base(std::allocator_arg, a, in_place) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                in_place_t)
+      : base(std::allocator_arg, a, in_place) {}
+
+  /// \group allocator_arg
+  /// \synopsis template <typename Alloc, typename... Args>\nresult(std::allocator_arg_t, const Alloc &a, unexpect_t, Args&&... args);
+  template <typename Alloc, typename... Args,
+            detail::enable_if_t<std::is_constructible<E, Args &&...>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                TAO_RESULT_UNEXPECT_PARAM, Args &&... args)
+      : base(std::allocator_arg, a, unexpect, std::forward<Args>(args)...) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// \group allocator_arg
+  template <typename Alloc, typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                const unexpected<G> &e)
+      : base(std::allocator_arg, a, unexpect, e.value()) {}
+
+  /// \group allocator_arg
+  template <typename Alloc, typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * =
+                nullptr>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                unexpected<G> &&e)
+      : base(std::allocator_arg, a, unexpect, std::move(e.value())) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                const result &rhs)
+      : base(std::allocator_arg, a, detail::from_storage_t{},
+             static_cast<const base &>(rhs)) {}
+
+  /// \group allocator_arg
+  template <typename Alloc>
+  TAO_RESULT_CONSTEXPR20 result(std::allocator_arg_t, const Alloc &a,
+                                result &&rhs)
+      : base(std::allocator_arg, a, detail::from_storage_t{},
+             static_cast<base &&>(rhs)) {}
+
+  /// \returns the allocator of the error, or the one the result keeps
+  /// while it holds no error
+  /// \requires `E` is allocator-aware
+  /// \synopsis typename E::allocator_type get_allocator() const noexcept;
+  template <typename G = E,
+            detail::enable_if_t<detail::is_allocator_aware<G>::value> * =
+                nullptr>
+  typename G::allocator_type get_allocator() const noexcept {
+    return base::get_allocator();
+  }
+
+  /// \group unexpect
+  /// \synopsis template <typename U, typename... Args>\nconstexpr explicit result(unexpect_t, std::initializer_list<U>&, Args&&... args);
+  template <typename U, typename... Args,
+            detail::enable_if_t<std::is_constructible<
+                E, std::initializer_list<U> &, Args &&...>::value> * = nullptr>
+  constexpr explicit result(TAO_RESULT_UNEXPECT_PARAM,
+                            std::initializer_list<U> il, Args &&... args)
+      : base(unexpect, il, std::forward<Args>(args)...) {
+    TAO_RESULT_RECORD_UNEXPECT();
+  }
+
+  /// Constructs the stored error from an `unexpected`.
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(const unexpected<G>& e);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<const G &, E>::value> * = nullptr>
+  constexpr result(const unexpected<G> &e TAO_RESULT_SITE_PARAM)
+      : base(unexpect, e.value()) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<const G &, E>::value> * = nullptr>
+  constexpr explicit result(const unexpected<G> &e TAO_RESULT_SITE_PARAM)
+      : base(unexpect, e.value()) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \group ctor_unexpected
+  /// \synopsis template <typename G> constexpr result(unexpected<G>&& e);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<G &&, E>::value> * = nullptr>
+  constexpr result(unexpected<G> &&e TAO_RESULT_SITE_PARAM) noexcept(
+      std::is_nothrow_constructible<E, G &&>::value)
+      : base(unexpect, std::move(e.value())) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<G &&, E>::value> * = nullptr>
+  constexpr explicit result(unexpected<G> &&e TAO_RESULT_SITE_PARAM) noexcept(
+      std::is_nothrow_constructible<E, G &&>::value)
+      : base(unexpect, std::move(e.value())) {
+    TAO_RESULT_RECORD(true, error_construct);
+  }
+
+  /// Converting copy constructor.
+  /// \synopsis template <typename G> result(const result<void, G>& rhs);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<const G &, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result(const result<void, G> &rhs) : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(rhs.error());
+    }
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<const G &, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(const result<void, G> &rhs) : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(rhs.error());
+    }
+  }
+
+  /// Converting move constructor.
+  /// \synopsis template <typename G> result(result<void, G>&& rhs);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<std::is_convertible<G &&, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result(result<void, G> &&rhs) : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(std::move(rhs.error()));
+    }
+  }
+
+  /// \exclude
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr,
+            detail::enable_if_t<!std::is_convertible<G &&, E>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit result(result<void, G> &&rhs) : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(std::move(rhs.error()));
+    }
+  }
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+  /// Constructs from a `std::expected<void, G>`, copying its error if there
+  /// is one.
+  /// \group ctor_std
+  /// \synopsis template <typename G> result(const std::expected<void, G>& rhs);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, const G &>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit(!std::is_convertible<const G &, E>::value)
+      result(const std::expected<void, G> &rhs)
+      : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(rhs.error());
+    }
+  }
+
+  /// Constructs from a `std::expected<void, G>`, moving its error if there
+  /// is one.
+  /// \group ctor_std
+  /// \synopsis template <typename G> result(std::expected<void, G>&& rhs);
+  template <typename G,
+            detail::enable_if_t<std::is_constructible<E, G &&>::value> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 explicit(!std::is_convertible<G &&, E>::value)
+      result(std::expected<void, G> &&rhs)
+      : base(in_place) {
+    if (!rhs.has_value()) {
+      this->emplace_error(std::move(rhs.error()));
+    }
+  }
+#endif
+
+  /// Destroys the stored error if there is one.
+  ~result() = default;
+
+  /// Copy assignment.
+  result &operator=(const result &rhs) = default;
+
+  /// Move assignment.
+  result &operator=(result &&rhs) = default;
+
+  /// Assigns the stored error from `e`.
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(const unexpected<G>& e);
+  template <typename G,
+            detail::enable_result_assign_error<monostate, E, const G &> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(const unexpected<G> &e) {
+    this->assign_error(e.value());
+    return *this;
+  }
+
+  /// \group assign_unexpected
+  /// \synopsis template <typename G> result &operator=(unexpected<G>&& e);
+  template <typename G,
+            detail::enable_result_assign_error<monostate, E, G &&> * = nullptr>
+  TAO_RESULT_CONSTEXPR20 result &operator=(unexpected<G> &&e) {
+    this->assign_error(std::move(e.value()));
+    return *this;
+  }
+
+  /// Destroys the error if there is one, so that `*this` holds no error.
+  TAO_RESULT_CONSTEXPR20 void emplace() noexcept { this->emplace_value(); }
+
+  /// Swaps this result with the other.
+  TAO_RESULT_CONSTEXPR20 void swap(result &rhs) noexcept(std::is_nothrow_move_constructible<E>::value &&
+                                  detail::is_nothrow_swappable<E>::value) {
+    using std::swap;
+    if (!has_value() && !rhs.has_value()) {
+      swap(error(), rhs.error());
+    } else if (!detail::engaged(*this)) {
+      rhs.emplace_error(std::move(error()));
+      this->emplace_value();
+    } else if (!rhs.has_value()) {
+      this->emplace_error(std::move(rhs.error()));
+      rhs.emplace_value();
+    }
+  }
+
+  /// Does nothing; provided so that `*r` is valid for every result.
+  /// \requires `*this` holds no error
+  constexpr void operator*() const noexcept {}
+
+  /// \returns whether or not the result holds no error
+  /// \group has_value
+  constexpr bool has_value() const noexcept { return base::has_value(); }
+
+  /// \group has_value
+  constexpr explicit operator bool() const noexcept { return has_value(); }
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+  /// Converts to a `std::expected<void, E>` holding a copy of the error, if
+  /// any.
+  /// \group to_std
+  /// \synopsis constexpr operator std::expected<void, E>() const &;
+  template <typename G = E,
+            detail::enable_if_t<std::is_copy_constructible<G>::value> * = nullptr>
+  constexpr operator std::expected<void, E>() const & {
+    if (detail::engaged(*this))
+      return std::expected<void, E>();
+    return std::expected<void, E>(std::unexpect, error());
+  }
+
+  /// Converts to a `std::expected<void, E>`, moving the error in if there is
+  /// one.
+  /// \group to_std
+  /// \synopsis constexpr operator std::expected<void, E>() &&;
+  template <typename G = E,
+            detail::enable_if_t<std::is_move_constructible<G>::value> * = nullptr>
+  constexpr operator std::expected<void, E>() && {
+    if (detail::engaged(*this))
+      return std::expected<void, E>();
+    return std::expected<void, E>(std::unexpect, std::move(error()));
+  }
+#endif
+
+  /// Throws [bad_result_access] carrying a copy of the error if there is one
+  /// (or calls the failure handler when built with `TAO_RESULT_NO_EXCEPTIONS`)
+  /// \group value
+  constexpr void value(TAO_RESULT_SITE_ONLY_PARAM) const & {
+    if (!detail::engaged(*this)) {
+      TAO_RESULT_RECORD(true, bad_access);
+      detail::throw_bad_result_access(error());
+    }
+  }
+
+  /// \exclude
+  constexpr void value(TAO_RESULT_SITE_ONLY_PARAM) && {
+    if (!detail::engaged(*this)) {
+      TAO_RESULT_RECORD(true, bad_access);
+      detail::throw_bad_result_access(std::move(error()));
+    }
+  }
+
+  /// \returns the stored error
+  /// \requires an error is stored
+  /// \group error
+  /// \synopsis constexpr E &error();
+  constexpr E &error() & { return this->geterr(); }
+
+  /// \group error
+  /// \synopsis constexpr const E &error() const;
+  constexpr const E &error() const & { return this->geterr(); }
+
+  /// \exclude
+  constexpr E &&error() && { return std::move(this->geterr()); }
+
+#ifndef TAO_OPTIONAL_NO_CONSTRR
+  /// \exclude
+  constexpr const E &&error() const && { return std::move(this->geterr()); }
+#endif
+};
+
+/// \group result_relop
+/// \brief Compares two result objects
+/// \details Two results are equal if both hold values that compare equal, or
+/// both hold errors that compare equal.
+template <typename T, typename E, typename U, typename G>
+inline constexpr bool operator==(const result<T, E> &lhs,
+                                 const result<U, G> &rhs) {
+  return lhs.has_value() == rhs.has_value() &&
+         (lhs.has_value() ? *lhs == *rhs : lhs.error() == rhs.error());
+}
+/// \group result_relop
+template <typename T, typename E, typename U, typename G>
+inline constexpr bool operator!=(const result<T, E> &lhs,
+                                 const result<U, G> &rhs) {
+  return lhs.has_value() != rhs.has_value() ||
+         (lhs.has_value() ? *lhs != *rhs : lhs.error() != rhs.error());
+}
+/// \group result_relop
+template <typename E, typename G>
+inline constexpr bool operator==(const result<void, E> &lhs,
+                                 const result<void, G> &rhs) {
+  return lhs.has_value() == rhs.has_value() &&
+         (lhs.has_value() || lhs.error() == rhs.error());
+}
+/// \group result_relop
+template <typename E, typename G>
+inline constexpr bool operator!=(const result<void, E> &lhs,
+                                 const result<void, G> &rhs) {
+  return lhs.has_value() != rhs.has_value() ||
+         (!lhs.has_value() && lhs.error() != rhs.error());
+}
+
+/// \group result_relop_t
+/// \brief Compares the result with a value.
+/// \details A result holding an error never compares equal to a value.
+template <typename T, typename E, typename U,
+          detail::enable_if_t<!detail::is_result<U>::value &&
+                              !detail::is_unexpected<U>::value> * = nullptr>
+inline constexpr bool operator==(const result<T, E> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs == rhs : false;
+}
+/// \group result_relop_t
+template <typename T, typename E, typename U,
+          detail::enable_if_t<!detail::is_result<U>::value &&
+                              !detail::is_unexpected<U>::value> * = nullptr>
+inline constexpr bool operator==(const U &lhs, const result<T, E> &rhs) {
+  return rhs.has_value() ? lhs == *rhs : false;
+}
+/// \group result_relop_t
+template <typename T, typename E, typename U,
+          detail::enable_if_t<!detail::is_result<U>::value &&
+                              !detail::is_unexpected<U>::value> * = nullptr>
+inline constexpr bool operator!=(const result<T, E> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs != rhs : true;
+}
+/// \group result_relop_t
+template <typename T, typename E, typename U,
+          detail::enable_if_t<!detail::is_result<U>::value &&
+                              !detail::is_unexpected<U>::value> * = nullptr>
+inline constexpr bool operator!=(const U &lhs, const result<T, E> &rhs) {
+  return rhs.has_value() ? lhs != *rhs : true;
+}
+
+/// \group result_relop_unexpected
+/// \brief Compares the result with an error.
+/// \details A result holding a value never compares equal to an error.
+template <typename T, typename E, typename G>
+inline constexpr bool operator==(const result<T, E> &lhs,
+                                 const unexpected<G> &rhs) {
+  return lhs.has_value() ? false : lhs.error() == rhs.value();
+}
+/// \group result_relop_unexpected
+template <typename T, typename E, typename G>
+inline constexpr bool operator==(const unexpected<G> &lhs,
+                                 const result<T, E> &rhs) {
+  return rhs.has_value() ? false : lhs.value() == rhs.error();
+}
+/// \group result_relop_unexpected
+template <typename T, typename E, typename G>
+inline constexpr bool operator!=(const result<T, E> &lhs,
+                                 const unexpected<G> &rhs) {
+  return lhs.has_value() ? true : lhs.error() != rhs.value();
+}
+/// \group result_relop_unexpected
+template <typename T, typename E, typename G>
+inline constexpr bool operator!=(const unexpected<G> &lhs,
+                                 const result<T, E> &rhs) {
+  return rhs.has_value() ? true : lhs.value() != rhs.error();
+}
+
+/// \synopsis template <typename T, typename E>\nvoid swap(result<T, E>& lhs, result<T, E>& rhs);
+template <typename T, typename E,
+          detail::enable_if_t<std::is_move_constructible<T>::value &&
+                              std::is_move_constructible<E>::value> * = nullptr,
+          detail::enable_if_t<detail::is_swappable<T>::value &&
+                              detail::is_swappable<E>::value> * = nullptr>
+TAO_RESULT_CONSTEXPR20
+void swap(result<T, E> &lhs,
+          result<T, E> &rhs) noexcept(noexcept(lhs.swap(rhs))) {
+  lhs.swap(rhs);
+}
+
+/// \synopsis template <typename E>\nvoid swap(result<void, E>& lhs, result<void, E>& rhs);
+template <typename E,
+          detail::enable_if_t<std::is_move_constructible<E>::value &&
+                              detail::is_swappable<E>::value> * = nullptr>
+TAO_RESULT_CONSTEXPR20
+void swap(result<void, E> &lhs,
+          result<void, E> &rhs) noexcept(noexcept(lhs.swap(rhs))) {
+  lhs.swap(rhs);
+}
+
+/// \brief Whether the platform calling convention passes and returns `T` in
+/// registers rather than through a hidden pointer to memory.
+///
+/// \details On x86-64 System V and AArch64 that is any type of at most 16
+/// bytes that is trivially destructible and whose non-deleted copy and move
+/// constructors are trivial, e.g. `result<std::uint32_t, std::uint16_t>` or
+/// `result<void, std::errc>` in RAX. The Windows x64 convention also requires
+/// an aggregate of 1, 2, 4 or 8 bytes, which a result never is. Other targets
+/// conservatively report false.
+///
+/// ```
+/// static_assert(tao::is_register_passable<tao::result<void, std::errc>>::value, "");
+/// ```
+template <typename T>
+struct is_register_passable
+    : std::integral_constant<
+          bool,
+          std::is_trivially_destructible<T>::value &&
+              (!std::is_copy_constructible<T>::value ||
+               TAO_OPTIONAL_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T)) &&
+              (!std::is_move_constructible<T>::value ||
+               std::is_trivially_move_constructible<T>::value) &&
+              (std::is_copy_constructible<T>::value ||
+               std::is_move_constructible<T>::value) &&
+#if defined(_WIN64)
+              (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+               sizeof(T) == 8) &&
+              !detail::is_result<T>::value && !detail::is_optional<T>::value
+#elif defined(__x86_64__) || defined(__aarch64__) || defined(_M_ARM64)
+              sizeof(T) <= 16
+#else
+              false
+#endif
+          > {
+};
+
+/// \brief Customization point telling whether a `T` can be relocated, that
+/// is move constructed into new storage with the source destroyed right
+/// after, by copying its bytes.
+///
+/// \details True by default for types that are trivially move constructible
+/// and trivially destructible. Other types opt in with a specialization, as
+/// long as no part of the object refers to its own address (libstdc++'s
+/// `std::string` does, with its small-string buffer):
+///
+/// ```
+/// namespace tao {
+/// template <> struct is_trivially_relocatable<file_handle> : std::true_type {};
+/// }
+/// ```
+///
+/// `optional<T>` and `result<T, E>` are trivially relocatable when their
+/// payloads are, and so are the standard smart pointers.
+/// `tao/result/relocate.hpp` adds the `relocate` algorithms.
+template <typename T>
+struct is_trivially_relocatable
+    : std::integral_constant<bool,
+                             std::is_trivially_move_constructible<T>::value &&
+                                 std::is_trivially_destructible<T>::value> {};
+
+template <typename T>
+struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+template <typename T>
+struct is_trivially_relocatable<optional<T>> : is_trivially_relocatable<T> {};
+
+template <typename T>
+struct is_trivially_relocatable<optional<T &>> : std::true_type {};
+
+template <typename T, typename E>
+struct is_trivially_relocatable<result<T, E>>
+    : detail::conjunction<is_trivially_relocatable<T>,
+                          is_trivially_relocatable<E>> {};
+
+template <typename E>
+struct is_trivially_relocatable<result<void, E>>
+    : is_trivially_relocatable<E> {};
+
+template <typename E>
+struct is_trivially_relocatable<unexpected<E>> : is_trivially_relocatable<E> {};
+
+// Defined here rather than next to the algorithms: optional::swap and the
+// inline storage of any_error branch on the trait, so every translation unit
+// must see the same answer
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+} // namespace tao
+
+namespace tao {
+/// \exclude
+namespace detail {
+
+template <typename T, typename = void> struct is_std_hashable : std::false_type {};
+template <typename T>
+struct is_std_hashable<
+    T, void_t<decltype(std::hash<T>()(std::declval<const T &>()))>>
+    : std::true_type {};
+
+// Hash of an empty optional: the 64-bit golden ratio, truncated on 32-bit
+// targets. It is far from the small integers std::hash commonly produces for
+// integral keys, so empty keys do not pile up in bucket 0.
+TAO_RESULT_INLINE_VAR constexpr std::size_t empty_optional_hash =
+    static_cast<std::size_t>(0x9e3779b97f4a7c15ULL);
+
+// Mixed into the hash of an error so that result<T, E> holding an error
+// does not collide with one holding an equal value
+TAO_RESULT_INLINE_VAR constexpr std::size_t result_error_salt =
+    static_cast<std::size_t>(0xc2b2ae3d27d4eb4fULL);
+
+// A disabled specialization, as [unord.hash] describes for std::hash<X>
+// when X is not hashable
+struct disabled_hash {
+  disabled_hash() = delete;
+  disabled_hash(const disabled_hash &) = delete;
+  disabled_hash &operator=(const disabled_hash &) = delete;
+};
+
+template <typename O, typename T, bool = is_std_hashable<T>::value>
+struct optional_hash : disabled_hash {};
+
+template <typename O, typename T> struct optional_hash<O, T, true> {
+  std::size_t operator()(const O &o) const {
+    return o.has_value() ? std::hash<T>()(*o) : empty_optional_hash;
+  }
+};
+
+template <typename R, typename T, typename E,
+          bool = is_std_hashable<T>::value && is_std_hashable<E>::value>
+struct result_hash : disabled_hash {};
+
+template <typename R, typename T, typename E>
+struct result_hash<R, T, E, true> {
+  std::size_t operator()(const R &r) const {
+    return r.has_value() ? std::hash<T>()(*r)
+                         : std::hash<E>()(r.error()) ^ result_error_salt;
+  }
+};
+
+template <typename R, typename E, bool = is_std_hashable<E>::value>
+struct result_void_hash : disabled_hash {};
+
+template <typename R, typename E> struct result_void_hash<R, E, true> {
+  std::size_t operator()(const R &r) const {
+    return r.has_value() ? empty_optional_hash
+                         : std::hash<E>()(r.error()) ^ result_error_salt;
+  }
+};
+} // namespace detail
+} // namespace tao
+
+namespace std {
+/// Hashes the value of an engaged optional exactly as `std::hash<T>` does.
+/// Empty optionals share a fixed, non-zero hash. Disabled when `T` has no
+/// `std::hash`.
+template <typename T>
+struct hash<tao::optional<T>>
+    : tao::detail::optional_hash<
+          tao::optional<T>,
+          tao::detail::remove_const_t<tao::detail::remove_reference_t<T>>> {};
+
+/// Hashes the value, or the error mixed with a salt. Disabled unless both
+/// `T` and `E` have a `std::hash`.
+template <typename T, typename E>
+struct hash<tao::result<T, E>>
+    : tao::detail::result_hash<tao::result<T, E>,
+                               tao::detail::remove_const_t<T>,
+                               tao::detail::remove_const_t<E>> {};
+
+/// A `result<void, E>` holding no error hashes to a fixed value. Disabled
+/// unless `E` has a `std::hash`.
+template <typename E>
+struct hash<tao::result<void, E>>
+    : tao::detail::result_void_hash<tao::result<void, E>,
+                                    tao::detail::remove_const_t<E>> {};
+
+/// An optional uses an allocator when its value does, so that allocator-aware
+/// containers such as `std::pmr::vector<tao::optional<T>>` pass theirs on.
+template <typename T, typename Alloc>
+struct uses_allocator<tao::optional<T>, Alloc> : uses_allocator<T, Alloc> {};
+
+/// A result uses an allocator when its value or its error does.
+template <typename T, typename E, typename Alloc>
+struct uses_allocator<tao::result<T, E>, Alloc>
+    : integral_constant<bool, uses_allocator<T, Alloc>::value ||
+                                  uses_allocator<E, Alloc>::value> {};
 } // namespace std
 
 #endif // TAO_RESULT_RESULT_HPP_
\ No newline at end of file
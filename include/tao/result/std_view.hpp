@@ -0,0 +1,170 @@
+//! \file tao/result/std_view.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_STD_VIEW_HPP_
+#define TAO_RESULT_STD_VIEW_HPP_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+// Non-owning adapters that give a std::optional or a std::expected the tao
+// monadic API in place, without copying the payload:
+//
+//   std::optional<user> &cached = cache.find(id);
+//   auto name = tao::optional_ref(cached).map(&user::name).value_or("?");
+//
+//   std::expected<config, std::errc> &loaded = store.config();
+//   tao::result<port, std::errc> p = tao::result_view(loaded).and_then(get_port);
+//
+// optional_ref returns an optional<T&> bound to the contained value, so it
+// reflects the source when it is called: reset the std::optional and the
+// reference dangles. result_view keeps a pointer to the std::expected and
+// always reads its current state. Neither may outlive its source. For owning
+// conversions, optional and result convert to and from the standard types
+// directly (see TAO_RESULT_HAS_STD_OPTIONAL and TAO_RESULT_HAS_STD_EXPECTED
+// in result.hpp).
+
+namespace tao {
+
+#ifdef TAO_RESULT_HAS_STD_OPTIONAL
+/// \brief Views the value of a `std::optional` as a `tao::optional<T&>`.
+/// \returns an optional referring to `*o` if `o` has a value, otherwise an
+/// empty one
+/// \group optional_ref
+template <typename T>
+constexpr optional<T &> optional_ref(std::optional<T> &o) noexcept {
+  if (o.has_value())
+    return optional<T &>(*o);
+  return nullopt;
+}
+
+/// \group optional_ref
+template <typename T>
+constexpr optional<const T &> optional_ref(const std::optional<T> &o) noexcept {
+  if (o.has_value())
+    return optional<const T &>(*o);
+  return nullopt;
+}
+
+/// \exclude
+template <typename T> void optional_ref(const std::optional<T> &&) = delete;
+#endif
+
+#ifdef TAO_RESULT_HAS_STD_EXPECTED
+/// \brief A non-owning view of a `std::expected<T, E>` with the monadic API
+/// of `tao::result`.
+///
+/// \details `Expected` is `std::expected<T, E>` or `const std::expected<T,
+/// E>`; value and error are handed to the callbacks by reference, as `T&` or
+/// `const T&`. The operations that produce a new result (`map`, `map_error`,
+/// `to_result`) return an owning `tao::result`, so `map` copies the error
+/// when there is one and `map_error` copies the value. `T` must not be
+/// `void`.
+///
+/// *Examples*:
+/// ```
+/// std::expected<row, db_error> &r = cursor.current();
+/// tao::result_view v(r);
+/// if (v) render(*v);
+/// auto id = v.map([](const row &x) { return x.id; });
+/// ```
+template <typename Expected> class result_view {
+  using expected_type = typename std::remove_const<Expected>::type;
+
+  static_assert(detail::is_std_expected<expected_type>::value,
+                "result_view requires a std::expected");
+  static_assert(!std::is_void<typename expected_type::value_type>::value,
+                "result_view of std::expected<void, E> is not supported");
+
+  using value_ref = decltype(*std::declval<Expected &>());
+  using error_ref = decltype(std::declval<Expected &>().error());
+
+public:
+  using value_type = typename expected_type::value_type;
+  using error_type = typename expected_type::error_type;
+
+  /// Views `e`, which must outlive the view.
+  constexpr explicit result_view(Expected &e) noexcept
+      : e_(std::addressof(e)) {}
+
+  /// \returns the viewed `std::expected`
+  constexpr Expected &get() const noexcept { return *e_; }
+
+  /// \returns whether the viewed `std::expected` holds a value
+  /// \group has_value
+  constexpr bool has_value() const noexcept { return e_->has_value(); }
+
+  /// \group has_value
+  constexpr explicit operator bool() const noexcept { return has_value(); }
+
+  /// \returns the value
+  /// \requires the viewed `std::expected` holds a value
+  constexpr value_ref operator*() const noexcept { return **e_; }
+
+  /// \returns a pointer to the value
+  /// \requires the viewed `std::expected` holds a value
+  constexpr auto operator->() const noexcept { return std::addressof(**e_); }
+
+  /// \returns the value, otherwise throws `std::bad_expected_access` as
+  /// `std::expected::value` does
+  constexpr value_ref value() const { return e_->value(); }
+
+  /// \returns the error
+  /// \requires the viewed `std::expected` holds an error
+  constexpr error_ref error() const noexcept { return e_->error(); }
+
+  /// \returns a copy of the value if there is one, otherwise `u`
+  template <typename U> constexpr value_type value_or(U &&u) const {
+    return e_->value_or(std::forward<U>(u));
+  }
+
+  /// \brief Continues with the result returned by `f` for the value.
+  /// \requires `std::invoke(f, **this)` returns a `tao::result<U, G>` where
+  /// `G` can be constructed from the error
+  /// \returns that result, or one holding a copy of the error
+  template <typename F>
+  constexpr detail::invoke_result_t<F, value_ref> and_then(F &&f) const {
+    using ret_t = detail::invoke_result_t<F, value_ref>;
+    static_assert(detail::is_result<ret_t>::value, "F must return a result");
+
+    if (detail::engaged(*this))
+      return detail::invoke(std::forward<F>(f), **e_);
+    return detail::make_off_path<result_view, ret_t>(unexpect, error());
+  }
+
+  /// \brief Applies `f` to the value.
+  /// \returns a `tao::result` holding the return value of `f`, or a copy of
+  /// the error
+  template <typename F> constexpr auto map(F &&f) const {
+    return detail::result_map_impl(*this, std::forward<F>(f));
+  }
+
+  /// \brief Applies `f` to the error.
+  /// \returns a `tao::result` holding a copy of the value, or the return
+  /// value of `f`
+  template <typename F> constexpr auto map_error(F &&f) const {
+    return detail::result_map_error_impl(*this, std::forward<F>(f));
+  }
+
+  /// \returns an owning copy of the viewed `std::expected`
+  constexpr result<value_type, error_type> to_result() const {
+    return result<value_type, error_type>(*e_);
+  }
+
+private:
+  Expected *e_;
+};
+#endif
+
+} // namespace tao
+
+#endif // TAO_RESULT_STD_VIEW_HPP_
@@ -0,0 +1,296 @@
+//! \file tao/result/try.hpp
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+
+#ifndef TAO_RESULT_TRY_HPP_
+#define TAO_RESULT_TRY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L &&       \
+    defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define TAO_RESULT_COROUTINES
+#endif
+#endif
+
+// Early-return propagation, the equivalent of Rust's `?`:
+//
+//   tao::result<config, parse_error> load(std::string_view text) {
+//     auto header = co_await parse_header(text);  // C++20
+//     auto body = TAO_TRY(parse_body(text));      // GCC / Clang, any standard
+//     co_return config{header, body};
+//   }
+//
+// Both forms yield the value of an engaged optional / a result holding a
+// value, and otherwise leave the enclosing function with nullopt / the error.
+
+namespace tao {
+/// \exclude
+namespace detail {
+
+// Converts to whatever the enclosing function returns on failure: nullopt for
+// an optional, the error (as unexpected) for a result
+template <typename T>
+constexpr nullopt_t try_failure(const optional<T> &) noexcept {
+  return nullopt;
+}
+
+template <typename T, typename E>
+constexpr unexpected<E> try_failure(const result<T, E> &r) {
+  return unexpected<E>(r.error());
+}
+
+template <typename T, typename E>
+constexpr unexpected<E> try_failure(result<T, E> &&r) {
+  return unexpected<E>(std::move(r).error());
+}
+
+} // namespace detail
+} // namespace tao
+
+/// Evaluates `expr`, an optional or a result. If it holds a value, the macro
+/// yields that value (moved out when `expr` is an rvalue). Otherwise the
+/// enclosing function returns `nullopt`, or the error as `unexpected<E>`.
+///
+/// This is a GNU statement expression, available with GCC and Clang in any
+/// language mode. It compiles to the same branch as the hand-written
+/// `if (!r) return r.error();`.
+#if defined(__GNUC__) || defined(__clang__)
+#define TAO_TRY(expr)                                                          \
+  __extension__({                                                              \
+    auto &&tao_try_r_ = (expr);                                                \
+    if (!tao_try_r_.has_value())                                               \
+      return ::tao::detail::try_failure(                                       \
+          static_cast<decltype(tao_try_r_) &&>(tao_try_r_));                   \
+    *static_cast<decltype(tao_try_r_) &&>(tao_try_r_);                         \
+  })
+#endif
+
+#ifdef TAO_RESULT_COROUTINES
+
+// Size of the per-thread arena coroutine frames are carved from
+#ifndef TAO_RESULT_CORO_ARENA_SIZE
+#define TAO_RESULT_CORO_ARENA_SIZE 16384
+#endif
+
+namespace tao {
+/// \exclude
+namespace detail {
+
+// A result/optional coroutine never suspends past its caller: it runs to
+// completion (or to the first failed co_await) inside the call, and its frame
+// is destroyed before the call returns. Frames on a thread are therefore
+// allocated and freed in strict LIFO order, and a bump arena serves them
+// without touching the heap. Frames that do not fit go to ::operator new.
+// When the compiler elides the frame (HALO) none of this is called.
+struct coro_frame_arena {
+  alignas(std::max_align_t) unsigned char buf[TAO_RESULT_CORO_ARENA_SIZE];
+  std::size_t top = 0;
+};
+
+inline coro_frame_arena &coro_arena() noexcept {
+  static thread_local coro_frame_arena arena;
+  return arena;
+}
+
+inline void *coro_frame_alloc(std::size_t n) {
+  constexpr std::size_t align = alignof(std::max_align_t);
+  n = (n + align - 1) & ~(align - 1);
+  coro_frame_arena &a = coro_arena();
+  if (sizeof(a.buf) - a.top >= n) {
+    void *p = a.buf + a.top;
+    a.top += n;
+    return p;
+  }
+  return ::operator new(n);
+}
+
+inline void coro_frame_free(void *p) noexcept {
+  coro_frame_arena &a = coro_arena();
+  const auto addr = reinterpret_cast<std::uintptr_t>(p);
+  const auto first = reinterpret_cast<std::uintptr_t>(a.buf);
+  if (addr >= first && addr < first + sizeof(a.buf)) {
+    a.top = addr - first;
+  } else {
+    ::operator delete(p);
+  }
+}
+
+template <typename Promise> class coro_return_object {
+public:
+  using value_type = typename Promise::value_type;
+
+  explicit coro_return_object(Promise &p) noexcept : promise_(&p) {}
+  coro_return_object(coro_return_object &&rhs) noexcept
+      : promise_(rhs.promise_) {
+    rhs.promise_ = nullptr;
+  }
+  coro_return_object(const coro_return_object &) = delete;
+  coro_return_object &operator=(const coro_return_object &) = delete;
+  coro_return_object &operator=(coro_return_object &&) = delete;
+
+  ~coro_return_object() {
+    if (promise_) {
+      std::coroutine_handle<Promise>::from_promise(*promise_).destroy();
+    }
+  }
+
+  // Called when the coroutine first returns to its caller, which for these
+  // coroutines is after the body has finished or stopped at a failed
+  // co_await
+  operator value_type() {
+    if (!promise_->result_.has_value()) {
+      report_failure("tao::result coroutine: return object converted before "
+                     "the coroutine completed");
+    }
+    return std::move(*promise_->result_);
+  }
+
+private:
+  Promise *promise_;
+};
+
+template <typename Promise, typename R> class coro_awaiter {
+public:
+  explicit coro_awaiter(R &&r) noexcept : r_(std::forward<R>(r)) {}
+
+  bool await_ready() const noexcept { return r_.has_value(); }
+
+  // Stores the failure and stays suspended: control goes back to the caller,
+  // which takes the result and destroys the frame
+  void await_suspend(std::coroutine_handle<Promise> h) {
+    h.promise().fail(std::forward<R>(r_));
+  }
+
+  decltype(auto) await_resume() { return *std::forward<R>(r_); }
+
+private:
+  R &&r_;
+};
+
+template <typename Derived, typename Ret> class coro_promise_base {
+public:
+  using value_type = Ret;
+
+  static void *operator new(std::size_t n) { return coro_frame_alloc(n); }
+  static void operator delete(void *p) noexcept { coro_frame_free(p); }
+
+  coro_return_object<Derived> get_return_object() noexcept {
+    return coro_return_object<Derived>(static_cast<Derived &>(*this));
+  }
+
+  std::suspend_never initial_suspend() const noexcept { return {}; }
+  std::suspend_always final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() {
+#ifdef TAO_RESULT_NO_EXCEPTIONS
+    std::terminate();
+#else
+    throw;
+#endif
+  }
+
+private:
+  template <typename P> friend class coro_return_object;
+
+protected:
+  optional<Ret> result_;
+};
+
+template <typename T, typename E>
+class result_promise
+    : public coro_promise_base<result_promise<T, E>, result<T, E>> {
+public:
+  // Only results can be awaited; the error must convert to E
+  template <typename R,
+            enable_if_t<is_result<decay_t<R>>::value &&
+                        std::is_constructible<
+                            E, decltype(std::declval<R>().error())>::value> * =
+                nullptr>
+  coro_awaiter<result_promise, R> await_transform(R &&r) noexcept {
+    return coro_awaiter<result_promise, R>(std::forward<R>(r));
+  }
+
+  template <typename U> void return_value(U &&u) {
+    this->result_.emplace(std::forward<U>(u));
+  }
+
+  template <typename R> void fail(R &&r) {
+    this->result_.emplace(unexpect, std::forward<R>(r).error());
+  }
+};
+
+// A result<void, E> coroutine ends with a plain co_return
+template <typename E>
+class result_promise<void, E>
+    : public coro_promise_base<result_promise<void, E>, result<void, E>> {
+public:
+  template <typename R,
+            enable_if_t<is_result<decay_t<R>>::value &&
+                        std::is_constructible<
+                            E, decltype(std::declval<R>().error())>::value> * =
+                nullptr>
+  coro_awaiter<result_promise, R> await_transform(R &&r) noexcept {
+    return coro_awaiter<result_promise, R>(std::forward<R>(r));
+  }
+
+  void return_void() { this->result_.emplace(in_place); }
+
+  template <typename R> void fail(R &&r) {
+    this->result_.emplace(unexpect, std::forward<R>(r).error());
+  }
+};
+
+template <typename T>
+class optional_promise
+    : public coro_promise_base<optional_promise<T>, optional<T>> {
+public:
+  // Only optionals can be awaited
+  template <typename R,
+            enable_if_t<is_optional<decay_t<R>>::value> * = nullptr>
+  coro_awaiter<optional_promise, R> await_transform(R &&r) noexcept {
+    return coro_awaiter<optional_promise, R>(std::forward<R>(r));
+  }
+
+  template <typename U> void return_value(U &&u) {
+    this->result_.emplace(std::forward<U>(u));
+  }
+
+  template <typename R> void fail(R &&) { this->result_.emplace(nullopt); }
+};
+
+} // namespace detail
+} // namespace tao
+
+/// A function returning `tao::result<T, E>` or `tao::optional<T>` becomes a
+/// coroutine when its body uses `co_await` or `co_return`. `co_await r`
+/// yields the value of `r`, or returns the error / nullopt from the function.
+/// Coroutine frames are served from a per-thread LIFO arena of
+/// `TAO_RESULT_CORO_ARENA_SIZE` bytes, so they only reach the heap when it is
+/// exhausted.
+template <typename T, typename E, typename... Args>
+struct std::coroutine_traits<tao::result<T, E>, Args...> {
+  using promise_type = tao::detail::result_promise<T, E>;
+};
+
+template <typename T, typename... Args>
+struct std::coroutine_traits<tao::optional<T>, Args...> {
+  using promise_type = tao::detail::optional_promise<T>;
+};
+
+#endif // TAO_RESULT_COROUTINES
+
+#endif // TAO_RESULT_TRY_HPP_
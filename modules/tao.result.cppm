@@ -0,0 +1,71 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Optional C++20 module interface: `import tao.result;` instead of including
+// the headers. The headers stay the single source of truth. They are exported
+// from inside `extern "C++"`, so their entities keep global-module linkage and
+// a program may both import the module and include the headers.
+//
+// Configuration macros (TAO_RESULT_NO_EXCEPTIONS, ...) must be set when this
+// unit is compiled; an importer cannot change them.
+
+module;
+
+// Everything the headers include must come in through the global module
+// fragment, so that it is not attached to (or exported from) tao.result
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 202002L && __has_include(<expected>)
+#include <expected>
+#endif
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+export module tao.result;
+
+export extern "C++" {
+#include <tao/result/result.hpp>
+#include <tao/result/optional_vector.hpp>
+#include <tao/result/bulk.hpp>
+#include <tao/result/hash.hpp>
+#include <tao/result/relocate.hpp>
+#include <tao/result/pipe.hpp>
+#include <tao/result/std_view.hpp>
+#include <tao/result/multi_error.hpp>
+}
+
+// GCC 12 does not emit the function-local statics of inline functions for
+// importers; odr-use them here so that they are defined in this unit
+namespace tao::detail {
+void module_statics_anchor() { (void)failure_handler_slot(); }
+} // namespace tao::detail
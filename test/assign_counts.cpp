@@ -0,0 +1,97 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Assigning one engaged optional to another is a single T::operator= with no
+// constructor or destructor call; each other state transition takes exactly
+// one construction, one destruction or nothing.
+
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+#include "counting.hpp"
+
+namespace {
+
+void check_counts(int constructs, int assigns, int destroys) {
+  CHECK(counted_counts().constructs == constructs);
+  CHECK(counted_counts().assigns == assigns);
+  CHECK(counted_counts().destroys == destroys);
+}
+
+void engaged_to_engaged() {
+  tao::optional<counted> a(tao::in_place, 1);
+  tao::optional<counted> b(tao::in_place, 2);
+  tao::optional<token> t(token{3});
+
+  reset_counts();
+  a = b;
+  check_counts(0, 1, 0);
+  CHECK(a->v == 2);
+
+  reset_counts();
+  a = std::move(b);
+  check_counts(0, 1, 0);
+
+  reset_counts();
+  a = t;
+  check_counts(0, 1, 0);
+  CHECK(a->v == 3);
+
+  reset_counts();
+  a = std::move(t);
+  check_counts(0, 1, 0);
+}
+
+void empty_to_engaged() {
+  tao::optional<counted> a(tao::in_place, 1);
+  tao::optional<counted> e;
+  tao::optional<token> te;
+
+  reset_counts();
+  a = e;
+  check_counts(0, 0, 1);
+  CHECK(!a);
+
+  a.emplace(1);
+  reset_counts();
+  a = te;
+  check_counts(0, 0, 1);
+  CHECK(!a);
+}
+
+void to_empty() {
+  tao::optional<counted> a;
+  const tao::optional<counted> b(tao::in_place, 2);
+  tao::optional<counted> e;
+
+  reset_counts();
+  a = b;
+  check_counts(1, 0, 0);
+  CHECK(a->v == 2);
+
+  a.reset();
+  reset_counts();
+  a = tao::optional<token>(token{3});
+  check_counts(1, 0, 0);
+  CHECK(a->v == 3);
+
+  a.reset();
+  reset_counts();
+  a = e;
+  check_counts(0, 0, 0);
+  CHECK(!a);
+}
+
+} // namespace
+
+int main() {
+  engaged_to_engaged();
+  empty_to_engaged();
+  to_empty();
+  return 0;
+}
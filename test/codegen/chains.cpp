@@ -0,0 +1,97 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Representative chains, compiled with -O2 -S by check_codegen.cmake. A
+// "// codegen <name> <rules...>" line states what the assembly of the
+// extern "C" function <name> must look like:
+//
+//   max <n>      at most n instructions
+//   calls <n>    at most n call instructions, besides the out-of-line
+//                construction of an empty or error result
+//   forbid <re>  no line matches the regular expression
+//
+// and every function is checked against the patterns of check_codegen.cmake
+// that no chain may contain: calls to a copy constructor, __cxa_throw,
+// bad_optional_access, std::mem_fn and indirect calls.
+//
+// `tracked` declares its copy and move constructors without defining them,
+// so every copy the library makes shows up as a call.
+
+#include <system_error>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+struct tracked {
+  tracked(int v) noexcept;
+  tracked(const tracked &);
+  tracked(tracked &&) noexcept;
+  ~tracked();
+  int v;
+};
+
+struct record {
+  int id;
+  int doubled() const { return id * 2; }
+};
+
+namespace {
+tao::optional<int> parse(int x) {
+  return x >= 0 ? tao::optional<int>(x) : tao::nullopt;
+}
+int normalize(int x) { return x & 0xff; }
+tao::optional<int> fallback() { return 0; }
+
+tao::result<int, std::errc> checked(int x) {
+  if (x < 0) {
+    return tao::result<int, std::errc>(tao::unexpect,
+                                       std::errc::invalid_argument);
+  }
+  return x;
+}
+} // namespace
+
+// codegen optional_chain max 28 calls 0
+extern "C" tao::optional<int> optional_chain(const tao::optional<int> &o) {
+  return o.and_then(parse).map(normalize).or_else(fallback);
+}
+
+// codegen optional_value_or max 12 calls 0
+extern "C" int optional_value_or(const tao::optional<int> &o) {
+  return o.map(normalize).value_or(-1);
+}
+
+// codegen result_chain max 32 calls 0
+extern "C" tao::result<int, std::errc>
+result_chain(const tao::result<int, std::errc> &r) {
+  return r.and_then(checked)
+      .map(normalize)
+      .map_error([](std::errc e) { return e; })
+      .or_else([](std::errc) { return tao::result<int, std::errc>(0); });
+}
+
+// The moves are calls to tracked(tracked &&); there is no copy among them
+// codegen optional_move_chain max 64
+extern "C" tao::optional<tracked> optional_move_chain(tao::optional<tracked> &o) {
+  return std::move(o)
+      .and_then([](tracked &&t) { return tao::optional<tracked>(std::move(t)); })
+      .or_else([] { return tao::optional<tracked>(tracked(0)); });
+}
+
+// codegen map_data_member max 20 calls 0
+extern "C" tao::optional<int> map_data_member(const tao::optional<record> &o) {
+  return o.map(&record::id);
+}
+
+// A pointer to member function is applied directly. GCC 12 leaves the call
+// to the member out of line (as it does for std::invoke behind the same
+// layers), so up to one direct call is allowed.
+// codegen map_member_function max 24 calls 1
+extern "C" tao::optional<int>
+map_member_function(const tao::optional<record> &o) {
+  return o.map(&record::doubled);
+}
@@ -0,0 +1,119 @@
+# Compiles SOURCE with COMPILER at -O2 to assembly and checks every function
+# named by a "// codegen <name> <rules...>" line of SOURCE against its rules
+# (see chains.cpp). x86-64 assembly is assumed.
+#
+#   cmake -DCOMPILER=g++ -DSOURCE=chains.cpp -DINCLUDE_DIR=include
+#         -DOUTPUT=chains.s -P check_codegen.cmake
+
+cmake_minimum_required(VERSION 3.15)
+
+foreach(var COMPILER SOURCE INCLUDE_DIR OUTPUT)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "check_codegen.cmake: ${var} is not set")
+  endif()
+endforeach()
+
+# What no chain may contain, in the hot or the cold part
+set(forbidden
+  "call[ \t]+[^ \t]*C[12]ERK"      # a copy constructor
+  "__cxa_throw"
+  "bad_optional_access"
+  "mem_fn|_Mem_fn"
+  "call[ \t]+\\*")                 # an indirect call
+
+execute_process(
+  COMMAND ${COMPILER} -std=c++17 -O2 -DNDEBUG -I${INCLUDE_DIR}
+          -S -o ${OUTPUT} ${SOURCE}
+  RESULT_VARIABLE status
+  ERROR_VARIABLE errors)
+if(NOT status EQUAL 0)
+  message(FATAL_ERROR "${COMPILER} failed on ${SOURCE}:\n${errors}")
+endif()
+
+# One list element per line; ; and brackets would confuse CMake lists
+file(READ ${OUTPUT} asm)
+string(REGEX REPLACE "[][;]" "_" asm "${asm}")
+string(REPLACE "\n" ";" asm "${asm}")
+
+# Sets <out> to the lines of the function <label>, from its label up to the
+# next function label or section switch
+function(extract_function label out)
+  set(body "")
+  set(inside FALSE)
+  foreach(line IN LISTS asm)
+    if(inside)
+      if(line MATCHES "^[A-Za-z_][A-Za-z0-9_.$]*:" OR
+         line MATCHES "^[ \t]*\\.(section|text|size[ \t]+${label}[ \t,])" OR
+         line MATCHES "^[ \t]*\\.cfi_endproc")
+        break()
+      endif()
+      list(APPEND body "${line}")
+    elseif(line STREQUAL "${label}:")
+      set(inside TRUE)
+    endif()
+  endforeach()
+  set(${out} "${body}" PARENT_SCOPE)
+  set(${out}_found ${inside} PARENT_SCOPE)
+endfunction()
+
+set(failures "")
+file(STRINGS ${SOURCE} specs REGEX "^// codegen [a-z_]+")
+foreach(spec IN LISTS specs)
+  string(REGEX REPLACE "^// codegen " "" spec "${spec}")
+  separate_arguments(spec)
+  list(POP_FRONT spec name)
+
+  extract_function(${name} hot)
+  if(NOT hot_found)
+    list(APPEND failures "${name}: not found in the assembly")
+    continue()
+  endif()
+  extract_function(${name}.cold cold)
+
+  set(instructions 0)
+  set(calls 0)
+  foreach(line IN LISTS hot)
+    if(line MATCHES "^[ \t]+[a-z]")
+      math(EXPR instructions "${instructions} + 1")
+      # make_cold builds the empty or error result out of line on purpose
+      if(line MATCHES "^[ \t]+call" AND NOT line MATCHES "make_cold")
+        math(EXPR calls "${calls} + 1")
+      endif()
+    endif()
+  endforeach()
+
+  set(patterns ${forbidden})
+  while(spec)
+    list(POP_FRONT spec rule value)
+    if(rule STREQUAL "max")
+      if(instructions GREATER value)
+        list(APPEND failures
+             "${name}: ${instructions} instructions, at most ${value} expected")
+      endif()
+    elseif(rule STREQUAL "calls")
+      if(calls GREATER value)
+        list(APPEND failures "${name}: ${calls} calls, at most ${value} expected")
+      endif()
+    elseif(rule STREQUAL "forbid")
+      list(APPEND patterns "${value}")
+    else()
+      message(FATAL_ERROR "${name}: unknown rule '${rule}'")
+    endif()
+  endwhile()
+
+  foreach(line IN LISTS hot cold)
+    foreach(pattern IN LISTS patterns)
+      if(line MATCHES "${pattern}")
+        string(STRIP "${line}" line)
+        list(APPEND failures "${name}: '${line}' matches '${pattern}'")
+      endif()
+    endforeach()
+  endforeach()
+
+  message(STATUS "${name}: ${instructions} instructions, ${calls} calls")
+endforeach()
+
+if(failures)
+  list(JOIN failures "\n  " failures)
+  message(FATAL_ERROR "codegen check failed (${OUTPUT}):\n  ${failures}")
+endif()
@@ -0,0 +1,180 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Constant-expression checks: the test is that this file compiles. Under
+// C++20 every member of optional and result is evaluated at compile time with
+// a payload that has a non-trivial destructor; before that, what C++14 allows.
+
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <tao/result/result.hpp>
+
+namespace {
+
+using tao::optional;
+using tao::result;
+using tao::unexpected;
+
+// Trivial payloads, constexpr since C++14. Closures are literal types only
+// from C++17, so function objects stand in for lambdas here.
+struct twice {
+  constexpr int operator()(int v) const { return v * 2; }
+};
+
+struct next_or_none {
+  constexpr optional<int> operator()(int v) const {
+    return optional<int>(v + 1);
+  }
+};
+
+struct four {
+  constexpr int operator()() const { return 4; }
+};
+
+struct recover {
+  constexpr result<int, std::errc> operator()(std::errc) const {
+    return result<int, std::errc>(1);
+  }
+};
+
+constexpr optional<int> seven(7);
+static_assert(*seven == 7 && seven.value_or(0) == 7, "");
+static_assert(!optional<int>().has_value(), "");
+static_assert(optional<int>().value_or(3) == 3, "");
+static_assert(seven.map(twice{}).value_or(0) == 14, "");
+static_assert(seven.and_then(next_or_none{}).value_or(0) == 8, "");
+static_assert(optional<int>().value_or_else(four{}) == 4, "");
+
+#if defined(__cpp_lib_addressof_constexpr)
+constexpr int referee = 5;
+constexpr optional<const int &> ref(referee);
+static_assert(*ref == 5 && ref.value_or(0) == 5, "");
+#endif
+
+constexpr result<int, std::errc> ok(3);
+constexpr result<int, std::errc> failed(tao::unexpect,
+                                        std::errc::invalid_argument);
+static_assert(*ok == 3 && !failed, "");
+static_assert(failed.error() == std::errc::invalid_argument, "");
+static_assert(failed.value_or(9) == 9, "");
+static_assert(ok.map(twice{}).value_or(0) == 6, "");
+static_assert(failed.or_else(recover{}).value_or(0) == 1, "");
+static_assert(result<void, std::errc>().has_value(), "");
+
+#if defined(TAO_RESULT_HAS_CONSTEXPR20) && defined(__cpp_lib_constexpr_string) && \
+    __cpp_lib_constexpr_string >= 201907L
+// A payload with a non-trivial destructor, through every member that builds
+// or destroys it in place
+
+constexpr bool optional_members() {
+  optional<std::string> a;
+  if (a) {
+    return false;
+  }
+  a = std::string("hello");
+  optional<std::string> b = a;
+  if (*b != "hello") {
+    return false;
+  }
+  b.emplace(3, 'x');
+  if (*b != "xxx") {
+    return false;
+  }
+  a.swap(b);
+  if (*a != "xxx" || *b != "hello") {
+    return false;
+  }
+  b.reset();
+  a.swap(b);
+  if (a || *b != "xxx") {
+    return false;
+  }
+  optional<std::string> c = std::move(b);
+  b = c;
+  b = tao::nullopt;
+  optional<std::string> d = c.take();
+  if (c || *d != "xxx") {
+    return false;
+  }
+  const optional<const char *> literal("abc");
+  optional<std::string> e(literal);
+  e = optional<const char *>("abcd");
+  return !b && e->size() == 4 &&
+         d.map_or([](const std::string &s) { return s.size(); },
+                  std::size_t(0)) == 3;
+}
+static_assert(optional_members());
+
+constexpr bool optional_chains() {
+  optional<std::string> a("ab");
+  const std::string s = std::move(a)
+                            .and_then([](std::string &&v) {
+                              return optional<std::string>(v + "c");
+                            })
+                            .map([](std::string &&v) { return v + "d"; })
+                            .value_or("");
+  const std::string t =
+      optional<std::string>().value_or_else([] { return std::string("z"); });
+  return s == "abcd" && t == "z";
+}
+static_assert(optional_chains());
+
+constexpr bool result_members() {
+  result<std::string, std::string> r = std::string("v");
+  result<std::string, std::string> e = unexpected<std::string>("bad");
+  r.swap(e);
+  if (r.has_value() || r.error() != "bad" || *e != "v") {
+    return false;
+  }
+  r = std::string("ok");
+  e = unexpected<std::string>("err");
+  result<std::string, std::string> c = e;
+  c.emplace("abc");
+  swap(c, e);
+  const result<std::string, std::string> m = std::move(c);
+  return *r == "ok" && m.error() == "err" && *e == "abc" &&
+         r.map([](const std::string &s) { return s.size(); }).value() == 2;
+}
+static_assert(result_members());
+
+constexpr bool void_result_members() {
+  result<void, std::string> v;
+  v = unexpected<std::string>("no");
+  result<void, std::string> w = v;
+  if (w || w.error() != "no") {
+    return false;
+  }
+  w.emplace();
+  v.swap(w);
+  return v && !w && w.error() == "no";
+}
+static_assert(void_result_members());
+
+#if defined(__cpp_lib_constexpr_vector) && __cpp_lib_constexpr_vector >= 201907L
+constexpr std::size_t vector_of_optionals() {
+  std::vector<optional<std::string>> v;
+  v.emplace_back("ab");
+  v.emplace_back();
+  v.emplace_back("cde");
+  std::size_t n = 0;
+  for (const auto &o : v) {
+    n += o.map_or([](const std::string &s) { return s.size(); },
+                  std::size_t(0));
+  }
+  return n;
+}
+static_assert(vector_of_optionals() == 5);
+#endif
+#endif
+
+} // namespace
+
+int main() { return 0; }
@@ -0,0 +1,78 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_RESULT_TEST_COUNTING_HPP_
+#define TAO_RESULT_TEST_COUNTING_HPP_
+
+#include <cstdio>
+#include <cstdlib>
+
+// A payload that counts what is done to it, and a check that reports the
+// failing line and exits, so the tests also run with NDEBUG.
+
+struct counts {
+  int constructs = 0; // every constructor, copy and move included
+  int copies = 0;
+  int moves = 0;
+  int assigns = 0; // every assignment operator
+  int destroys = 0;
+};
+
+inline counts &counted_counts() {
+  static counts c;
+  return c;
+}
+
+inline void reset_counts() { counted_counts() = counts(); }
+
+// What a counted can also be built from and assigned from, for the
+// converting assignments
+struct token {
+  int v;
+};
+
+struct counted {
+  int v;
+
+  explicit counted(int x = 0) : v(x) { ++counted_counts().constructs; }
+  counted(token t) : v(t.v) { ++counted_counts().constructs; }
+  counted(const counted &o) : v(o.v) {
+    ++counted_counts().constructs;
+    ++counted_counts().copies;
+  }
+  counted(counted &&o) noexcept : v(o.v) {
+    ++counted_counts().constructs;
+    ++counted_counts().moves;
+  }
+  counted &operator=(token t) {
+    v = t.v;
+    ++counted_counts().assigns;
+    return *this;
+  }
+  counted &operator=(const counted &o) {
+    v = o.v;
+    ++counted_counts().assigns;
+    return *this;
+  }
+  counted &operator=(counted &&o) noexcept {
+    v = o.v;
+    ++counted_counts().assigns;
+    return *this;
+  }
+  ~counted() { ++counted_counts().destroys; }
+};
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,   \
+                   #cond);                                                     \
+      std::exit(1);                                                            \
+    }                                                                          \
+  } while (false)
+
+#endif // TAO_RESULT_TEST_COUNTING_HPP_
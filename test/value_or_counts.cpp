@@ -0,0 +1,132 @@
+// Tao.Result
+//
+// Copyright Fernando Pelliccioni 2016-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// value_or on an rvalue moves the stored value out instead of copying it, and
+// value_or_else builds its fallback only when there is no value: neither copies
+// the payload nor allocates when one is stored.
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <tao/result/result.hpp>
+
+#include "counting.hpp"
+
+namespace {
+int allocations = 0;
+} // namespace
+
+void *operator new(std::size_t n) {
+  ++allocations;
+  if (void *p = std::malloc(n == 0 ? 1 : n)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+const std::string long_string(40, 'x'); // past the small-string buffer
+
+struct fallback {
+  int &calls;
+
+  counted operator()() const {
+    ++calls;
+    return counted(9);
+  }
+  counted operator()(std::errc) const { return (*this)(); }
+};
+
+void rvalue_value_or() {
+  tao::optional<counted> o(tao::in_place, 1);
+  reset_counts();
+  const counted v = std::move(o).value_or(counted(9));
+  CHECK(v.v == 1);
+  CHECK(counted_counts().copies == 0);
+  CHECK(counted_counts().moves == 1);
+
+  tao::result<counted, std::errc> r(tao::in_place, 1);
+  reset_counts();
+  const counted w = std::move(r).value_or(counted(9));
+  CHECK(w.v == 1);
+  CHECK(counted_counts().copies == 0);
+  CHECK(counted_counts().moves == 1);
+}
+
+void value_or_else() {
+  int calls = 0;
+  tao::optional<counted> o(tao::in_place, 1);
+  reset_counts();
+  const counted a = o.value_or_else(fallback{calls});
+  CHECK(a.v == 1);
+  CHECK(calls == 0);
+  CHECK(counted_counts().copies == 1);
+
+  reset_counts();
+  const counted b = std::move(o).value_or_else(fallback{calls});
+  CHECK(b.v == 1);
+  CHECK(calls == 0);
+  CHECK(counted_counts().copies == 0);
+  CHECK(counted_counts().moves == 1);
+
+  tao::optional<counted> e;
+  reset_counts();
+  const counted c = std::move(e).value_or_else(fallback{calls});
+  CHECK(c.v == 9);
+  CHECK(calls == 1);
+  CHECK(counted_counts().copies == 0);
+
+  tao::result<counted, std::errc> r(tao::in_place, 1);
+  reset_counts();
+  const counted d = std::move(r).value_or_else(fallback{calls});
+  CHECK(d.v == 1);
+  CHECK(calls == 1);
+  CHECK(counted_counts().copies == 0);
+
+  tao::result<counted, std::errc> f(tao::unexpect, std::errc::invalid_argument);
+  const counted g = std::move(f).value_or_else(fallback{calls});
+  CHECK(g.v == 9);
+  CHECK(calls == 2);
+}
+
+void allocations_when_engaged() {
+  tao::optional<std::string> o(long_string);
+  allocations = 0;
+  const std::string a = std::move(o).value_or("fallback");
+  CHECK(a == long_string);
+  CHECK(allocations == 0);
+
+  tao::optional<std::string> p(long_string);
+  allocations = 0;
+  const std::string b =
+      std::move(p).value_or_else([] { return std::string(40, 'y'); });
+  CHECK(b == long_string);
+  CHECK(allocations == 0);
+
+  tao::result<std::string, std::errc> r(long_string);
+  allocations = 0;
+  const std::string c = std::move(r).value_or_else(
+      [](std::errc) { return std::string(40, 'y'); });
+  CHECK(c == long_string);
+  CHECK(allocations == 0);
+}
+
+} // namespace
+
+int main() {
+  rvalue_value_or();
+  value_or_else();
+  allocations_when_engaged();
+  return 0;
+}